@@ -0,0 +1,74 @@
+/***************************************************************************//**
+ *   @file   osc_batch.js
+ *   @brief  Capture and process Oscilloscope buffers without plotting
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+/* Perform tool reset */
+launcher.reset()
+
+/* Setup main function */
+function main(){
+
+	osc.channels[0].enabled = true
+	osc.time_base = 0.001
+
+	/* Skip drawing the plot, every acquired buffer is still processed */
+	osc.headless = true
+
+	for (var i = 0; i < 100; i++) {
+		/* Wait for one more buffer, starting the acquisition if needed */
+		if (!osc.capture(1, 5000)) {
+			printToConsole("Capture timed out")
+			break
+		}
+
+		/* Each read of data_buffer converts the plotted samples into
+		 * a new float buffer, so read it once per capture */
+		var samples = new Float32Array(osc.channels[0].data_buffer)
+
+		var max = -Infinity
+		for (var j = 0; j < samples.length; j++) {
+			if (samples[j] > max)
+				max = samples[j]
+		}
+		printToConsole(max)
+	}
+
+	osc.headless = false
+}
+
+main()
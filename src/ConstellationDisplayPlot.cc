@@ -226,6 +226,15 @@ ConstellationDisplayPlot::plotNewData(const std::vector<double*> &realDataPoints
 	memcpy(d_imag_data[i], imagDataPoints[i], numDataPoints*sizeof(double));
       }
 
+      if (d_persistence_en) {
+	for(int i = 0; i < d_nplots; i++) {
+	  bool lines = d_plot_curve[i]->style() == QwtPlotCurve::Lines &&
+		  d_plot_curve[i]->pen().style() != Qt::NoPen;
+	  accumulatePersistence(i, d_real_data[i], d_imag_data[i],
+				numDataPoints, lines);
+	}
+      }
+
       if(d_autoscale_state) {
 	double bottom=1e20, top=-1e20;
 	for(int n = 0; n < d_nplots; n++) {
@@ -271,6 +280,19 @@ ConstellationDisplayPlot::newData(const QEvent* updateEvent)
   const std::vector<double*> imagDataPoints = tevent->getImagPoints();
   const uint64_t numDataPoints = tevent->getNumDataPoints();
 
+  // Frames dropped by the sink's update time only grade the persistence
+  if(tevent->persistenceOnly()) {
+    if(!d_stop && d_persistence_en) {
+      for(int i = 0; i < d_nplots; i++) {
+	bool lines = d_plot_curve[i]->style() == QwtPlotCurve::Lines &&
+		d_plot_curve[i]->pen().style() != Qt::NoPen;
+	accumulatePersistence(i, realDataPoints[i], imagDataPoints[i],
+			      numDataPoints, lines);
+      }
+    }
+    return;
+  }
+
   this->plotNewData(realDataPoints,
 			 imagDataPoints,
 			 numDataPoints,
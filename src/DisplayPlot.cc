@@ -516,7 +516,8 @@ DisplayPlot::DisplayPlot(int nplots, QWidget* parent,  bool isdBgraph,
 	  d_displayScale(1), d_xAxisNumDiv(1), d_trackMode(false),
 	  d_cursorsEnabled(false), d_isLogaritmicPlot(false),
 	  d_isLogaritmicYPlot(false),
-	  d_yAxisNumDiv(1)
+	  d_yAxisNumDiv(1), d_persistence_en(false),
+	  d_persistence_decay(0.9)
 {
 
 	d_CurveColors << QColor("#ff7200") << QColor("#9013fe") << QColor(Qt::green)
@@ -706,6 +707,13 @@ DisplayPlot::~DisplayPlot()
         delete *it;
     }
 
+    for (auto it = d_persistence.begin(); it != d_persistence.end(); ++it) {
+        (*it)->detach();
+        delete *it;
+    }
+
+    clearMaskRegions();
+
 	delete markerIntersection1;
 	delete markerIntersection2;
 	delete horizAxis;
@@ -2227,3 +2235,122 @@ void DisplayPlot::setYaxisMouseGesturesEnabled(int axisId, bool en)
 		vertAxes[axisId]->setMouseGesturesEnabled(en);
 	}
 }
+
+bool DisplayPlot::persistenceEnabled() const
+{
+	return d_persistence_en;
+}
+
+void DisplayPlot::setPersistenceEnabled(bool enabled)
+{
+	if (d_persistence_en == enabled) {
+		return;
+	}
+
+	d_persistence_en = enabled;
+
+	for (PersistenceItem *item : d_persistence) {
+		item->clear();
+		item->setVisible(enabled);
+	}
+
+	replot();
+}
+
+void DisplayPlot::setPersistenceDecay(double decay)
+{
+	d_persistence_decay = decay;
+
+	for (PersistenceItem *item : d_persistence) {
+		item->setDecay(decay);
+	}
+}
+
+void DisplayPlot::clearPersistence()
+{
+	for (PersistenceItem *item : d_persistence) {
+		item->clear();
+	}
+
+	replot();
+}
+
+/* The persistence layer of a curve is created the first time the
+ * curve receives data with persistence enabled, and follows the curve's
+ * color, axes and visibility. */
+void DisplayPlot::accumulatePersistence(unsigned int curveIdx,
+		const double *x, const double *y, size_t nb_points, bool connect)
+{
+	if (!d_persistence_en || curveIdx >= d_plot_curve.size()) {
+		return;
+	}
+
+	if (d_persistence.size() <= (int)curveIdx) {
+		d_persistence.resize(curveIdx + 1);
+	}
+
+	QwtPlotCurve *curve = d_plot_curve[curveIdx];
+	PersistenceItem *item = d_persistence[curveIdx];
+
+	if (!item) {
+		item = new PersistenceItem(curve->title());
+		item->setDecay(d_persistence_decay);
+		item->attach(this);
+		d_persistence[curveIdx] = item;
+	}
+
+	item->setAxes(curve->xAxis(), curve->yAxis());
+	item->setColor(curve->pen().color());
+	item->setVisible(curve->isVisible());
+
+	if (curve->isVisible()) {
+		item->addFrame(x, y, nb_points, connect);
+	}
+}
+
+void DisplayPlot::setMaskRegions(unsigned int curveIdx,
+				 const QVector<QPolygonF> &regions)
+{
+	for (QwtPlotShapeItem *item : d_mask_items.take(curveIdx)) {
+		item->detach();
+		delete item;
+	}
+
+	if (curveIdx >= d_plot_curve.size()) {
+		return;
+	}
+
+	QwtPlotCurve *curve = d_plot_curve[curveIdx];
+	QColor color = curve->pen().color();
+	QList<QwtPlotShapeItem *> items;
+
+	color.setAlpha(60);
+
+	for (const QPolygonF &region : regions) {
+		QwtPlotShapeItem *item = new QwtPlotShapeItem();
+
+		item->setPolygon(region);
+		item->setAxes(curve->xAxis(), curve->yAxis());
+		item->setPen(QPen(color.darker(), 1));
+		item->setBrush(color);
+		item->setItemAttribute(QwtPlotItem::AutoScale, false);
+		item->setZ(curve->z() - 1);
+		item->attach(this);
+		items.append(item);
+	}
+
+	d_mask_items.insert(curveIdx, items);
+	replot();
+}
+
+void DisplayPlot::clearMaskRegions()
+{
+	for (const QList<QwtPlotShapeItem *> &items : d_mask_items) {
+		for (QwtPlotShapeItem *item : items) {
+			item->detach();
+			delete item;
+		}
+	}
+
+	d_mask_items.clear();
+}
@@ -60,6 +60,7 @@
 #include <qwt_legend.h>
 #include <qwt_plot_grid.h>
 #include <qwt_plot_scaleitem.h>
+#include <qwt_plot_shapeitem.h>
 #include "utils.h"
 #include "osc_adjuster.hpp"
 #include "plot_utils.hpp"
@@ -70,7 +71,9 @@
 #include "gui/cursor_readouts.h"
 #include "handles_area.hpp"
 #include "plotpickerwrapper.h"
+#include "persistence_item.hpp"
 #include <QWidget>
+#include <QMap>
 
 typedef QList<QColor> QColorList;
 Q_DECLARE_METATYPE ( QColorList )
@@ -428,6 +431,15 @@ public:
   virtual QString formatXValue(double value, int precision) const;
   virtual QString formatYValue(double value, int precision) const;
 
+  bool persistenceEnabled() const;
+  void setPersistenceEnabled(bool enabled);
+  void setPersistenceDecay(double decay);
+  void clearPersistence();
+
+  /* Show the keep-out regions of a mask test over a curve */
+  void setMaskRegions(unsigned int curveIdx, const QVector<QPolygonF> &regions);
+  void clearMaskRegions();
+
 public Q_SLOTS:
   virtual void disableLegend();
   virtual void setYaxis(double min, double max);
@@ -679,6 +691,14 @@ protected:
 
   double getHorizontalCursorIntersection(double time);
 
+  bool d_persistence_en;
+  double d_persistence_decay;
+  QVector<PersistenceItem *> d_persistence;
+  QMap<unsigned int, QList<QwtPlotShapeItem *>> d_mask_items;
+
+  void accumulatePersistence(unsigned int curveIdx, const double *x,
+			     const double *y, size_t nb_points, bool connect);
+
 private:
   void AddAxisOffset(int axisPos, int axisIdx, double offset);
   bool d_coloredLabels;
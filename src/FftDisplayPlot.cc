@@ -26,6 +26,7 @@
 #include "marker_controller.h"
 #include "limitedplotzoomer.h"
 #include "osc_scale_engine.h"
+#include "mask_test.hpp"
 
 #include <QDebug>
 #include <qwt_symbol.h>
@@ -73,9 +74,12 @@ FftDisplayPlot::FftDisplayPlot(int nplots, QWidget *parent) :
 	d_stop_frequency(1000),
 	d_sampl_rate(1),
 	d_preset_sampl_rate(d_sampl_rate),
+	d_preset_start_frequency(d_start_frequency),
+	d_preset_stop_frequency(d_stop_frequency),
 	d_presetMagType(MagnitudeType::DBFS),
 	d_mrkCtrl(nullptr),
 	d_emitNewMkrData(true),
+	d_mask_test(nullptr),
 	m_visiblePeakSearch(true),
 	d_logScaleEnabled(false),
 	d_buffer_idx(0),
@@ -608,6 +612,62 @@ std::vector<double*> FftDisplayPlot::getOrginal_data() {
     return y_original_data;
 }
 
+const double *FftDisplayPlot::getMagnitudeData(unsigned int chIdx) const
+{
+	if (chIdx >= d_nplots)
+		return nullptr;
+
+	return y_data[chIdx];
+}
+
+void FftDisplayPlot::computeMagnitude(unsigned int chIdx, const float *power,
+				      double *out, uint64_t nb_points) const
+{
+	if (chIdx >= d_nplots)
+		return;
+
+	const double scale = y_scale_factor[chIdx];
+
+	for (uint64_t s = 0; s < nb_points; s++) {
+		switch (d_magType) {
+		case DBFS:
+			out[s] = 10 * log10((power[s] / (2048 * 2048)) /
+					    (nb_points * nb_points));
+			break;
+		case DBV:
+			out[s] = 10 * log10(power[s]) + 20 * log10(scale) -
+				20 * log10(nb_points) - 20 * log10(sqrt(2));
+			break;
+		case DBU:
+			out[s] = 10 * log10(power[s]) + 20 * log10(scale) -
+				20 * log10(nb_points) -
+				20 * log10(sqrt(2) * 0.77459667);
+			break;
+		case VPEAK:
+			out[s] = sqrt(power[s]) * scale / nb_points;
+			break;
+		case VRMS:
+			out[s] = sqrt(power[s]) * scale / sqrt(2) / nb_points;
+			break;
+		case VROOTHZ: {
+			// Density of this frame alone, overlapping frames
+			// are not combined
+			auto enbw = d_sampl_rate * d_win_coefficient_sum_sqr[chIdx] /
+					(d_win_coefficient_sum[chIdx] *
+					 d_win_coefficient_sum[chIdx]);
+			out[s] = sqrt(power[s]) * scale / sqrt(2) / nb_points /
+					sqrt(enbw);
+			break;
+		}
+		};
+	}
+}
+
+void FftDisplayPlot::setMaskTest(MaskTest *mask)
+{
+	d_mask_test = mask;
+}
+
 int64_t FftDisplayPlot::getYdata_size() {
     return y_data.size();
 }
@@ -633,11 +693,13 @@ void FftDisplayPlot::plotData(const std::vector<double *> &pts,
 	bool samplRateChanged = false;
 	bool magTypeChanged = false;
 
-	// Update sample rate if required
-	if (d_sampl_rate != d_preset_sampl_rate) {
+	// Update sample rate and frequency range if required
+	if (d_sampl_rate != d_preset_sampl_rate ||
+			d_start_frequency != d_preset_start_frequency ||
+			d_stop_frequency != d_preset_stop_frequency) {
 		d_sampl_rate = d_preset_sampl_rate;
-		d_start_frequency = 0;
-		d_stop_frequency = d_sampl_rate / 2;
+		d_start_frequency = d_preset_start_frequency;
+		d_stop_frequency = d_preset_stop_frequency;
 		samplRateChanged = true;
 
 		Q_EMIT sampleRateUpdated(d_sampl_rate);
@@ -713,6 +775,11 @@ void FftDisplayPlot::plotData(const std::vector<double *> &pts,
 
 	_resetXAxisPoints();
 
+	// Test the averaged magnitude, as displayed, against the mask
+	if (d_mask_test && y_data.size() >= d_mask_test->channelCount()) {
+		d_mask_test->test(y_data.data(), x_data, halfNumPoints);
+	}
+
 	if (numPointsChanged) {
 		// When the number of points change but the start and stop freq
 		// stay the same, we need to update the position of fixed markers
@@ -739,6 +806,8 @@ void FftDisplayPlot::plotData(const std::vector<double *> &pts,
 
 				if (marker.data->x > d_stop_frequency) {
 					marker.data->bin = d_numPoints - 1;
+				} else if (marker.data->x < d_start_frequency) {
+					marker.data->bin = 0;
 				} else {
 					marker.data->bin = posAtFrequency(
 						marker.data->x);
@@ -926,6 +995,8 @@ void FftDisplayPlot::setSampleRate(double sr, double units,
 	d_stop_frequency = sr / 2;
 	d_sampl_rate = sr;
 	d_preset_sampl_rate = sr;
+	d_preset_start_frequency = d_start_frequency;
+	d_preset_stop_frequency = d_stop_frequency;
 
 	_resetXAxisPoints();
 }
@@ -938,6 +1009,14 @@ double FftDisplayPlot::sampleRate()
 void FftDisplayPlot::presetSampleRate(double sr)
 {
 	d_preset_sampl_rate = sr;
+	d_preset_start_frequency = 0;
+	d_preset_stop_frequency = sr / 2;
+}
+
+void FftDisplayPlot::presetFrequencyRange(double start, double stop)
+{
+	d_preset_start_frequency = start;
+	d_preset_stop_frequency = stop;
 }
 
 FftDisplayPlot::AverageType FftDisplayPlot::averageType(uint chIdx) const
@@ -1099,11 +1178,12 @@ void FftDisplayPlot::findPeaks(int chn)
 
 	if(m_visiblePeakSearch)
 	{
-		auto coef  = num_points/d_stop_frequency;
-		if (m_sweepStart * coef > 0) {
-			start = m_sweepStart * coef;
+		auto coef  = num_points/(d_stop_frequency - d_start_frequency);
+		if ((m_sweepStart - d_start_frequency) * coef > 0) {
+			start = (m_sweepStart - d_start_frequency) * coef;
 		}
-		stop = m_sweepStop * coef;
+		stop = std::min<double>(num_points,
+				(m_sweepStop - d_start_frequency) * coef);
 		maxY[0] = y[start];
 	}
 
@@ -30,6 +30,7 @@
 #include <boost/shared_ptr.hpp>
 
 namespace adiscope {
+	class MaskTest;
 	class SpectrumAverage;
 	class SpectrumMarker;
 	class MarkerController;
@@ -100,6 +101,8 @@ namespace adiscope {
 		double d_stop_frequency;
 		double d_sampl_rate;
 		double d_preset_sampl_rate;
+		double d_preset_start_frequency;
+		double d_preset_stop_frequency;
 
 		bool d_firstInit;
 
@@ -181,6 +184,13 @@ namespace adiscope {
 
 		void initChannelMeasurement(int nplots);
 		std::vector<double*> getOrginal_data();
+		const double *getMagnitudeData(unsigned int chIdx) const;
+
+		// Magnitude of a single, non averaged, FFT frame in the
+		// current units. 'power' holds the squared bin magnitudes.
+		void computeMagnitude(unsigned int chIdx, const float *power,
+				      double *out, uint64_t nb_points) const;
+		void setMaskTest(MaskTest *mask);
 		std::vector<double*> getRef_data();
 		int64_t getYdata_size();
 		std::vector<double> getScaleFactor();
@@ -274,6 +284,7 @@ namespace adiscope {
 		void setSampleRate(double sr, double units,
 			const std::string &strunits);
 		void presetSampleRate(double sr);
+		void presetFrequencyRange(double start, double stop);
 		void useLogFreq(bool use_log_freq);
 		void customEvent(QEvent *e);
 		void showEvent(QShowEvent *event);
@@ -182,6 +182,7 @@ TimeDomainDisplayPlot::TimeDomainDisplayPlot(QWidget* parent, bool isdBgraph, un
   d_sample_rate = 1;
   d_data_starting_point = 0.0;
   d_curves_hidden = false;
+  d_headless = false;
   d_nbPtsXAxis = 0;
 
   d_nb_ref_curves = 0;
@@ -325,6 +326,14 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
 	}
       }
 
+      if (d_persistence_en) {
+	int ref_offset = countReferenceWaveform(start);
+	for(int i = 0; i < sinkNumChannels; i++) {
+	  accumulatePersistence(start + i + ref_offset, d_xdata[sinkIndex],
+				d_ydata[start + i], numDataPoints, true);
+	}
+      }
+
       for (int i = 0; i < d_plot_curve.size(); i++)
 		d_plot_curve.at(i)->show();
       d_curves_hidden = false;
@@ -481,7 +490,9 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
 	}
       }
 
-      replot();
+      if(!d_headless) {
+	replot();
+      }
 
       Q_EMIT newData();
 
@@ -489,6 +500,29 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
   }
 }
 
+const double *TimeDomainDisplayPlot::channelData(unsigned int chnIdx) const
+{
+	if (chnIdx >= d_ydata.size())
+		return nullptr;
+
+	return d_ydata[chnIdx];
+}
+
+void TimeDomainDisplayPlot::setHeadless(bool headless)
+{
+	d_headless = headless;
+	setUpdatesEnabled(!headless);
+
+	if (!headless) {
+		replot();
+	}
+}
+
+bool TimeDomainDisplayPlot::isHeadless() const
+{
+	return d_headless;
+}
+
 void TimeDomainDisplayPlot::newData(const QEvent* updateEvent)
 {
 	IdentifiableTimeUpdateEvent *tevent = (IdentifiableTimeUpdateEvent*)updateEvent;
@@ -497,6 +531,11 @@ void TimeDomainDisplayPlot::newData(const QEvent* updateEvent)
 	const std::vector< std::vector<gr::tag_t> > tags = tevent->getTags();
 	const std::string sender = tevent->senderName();
 
+	if (tevent->persistenceOnly()) {
+		_accumulatePersistence(sender, dataPoints, numDataPoints);
+		return;
+	}
+
 	if ((d_nbPtsXAxis != 0) && (d_nbPtsXAxis <= numDataPoints)
 			&& sender == "Osc Time") {
 		Q_EMIT filledScreen(true, numDataPoints);
@@ -509,6 +548,43 @@ void TimeDomainDisplayPlot::newData(const QEvent* updateEvent)
 			tags);
 }
 
+/* Frames dropped by the sink's update time only grade the persistence
+ * layer. They are drawn with the x points of the last plotted frame, so
+ * they are skipped until a frame of the same length was plotted. */
+void
+TimeDomainDisplayPlot::_accumulatePersistence(const std::string &sender,
+					      const std::vector<double*> &dataPoints,
+					      const int64_t numDataPoints)
+{
+  int sinkIndex = d_sinkManager.indexOfSink(sender);
+
+  if(d_stop || !d_persistence_en || sinkIndex < 0) {
+    return;
+  }
+
+  Sink *sink = d_sinkManager.sink((unsigned int)sinkIndex);
+  if(numDataPoints != sink->channelsDataLength()) {
+    return;
+  }
+
+  int start = d_sinkManager.sinkFirstChannelPos(sender);
+  int ref_offset = countReferenceWaveform(start);
+  std::vector<double> ydata(d_semilogy ? numDataPoints : 0);
+
+  for(unsigned int i = 0; i < sink->numChannels(); i++) {
+    const double *y = dataPoints[i];
+
+    if(d_semilogy) {
+      for(int64_t n = 0; n < numDataPoints; n++)
+	ydata[n] = fabs(dataPoints[i][n]);
+      y = ydata.data();
+    }
+
+    accumulatePersistence(start + i + ref_offset, d_xdata[sinkIndex],
+			  y, numDataPoints, true);
+  }
+}
+
 void TimeDomainDisplayPlot::customEvent(QEvent * e)
 {
   if(e->type() == TimeUpdateEvent::Type()) {
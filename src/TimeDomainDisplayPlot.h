@@ -159,6 +159,11 @@ public:
   void enableDigitalPlotCurve(int curveId, bool enable);
   QwtPlotCurve *getDigitalPlotCurve(int curveId);
   int getNrDigitalPlotCurves() const;
+  const double *channelData(unsigned int chnIdx) const;
+
+  /* Keep processing new data without redrawing the plot */
+  void setHeadless(bool headless);
+  bool isHeadless() const;
 Q_SIGNALS:
   void channelAdded(int);
   void newData();
@@ -228,6 +233,9 @@ protected:
 private:
   void _resetXAxisPoints(double*& xAxis, unsigned long long numPoints, double sampleRate);
   void _autoScale(double bottom, double top);
+  void _accumulatePersistence(const std::string &sender,
+			      const std::vector<double*> &dataPoints,
+			      const int64_t numDataPoints);
 
   double d_sample_rate;
   double d_delay;
@@ -254,6 +262,7 @@ private:
 
   unsigned int d_nbPtsXAxis;
   bool d_curves_hidden;
+  bool d_headless;
 
   QColor getChannelColor();
 
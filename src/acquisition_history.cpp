@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "acquisition_history.hpp"
+#include "filemanager.h"
+
+#include <QDateTime>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+
+using namespace adiscope;
+
+AcquisitionHistory::AcquisitionHistory(unsigned int nb_channels,
+				       unsigned int capacity, size_t max_bytes):
+	m_nb_channels(std::max(nb_channels, 1u)),
+	m_requested_capacity(std::max(capacity, 1u)),
+	m_capacity(0),
+	m_max_bytes(max_bytes),
+	m_nb_samples(0),
+	m_next(0),
+	m_count(0)
+{
+}
+
+unsigned int AcquisitionHistory::nbChannels() const
+{
+	return m_nb_channels;
+}
+
+unsigned int AcquisitionHistory::capacity() const
+{
+	return m_requested_capacity;
+}
+
+void AcquisitionHistory::setCapacity(unsigned int capacity)
+{
+	capacity = std::max(capacity, 1u);
+	if (capacity == m_requested_capacity)
+		return;
+
+	m_requested_capacity = capacity;
+	allocate(m_nb_samples);
+}
+
+unsigned int AcquisitionHistory::size() const
+{
+	return m_count;
+}
+
+size_t AcquisitionHistory::samplesPerSegment() const
+{
+	return m_nb_samples;
+}
+
+void AcquisitionHistory::setSamplesPerSegment(size_t nb_samples)
+{
+	if (nb_samples != m_nb_samples || !m_capacity)
+		allocate(nb_samples);
+}
+
+unsigned int AcquisitionHistory::slot(unsigned int idx) const
+{
+	return (m_next + m_capacity - m_count + idx) % m_capacity;
+}
+
+const AcquisitionSegment& AcquisitionHistory::segment(unsigned int idx) const
+{
+	return m_segments[slot(idx)];
+}
+
+const double *AcquisitionHistory::data(unsigned int idx,
+				       unsigned int channel) const
+{
+	if (idx >= m_count || channel >= m_nb_channels)
+		return nullptr;
+
+	return m_data.data() + ((size_t)slot(idx) * m_nb_channels + channel)
+		* m_nb_samples;
+}
+
+std::vector<const double *> AcquisitionHistory::segmentData(
+		unsigned int idx) const
+{
+	std::vector<const double *> ret;
+
+	for (unsigned int ch = 0; ch < m_nb_channels; ch++)
+		ret.push_back(data(idx, ch));
+
+	return ret;
+}
+
+void AcquisitionHistory::allocate(size_t nb_samples)
+{
+	m_nb_samples = nb_samples;
+	m_next = 0;
+	m_count = 0;
+
+	/* Never hold more than m_max_bytes, whatever the capture length */
+	size_t segment_bytes = std::max<size_t>(1,
+			nb_samples * m_nb_channels * sizeof(double));
+	m_capacity = std::max<size_t>(1, std::min<size_t>(m_requested_capacity,
+			m_max_bytes / segment_bytes));
+
+	m_data.assign((size_t)m_capacity * m_nb_channels * nb_samples, 0.0);
+	m_segments.assign(m_capacity, AcquisitionSegment());
+}
+
+void AcquisitionHistory::clear()
+{
+	m_next = 0;
+	m_count = 0;
+}
+
+bool AcquisitionHistory::push(const std::vector<const float *>& channels,
+			      const AcquisitionSegment& info)
+{
+	if (!info.nb_samples || info.nb_samples != m_nb_samples || !m_capacity)
+		return false;
+
+	double *dst = m_data.data() + (size_t)m_next * m_nb_channels
+		* m_nb_samples;
+
+	for (unsigned int ch = 0; ch < m_nb_channels; ch++) {
+		if (ch < channels.size() && channels[ch]) {
+			std::copy(channels[ch], channels[ch] + m_nb_samples,
+				  dst);
+		} else {
+			std::fill_n(dst, m_nb_samples, 0.0);
+		}
+		dst += m_nb_samples;
+	}
+
+	m_segments[m_next] = info;
+	m_next = (m_next + 1) % m_capacity;
+	m_count = std::min(m_count + 1, m_capacity);
+
+	return true;
+}
+
+bool AcquisitionHistory::exportToFile(const QString& fileName,
+				      const QString& toolName) const
+{
+	if (!m_count)
+		return false;
+
+	FileManager fm(toolName);
+	fm.open(fileName, FileManager::EXPORT);
+
+	const AcquisitionSegment& first = segment(0);
+	QVector<double> time_data(m_nb_samples);
+	for (size_t i = 0; i < m_nb_samples; i++)
+		time_data[i] = i / first.sample_rate;
+
+	fm.save(time_data, "Time(S)");
+
+	QStringList info;
+	for (unsigned int s = 0; s < m_count; s++) {
+		const AcquisitionSegment& seg = segment(s);
+
+		info += QString("S%1 %2 %3").arg(s + 1)
+			.arg(QDateTime::fromMSecsSinceEpoch(seg.timestamp)
+			     .toString("yyyy-MM-dd hh:mm:ss.zzz"))
+			.arg(seg.triggered ? "triggered" : "untriggered");
+
+		for (unsigned int ch = 0; ch < m_nb_channels; ch++) {
+			const double *src = data(s, ch);
+			QVector<double> column(m_nb_samples);
+			std::copy(src, src + m_nb_samples, column.begin());
+
+			fm.save(column, QString("S%1 CH%2(V)").arg(s + 1)
+				.arg(ch + 1));
+		}
+	}
+
+	fm.setAdditionalInformation(info.join("; "));
+	fm.setSampleRate(first.sample_rate);
+	fm.performWrite();
+
+	return true;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACQUISITION_HISTORY_HPP
+#define ACQUISITION_HISTORY_HPP
+
+#include <QtGlobal>
+#include <QString>
+
+#include <vector>
+
+namespace adiscope {
+struct AcquisitionSegment
+{
+	qint64 timestamp;	/* ms since epoch */
+	bool triggered;
+	int trigger_source;
+	double trigger_level;
+	double sample_rate;
+	size_t nb_samples;
+};
+
+/*
+ * Keeps the last captures of a tool in a preallocated ring. Storing a
+ * capture is a single copy per channel into the ring, converting the
+ * samples on the way; the storage is only reallocated when the capacity
+ * or the capture length is changed.
+ */
+class AcquisitionHistory
+{
+public:
+	AcquisitionHistory(unsigned int nb_channels, unsigned int capacity,
+			   size_t max_bytes);
+
+	unsigned int nbChannels() const;
+	unsigned int capacity() const;
+	void setCapacity(unsigned int capacity);
+
+	/* Number of stored segments; segment 0 is the oldest */
+	unsigned int size() const;
+	size_t samplesPerSegment() const;
+	void setSamplesPerSegment(size_t nb_samples);
+
+	const AcquisitionSegment& segment(unsigned int idx) const;
+	const double *data(unsigned int idx, unsigned int channel) const;
+	std::vector<const double *> segmentData(unsigned int idx) const;
+
+	/* Store a capture over the oldest one. A capture of a different
+	 * length than the stored ones is refused, as the segments would
+	 * not line up; setSamplesPerSegment() drops the history first. */
+	bool push(const std::vector<const float *>& channels,
+		  const AcquisitionSegment& info);
+	void clear();
+
+	/* Writes the time column followed by every channel of every
+	 * segment, one column each */
+	bool exportToFile(const QString& fileName, const QString& toolName) const;
+
+private:
+	unsigned int m_nb_channels;
+	unsigned int m_requested_capacity;
+	unsigned int m_capacity;
+	size_t m_max_bytes;
+	size_t m_nb_samples;
+
+	std::vector<double> m_data;
+	std::vector<AcquisitionSegment> m_segments;
+	unsigned int m_next;
+	unsigned int m_count;
+
+	void allocate(size_t nb_samples);
+	unsigned int slot(unsigned int idx) const;
+};
+}
+
+#endif /* ACQUISITION_HISTORY_HPP */
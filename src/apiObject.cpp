@@ -90,6 +90,17 @@ void ApiObject::load(QSettings& settings, const QString& prop,
 	settings.endArray();
 }
 
+bool ApiObject::isSameValue(const QVariant& saved, const QVariant& current)
+{
+	/* INI files keep most values as strings */
+	QVariant value = saved;
+
+	if (!current.isValid() || !value.convert(current.userType()))
+		return false;
+
+	return value == current;
+}
+
 void ApiObject::load_nogroup(ApiObject *obj, QSettings& settings)
 {
 	auto meta = obj->metaObject();
@@ -102,31 +113,36 @@ void ApiObject::load_nogroup(ApiObject *obj, QSettings& settings)
 		auto data = prop.read(obj);
 
 		if (prop.isWritable()) {
+			/* Only the properties that differ from the current
+			 * state are written, the setters might reconfigure
+			 * the hardware even when the value does not change */
 			if (data.canConvert<QList<bool>>()) {
 				auto list = load<bool>(settings, prop.name());
-				if (!list.empty())
+				if (!list.empty() && list != data.value<QList<bool>>())
 					prop.write(obj, QVariant::fromValue(list));
 			} else if (data.canConvert<QList<int>>()) {
 				auto list = load<int>(settings, prop.name());
-				if (!list.empty())
+				if (!list.empty() && list != data.value<QList<int>>())
 					prop.write(obj, QVariant::fromValue(list));
 			} else if (data.canConvert<QList<double>>()) {
 				auto list = load<double>(settings, prop.name());
-				if (!list.empty())
+				if (!list.empty() && list != data.value<QList<double>>())
 					prop.write(obj, QVariant::fromValue(list));
 			} else if (data.canConvert<QList<QString>>()) {
 				auto list = load<QString>(settings, prop.name());
-				if (!list.empty())
+				if (!list.empty() && list != data.value<QList<QString>>())
 					prop.write(obj, QVariant::fromValue(list));
 			} else {
 				auto value = settings.value(prop.name());
 
+				if (value.isNull() || isSameValue(value, data))
+					continue;
+
 				qDebug() << "Loading property"
 					<< prop.name()
 					<< "value" << value;
 
-				if (!value.isNull())
-					prop.write(obj, value);
+				prop.write(obj, value);
 			}
 		} else {
 			if (data.canConvert<ApiObject *>()) {
@@ -191,7 +207,9 @@ void ApiObject::load(QSettings& settings)
 {
 	settings.beginGroup(objectName());
 
+	beginLoad();
 	load_nogroup(this, settings);
+	endLoad();
 
 	settings.endGroup();
 
@@ -47,6 +47,12 @@ namespace adiscope {
 
 		void js_register(QJSEngine *engine);
 
+	protected:
+		/* Called around loading the properties, so the hardware and
+		 * flowgraph changes done by the setters can be applied at once */
+		virtual void beginLoad() {}
+		virtual void endLoad() {}
+
 	private:
 		template <typename T> void save(QSettings& settings,
 				const QString& prop, const QList<T>& list);
@@ -60,6 +66,9 @@ namespace adiscope {
 
 		void save_nogroup(ApiObject *, QSettings&);
 		void load_nogroup(ApiObject *, QSettings&);
+
+		static bool isSameValue(const QVariant& saved,
+				const QVariant& current);
 	};
 }
 
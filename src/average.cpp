@@ -22,9 +22,47 @@
 #include <algorithm>
 #include <cstring>
 #include <boost/make_shared.hpp>
+#include <volk/volk.h>
 
 using namespace adiscope;
 
+/* Running average step shared by the exponential averages:
+ * avg = (x + (history - 1) * avg) / history */
+static void exponentialStep(double *avg, const double *data,
+			    unsigned int width, unsigned int history,
+			    bool squared)
+{
+	const double weight = 1.0 / history;
+
+	for (unsigned int i = 0; i < width; i++) {
+		const double x = squared ? data[i] * data[i] : data[i];
+		avg[i] += (x - avg[i]) * weight;
+	}
+}
+
+/* Stores a new row in the history and updates the window sums with it,
+ * removing the row it replaces when the window is full. The sums are
+ * built from the stored (single precision) values so that the values
+ * removed later are exactly the ones that were added. */
+static void slideWindowSums(double *sums, float *row, const double *data,
+			    unsigned int width, bool full, bool squared)
+{
+	if (full) {
+		for (unsigned int i = 0; i < width; i++) {
+			const double old = row[i];
+			row[i] = data[i];
+			const double x = row[i];
+			sums[i] += squared ? (x * x - old * old) : (x - old);
+		}
+	} else {
+		for (unsigned int i = 0; i < width; i++) {
+			row[i] = data[i];
+			const double x = row[i];
+			sums[i] += squared ? x * x : x;
+		}
+	}
+}
+
 /*
  * class SpectrumAverage
  */
@@ -96,12 +134,12 @@ AverageHistoryN::AverageHistoryN(unsigned int data_width, unsigned int history):
 	SpectrumAverage(data_width, history, true), m_insert_index(0),
 	m_inserted_count(0)
 {
-	alloc_history(m_data_width, m_history_size);
+	m_history = new float[m_history_size * m_data_width];
 }
 
 AverageHistoryN::~AverageHistoryN()
 {
-	free_history();
+	delete[] m_history;
 }
 
 void AverageHistoryN::reset()
@@ -110,76 +148,54 @@ void AverageHistoryN::reset()
 	m_insert_index = 0;
 }
 
-void AverageHistoryN::alloc_history(unsigned int data_width,
-	unsigned int history_size)
+float *AverageHistoryN::historyRow(unsigned int index) const
 {
-	boost::unique_lock<boost::mutex> lock(m_history_mutex);
-	m_history = new double*[history_size];
-	for (unsigned int i = 0; i < history_size; i++)
-		m_history[i] = new double[data_width];
+	return m_history + (size_t)index * m_data_width;
+}
 
+void AverageHistoryN::advanceInsertIndex()
+{
+	m_insert_index = (m_insert_index + 1) % m_history_size;
+	m_inserted_count = std::min(m_inserted_count + 1, m_history_size);
 }
 
-void AverageHistoryN::free_history()
+void AverageHistoryN::historyChanged()
 {
-	boost::unique_lock<boost::mutex> lock(m_history_mutex);
-	for (unsigned int i = 0; i < m_history_size; i++)
-		delete[] m_history[i];
-	delete[] m_history;
 }
 
 void AverageHistoryN::setHistory(unsigned int history)
 {
-	double **tmp_history;
-	tmp_history = new double*[history];
-
-	for (unsigned int i = 0; i < history; i++) {
-		tmp_history[i] = new double[m_data_width];
-	}
+	if (history < 1)
+		history = 1;
 
-	if (history > m_history_size) {
-		for (unsigned int i = 0; i < m_history_size; i++) {
-			std::memcpy(tmp_history[i], m_history[i],
-				    m_data_width * sizeof(double));
-		}
-	} else {
-		int start_index = (m_insert_index > history) ? (m_insert_index - history) : 0;
-		int remaining_samples = std::min(m_inserted_count, history);
-		int tmp_i = 0;
-
-		for (unsigned int i = start_index; i < m_insert_index; i++) {
-			std::memcpy(tmp_history[tmp_i], m_history[i],
-				    m_data_width * sizeof(double));
-			remaining_samples--;
-			tmp_i++;
-		}
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
 
-		for (unsigned int i = m_history_size - remaining_samples; i < m_history_size; i++) {
-			std::memcpy(tmp_history[tmp_i], m_history[i],
-				    m_data_width * sizeof(double));
-			tmp_i++;
-		}
+	// Keep the newest rows, stored oldest first
+	unsigned int count = std::min(m_inserted_count, history);
+	float *tmp_history = new float[(size_t)history * m_data_width];
 
-		if (m_insert_index > history) {
-			m_insert_index = 0;
-		}
-		m_inserted_count = std::min(m_inserted_count, history);
+	for (unsigned int i = 0; i < count; i++) {
+		unsigned int src = (m_insert_index + m_history_size - count + i)
+			% m_history_size;
+		std::memcpy(tmp_history + (size_t)i * m_data_width,
+			    historyRow(src), m_data_width * sizeof(float));
 	}
 
-	free_history();
-
-	boost::unique_lock<boost::mutex> lock(m_history_mutex);
+	delete[] m_history;
 	m_history = tmp_history;
 	SpectrumAverage::setHistory(history);
+
+	m_inserted_count = count;
+	m_insert_index = count % history;
+
+	historyChanged();
 }
 
 void AverageHistoryN::pushNewData(double *data)
 {
 	boost::unique_lock<boost::mutex> lock(m_history_mutex);
-	std::memcpy(m_history[m_insert_index], data,
-		m_data_width * sizeof(double));
-	m_insert_index = (m_insert_index + 1) % m_history_size;
-	m_inserted_count = std::min(m_inserted_count + 1, m_history_size);
+	volk_64f_convert_32f(historyRow(m_insert_index), data, m_data_width);
+	advanceInsertIndex();
 }
 
 /*
@@ -193,8 +209,7 @@ PeakHoldContinuous::PeakHoldContinuous(unsigned int data_width,
 void PeakHoldContinuous::pushNewData(double *data)
 {
 	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = std::max(data[i], m_average[i]);
+		volk_64f_x2_max_64f(m_average, data, m_average, m_data_width);
 	} else {
 		std::memcpy(m_average, data, m_data_width * sizeof(double));
 		m_anyDataPushed = true;
@@ -212,8 +227,7 @@ MinHoldContinuous::MinHoldContinuous(unsigned int data_width,
 void MinHoldContinuous::pushNewData(double *data)
 {
 	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = std::min(data[i], m_average[i]);
+		volk_64f_x2_min_64f(m_average, data, m_average, m_data_width);
 	} else {
 		std::memcpy(m_average, data, m_data_width * sizeof(double));
 		m_anyDataPushed = true;
@@ -231,9 +245,8 @@ ExponentialRMS::ExponentialRMS(unsigned int data_width, unsigned int history):
 void ExponentialRMS::pushNewData(double *data)
 {
 	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = (data[i] * data[i] + (m_history_size - 1)
-				* m_average[i]) / m_history_size;
+		exponentialStep(m_average, data, m_data_width, m_history_size,
+				true);
 	} else {
 		for (unsigned int i = 0; i < m_data_width; i++)
 			m_average[i] = data[i] * data[i];
@@ -252,9 +265,8 @@ ExponentialAverage::ExponentialAverage(unsigned int data_width, unsigned int his
 void ExponentialAverage::pushNewData(double *data)
 {
 	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = (data[i] + (m_history_size - 1)
-				* m_average[i]) / m_history_size;
+		exponentialStep(m_average, data, m_data_width, m_history_size,
+				false);
 	} else {
 		std::memcpy(m_average, data, m_data_width * sizeof(double));
 		m_anyDataPushed = true;
@@ -262,103 +274,116 @@ void ExponentialAverage::pushNewData(double *data)
 }
 
 /*
- * class PeakHold
+ * class SlidingHold
  */
-PeakHold::PeakHold(unsigned int data_width, unsigned int history):
-	AverageHistoryN(data_width, history)
+SlidingHold::SlidingHold(unsigned int data_width, unsigned int history,
+			 bool keep_max):
+	AverageHistoryN(data_width, history), m_keep_max(keep_max)
 {
+	alloc_queues();
 }
 
-void PeakHold::pushNewData(double *data)
+SlidingHold::~SlidingHold()
 {
-	double *peaks = m_average;
-
-	if (m_inserted_count == 0 || m_history_size == 1) {
-		std::memcpy(peaks, data, m_data_width * sizeof(double));
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			if (data[i] > peaks[i])
-				peaks[i] = data[i];
-
-			if (m_inserted_count != m_history_size)
-				continue;
-
-			// If the value that we're about to drop (overwrite) is
-			// currently the peak we need to find a new peak
-			if (m_history[m_insert_index][i] == peaks[i])
-				peaks[i] = getPeakFromHistoryColumn(i);
-		}
-	}
-
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+	free_queues();
 }
 
-double PeakHold::getPeakFromHistoryColumn(unsigned int col)
+void SlidingHold::alloc_queues()
 {
-	if (m_inserted_count < 2)
-		return m_history[0][col];
-
-	unsigned int start = (m_insert_index != 0) ? 0 : 1;
-	double peak = m_history[start][col];
-
-	for (unsigned int i = start + 1; i < m_inserted_count; i++) {
-		if (i != m_insert_index && m_history[i][col] > peak)
-			peak = m_history[i][col];
-	}
+	m_queue = new unsigned int[(size_t)m_data_width * m_history_size];
+	m_queue_head = new unsigned int[m_data_width];
+	m_queue_len = new unsigned int[m_data_width];
+	clear_queues();
+}
 
-	return peak;
+void SlidingHold::free_queues()
+{
+	delete[] m_queue;
+	delete[] m_queue_head;
+	delete[] m_queue_len;
 }
 
-/*
- * class MinHold
- */
-MinHold::MinHold(unsigned int data_width, unsigned int history):
-	AverageHistoryN(data_width, history)
+void SlidingHold::clear_queues()
 {
+	std::fill_n(m_queue_head, m_data_width, 0);
+	std::fill_n(m_queue_len, m_data_width, 0);
 }
 
-void MinHold::pushNewData(double *data)
+void SlidingHold::queueRow(unsigned int row)
 {
-	double *mins = m_average;
+	const float *values = historyRow(row);
 
-	if (m_inserted_count == 0 || m_history_size == 1) {
-		std::memcpy(mins, data, m_data_width * sizeof(double));
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			if (data[i] < mins[i])
-				mins[i] = data[i];
+	for (unsigned int i = 0; i < m_data_width; i++) {
+		unsigned int *queue = m_queue + (size_t)i * m_history_size;
+		unsigned int head = m_queue_head[i];
+		unsigned int len = m_queue_len[i];
+
+		// The row being replaced leaves the window. Being the oldest,
+		// it can only be at the front of the queue.
+		if (len && queue[head] == row) {
+			head = (head + 1 == m_history_size) ? 0 : head + 1;
+			len--;
+		}
 
-			if (m_inserted_count != m_history_size)
-				continue;
+		// Drop the rows that the new value outlives and dominates
+		const float value = values[i];
+		while (len) {
+			unsigned int back = (head + len - 1) % m_history_size;
+			float back_value = historyRow(queue[back])[i];
 
-			// If the value that we're about to drop (overwrite) is
-			// currently the min we need to find a new min
-			if (m_history[m_insert_index][i] == mins[i])
-				mins[i] = getMinFromHistoryColumn(i);
+			if (m_keep_max ? back_value > value : back_value < value)
+				break;
+			len--;
 		}
+
+		queue[(head + len) % m_history_size] = row;
+		len++;
+
+		m_queue_head[i] = head;
+		m_queue_len[i] = len;
+		m_average[i] = historyRow(queue[head])[i];
 	}
+}
 
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+void SlidingHold::pushNewData(double *data)
+{
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
+	volk_64f_convert_32f(historyRow(m_insert_index), data, m_data_width);
+	queueRow(m_insert_index);
+	advanceInsertIndex();
 }
 
-double MinHold::getMinFromHistoryColumn(unsigned int col)
+void SlidingHold::reset()
 {
-	if (m_inserted_count < 2)
-		return m_history[0][col];
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
+	clear_queues();
+	AverageHistoryN::reset();
+}
 
-	unsigned int start = (m_insert_index != 0) ? 0 : 1;
-	double min = m_history[start][col];
+void SlidingHold::historyChanged()
+{
+	free_queues();
+	alloc_queues();
 
-	for (unsigned int i = start + 1; i < m_inserted_count; i++) {
-		if (i != m_insert_index && m_history[i][col] < min)
-			min = m_history[i][col];
-	}
+	for (unsigned int i = 0; i < m_inserted_count; i++)
+		queueRow(i);
+}
 
-	return min;
+/*
+ * class PeakHold
+ */
+PeakHold::PeakHold(unsigned int data_width, unsigned int history):
+	SlidingHold(data_width, history, true)
+{
 }
 
+/*
+ * class MinHold
+ */
+MinHold::MinHold(unsigned int data_width, unsigned int history):
+	SlidingHold(data_width, history, false)
+{
+}
 /*
  * class LinearRMSOne
  */
@@ -450,20 +475,10 @@ LinearRMS::~LinearRMS()
 
 void LinearRMS::pushNewData(double *data)
 {
-	if (m_inserted_count != m_history_size) {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sqr_sums[i] += (data[i] * data[i]);
-		}
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sqr_sums[i] -= (m_history[m_insert_index][i] *
-				m_history[m_insert_index][i]);
-			m_sqr_sums[i] += (data[i] * data[i]);
-		}
-	}
-
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
+	slideWindowSums(m_sqr_sums, historyRow(m_insert_index), data,
+			m_data_width, m_inserted_count == m_history_size, true);
+	advanceInsertIndex();
 }
 
 void LinearRMS::getAverage(double *out_data, unsigned int num_samples) const
@@ -471,7 +486,7 @@ void LinearRMS::getAverage(double *out_data, unsigned int num_samples) const
 	unsigned int num = std::min(m_data_width, num_samples);
 
 	for (unsigned int i = 0; i < num; i++)
-		out_data[i] = sqrt(m_sqr_sums[i] / m_inserted_count);
+		out_data[i] = sqrt(std::max(0.0, m_sqr_sums[i] / m_inserted_count));
 }
 
 void LinearRMS::reset()
@@ -480,6 +495,17 @@ void LinearRMS::reset()
 	AverageHistoryN::reset();
 }
 
+void LinearRMS::historyChanged()
+{
+	std::fill_n(m_sqr_sums, m_data_width, 0);
+
+	for (unsigned int r = 0; r < m_inserted_count; r++) {
+		const float *row = historyRow(r);
+		for (unsigned int i = 0; i < m_data_width; i++)
+			m_sqr_sums[i] += (double)row[i] * row[i];
+	}
+}
+
 /*
  * class LinearAverage
  */
@@ -496,19 +522,10 @@ LinearAverage::~LinearAverage()
 
 void LinearAverage::pushNewData(double *data)
 {
-	if (m_inserted_count != m_history_size) {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sums[i] += data[i];
-		}
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sums[i] -= m_history[m_insert_index][i];
-			m_sums[i] += data[i];
-		}
-	}
-
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
+	slideWindowSums(m_sums, historyRow(m_insert_index), data,
+			m_data_width, m_inserted_count == m_history_size, false);
+	advanceInsertIndex();
 }
 
 void LinearAverage::getAverage(double *out_data, unsigned int num_samples) const
@@ -524,3 +541,14 @@ void LinearAverage::reset()
 	std::fill_n(m_sums, m_data_width, 0);
 	AverageHistoryN::reset();
 }
+
+void LinearAverage::historyChanged()
+{
+	std::fill_n(m_sums, m_data_width, 0);
+
+	for (unsigned int r = 0; r < m_inserted_count; r++) {
+		const float *row = historyRow(r);
+		for (unsigned int i = 0; i < m_data_width; i++)
+			m_sums[i] += row[i];
+	}
+}
@@ -56,6 +56,10 @@ protected:
 	bool m_anyDataPushed;
 };
 
+/*
+ * The history is kept in single precision, in one contiguous block of
+ * m_history_size rows of m_data_width values each, used as a ring.
+ */
 class AverageHistoryN: public SpectrumAverage
 {
 public:
@@ -65,14 +69,19 @@ public:
 	virtual void reset();
 
 protected:
-	double **m_history;
+	float *m_history;
 	unsigned int m_insert_index;
 	unsigned int m_inserted_count;
 	boost::mutex m_history_mutex;
 
+	float *historyRow(unsigned int index) const;
+	void advanceInsertIndex();
+
+	/* Called with the history mutex held after the history was
+	 * resized; the rows are then stored oldest first from index 0 */
+	virtual void historyChanged();
+
 private:
-	void alloc_history(unsigned int data_width, unsigned int history_size);
-	void free_history();
 	void setHistory(unsigned int) override;
 };
 
@@ -128,24 +137,46 @@ private:
 	unsigned int m_inserted_count;
 };
 
-class PeakHold: public AverageHistoryN
+/*
+ * Sliding window maximum (or minimum) of each column. Every column keeps
+ * a monotonic queue of the history rows that can still become the
+ * extreme, so each push costs amortized O(1) per bin, whatever the
+ * history size.
+ */
+class SlidingHold: public AverageHistoryN
 {
 public:
-	PeakHold(unsigned int data_width, unsigned int history);
+	SlidingHold(unsigned int data_width, unsigned int history,
+		    bool keep_max);
+	~SlidingHold();
 	virtual void pushNewData(double *data);
+	virtual void reset();
+
+protected:
+	void historyChanged() override;
 
 private:
-	double getPeakFromHistoryColumn(unsigned int col);
+	bool m_keep_max;
+	unsigned int *m_queue;
+	unsigned int *m_queue_head;
+	unsigned int *m_queue_len;
+
+	void alloc_queues();
+	void free_queues();
+	void clear_queues();
+	void queueRow(unsigned int row);
 };
 
-class MinHold: public AverageHistoryN
+class PeakHold: public SlidingHold
 {
 public:
-	MinHold(unsigned int data_width, unsigned int history);
-	virtual void pushNewData(double *data);
+	PeakHold(unsigned int data_width, unsigned int history);
+};
 
-private:
-	double getMinFromHistoryColumn(unsigned int col);
+class MinHold: public SlidingHold
+{
+public:
+	MinHold(unsigned int data_width, unsigned int history);
 };
 
 class LinearRMS: public AverageHistoryN
@@ -158,6 +189,9 @@ public:
 		unsigned int num_samples) const;
 	virtual void reset();
 
+protected:
+	void historyChanged() override;
+
 private:
 	double *m_sqr_sums;
 };
@@ -172,6 +206,9 @@ public:
 		unsigned int num_samples) const;
 	virtual void reset();
 
+protected:
+	void historyChanged() override;
+
 private:
 	double *m_sums;
 };
@@ -23,20 +23,31 @@
 #include <libm2k/m2kexceptions.hpp>
 
 #include <errno.h>
+#include <cmath>
 #include <QDebug>
+#include <QDateTime>
+#include <QSettings>
 #include <QtGlobal>
 #include <iio.h>
 #include <QThread>
 
 #include "calibration_api.hpp"
 
+/* Coefficients are considered valid within this temperature range */
+#define CALIB_CACHE_TEMP_BUCKET 5.0
+/* Cached coefficients older than this are recomputed */
+#define CALIB_CACHE_MAX_AGE_DAYS 7
+#define CALIB_CACHE_GROUP "CalibrationCache"
+#define CALIB_TEMP_DEVICE "ad9963"
+
 using namespace adiscope;
 
 Calibration::Calibration(struct iio_context *ctx, QJSEngine *engine):
 	m_api(new Calibration_API(this)),
 	m_cancel(false),
 	m_ctx(ctx),
-	m_initialized(false)
+	m_initialized(false),
+	m_calibTemperature(NAN)
 {
 	m_api->setObjectName("calib");
 	m_api->js_register(engine);
@@ -113,6 +124,7 @@ bool Calibration::calibrateAll()
 	if(!ok || m_cancel)
 		goto calibration_fail;
 
+	m_calibTemperature = readTemperature();
 	return true;
 
 calibration_fail:
@@ -142,7 +154,124 @@ bool Calibration::hasContextCalibration() const
 
 float Calibration::calibrateFromContext()
 {
-	return m_m2k->calibrateFromContext();
+	float temperature = m_m2k->calibrateFromContext();
+	m_calibTemperature = temperature;
+	return temperature;
+}
+
+double Calibration::readTemperature() const
+{
+	return getIioDevTemp(CALIB_TEMP_DEVICE);
+}
+
+QString Calibration::cacheKey(double temperature) const
+{
+	const char *serial = iio_context_get_attr_value(m_ctx, "hw_serial");
+	const char *firmware = iio_context_get_attr_value(m_ctx, "fw_version");
+
+	if (!serial || !firmware) {
+		return "";
+	}
+
+	int bucket = static_cast<int>(std::floor(temperature /
+						 CALIB_CACHE_TEMP_BUCKET));
+
+	return QString("%1/%2/%3").arg(serial).arg(firmware).arg(bucket);
+}
+
+bool Calibration::calibrateFromCache()
+{
+	if (!m_initialized) {
+		return false;
+	}
+
+	double temperature = readTemperature();
+	QString key = cacheKey(temperature);
+	if (key.isEmpty()) {
+		return false;
+	}
+
+	QSettings settings;
+	settings.beginGroup(CALIB_CACHE_GROUP);
+	settings.beginGroup(key);
+
+	QDateTime timestamp = settings.value("timestamp").toDateTime();
+	if (!timestamp.isValid() ||
+			timestamp.daysTo(QDateTime::currentDateTime()) >= CALIB_CACHE_MAX_AGE_DAYS) {
+		return false;
+	}
+
+	try {
+		for (unsigned int i = 0; i < 2; i++) {
+			m_m2k->setAdcCalibrationOffset(i,
+				settings.value(QString("adc_offset%1").arg(i)).toInt());
+			m_m2k->setAdcCalibrationGain(i,
+				settings.value(QString("adc_gain%1").arg(i)).toDouble());
+			m_m2k->setDacCalibrationOffset(i,
+				settings.value(QString("dac_offset%1").arg(i)).toInt());
+			m_m2k->setDacCalibrationGain(i,
+				settings.value(QString("dac_gain%1").arg(i)).toDouble());
+		}
+	} catch (libm2k::m2k_exception &e) {
+		qDebug(CAT_CALIBRATION) << e.what();
+		return false;
+	}
+
+	m_calibTemperature = settings.value("temperature", temperature).toDouble();
+
+	return true;
+}
+
+void Calibration::saveToCache()
+{
+	if (!m_initialized || std::isnan(m_calibTemperature)) {
+		return;
+	}
+
+	QString key = cacheKey(m_calibTemperature);
+	if (key.isEmpty()) {
+		return;
+	}
+
+	QSettings settings;
+	settings.beginGroup(CALIB_CACHE_GROUP);
+	settings.beginGroup(key);
+
+	try {
+		for (unsigned int i = 0; i < 2; i++) {
+			settings.setValue(QString("adc_offset%1").arg(i),
+					  m_m2k->getAdcCalibrationOffset(i));
+			settings.setValue(QString("adc_gain%1").arg(i),
+					  m_m2k->getAdcCalibrationGain(i));
+			settings.setValue(QString("dac_offset%1").arg(i),
+					  m_m2k->getDacCalibrationOffset(i));
+			settings.setValue(QString("dac_gain%1").arg(i),
+					  m_m2k->getDacCalibrationGain(i));
+		}
+	} catch (libm2k::m2k_exception &e) {
+		qDebug(CAT_CALIBRATION) << e.what();
+		settings.endGroup();
+		settings.remove(key);
+		return;
+	}
+
+	settings.setValue("temperature", m_calibTemperature);
+	settings.setValue("timestamp", QDateTime::currentDateTime());
+}
+
+bool Calibration::temperatureDrifted()
+{
+	if (!m_initialized || std::isnan(m_calibTemperature)) {
+		return false;
+	}
+
+	return std::fabs(readTemperature() - m_calibTemperature) >=
+			CALIB_CACHE_TEMP_BUCKET;
+}
+
+void Calibration::markCalibratedNow()
+{
+	m_calibTemperature = readTemperature();
 }
 
 /* FIXME: TODO: Move this into a HW class / lib M2k */
@@ -27,6 +27,7 @@
 #include <cstdlib>
 #include <string>
 #include <memory>
+#include <QString>
 #include <libm2k/m2k.hpp>
 #include <libm2k/contextbuilder.hpp>
 
@@ -79,8 +80,21 @@ public:
 
 	double getIioDevTemp(const QString& devName) const;
 
+	/* Calibration cache: coefficients are stored per board serial,
+	 * firmware version and temperature bucket and are reused on the
+	 * next connection if they did not expire. */
+	bool calibrateFromCache();
+	void saveToCache();
+	bool temperatureDrifted();
+
+	/* The coefficients in use are valid at the current temperature,
+	 * e.g. when the board was already calibrated on connection */
+	void markCalibratedNow();
+
 	void cancelCalibration();
 private:
+	QString cacheKey(double temperature) const;
+	double readTemperature() const;
 
 	ApiObject *m_api;
 	volatile bool m_cancel;
@@ -88,6 +102,9 @@ private:
 	struct iio_context *m_ctx;
 	libm2k::context::M2k *m_m2k;
 	bool m_initialized;
+
+	/* Temperature at which the current coefficients were obtained */
+	double m_calibTemperature;
 };
 
 
@@ -19,30 +19,36 @@
  */
 #include "cancel_dc_offset_block.h"
 
-#include <gnuradio/blocks/moving_average.h>
-#include <gnuradio/blocks/repeat.h>
-#include <gnuradio/blocks/sub.h>
-#include <gnuradio/blocks/copy.h>
-#include <gnuradio/blocks/keep_one_in_n.h>
+#include <gnuradio/io_signature.h>
+
+#include <volk/volk.h>
+
+#include <algorithm>
+#include <cstring>
 
 using namespace adiscope;
 using namespace gr;
 
+cancel_dc_offset_block::sptr cancel_dc_offset_block::make(size_t buffer_size,
+		bool enabled)
+{
+	return gnuradio::get_initial_sptr(
+			new cancel_dc_offset_block(buffer_size, enabled));
+}
+
 cancel_dc_offset_block::cancel_dc_offset_block(size_t buffer_size, bool enabled):
-	hier_block2("DCOFFSET",
-		    io_signature::make(1, 1, sizeof(float)),
-		    io_signature::make(1, 1, sizeof(float))),
-	QObject(),
+	block("DCOFFSET",
+	      io_signature::make(1, 1, sizeof(float)),
+	      io_signature::make(1, 1, sizeof(float))),
 	d_enabled(enabled),
-	d_buffer_size(buffer_size),
+	d_buffer_size(std::max<size_t>(buffer_size, 1)),
 	d_dc_offset(0.0),
-	d_signal(boost::make_shared<signal_sample>())
+	d_buffer(d_buffer_size),
+	d_fill(0),
+	d_out_pos(0),
+	d_ready(false),
+	d_mean(0.0)
 {
-	_build_and_connect_blocks();
-
-	QObject::connect(&*d_signal, &signal_sample::triggered, [=](std::vector<float> samples){
-		d_dc_offset = samples[0];
-	});
 }
 
 cancel_dc_offset_block::~cancel_dc_offset_block()
@@ -51,18 +57,33 @@ cancel_dc_offset_block::~cancel_dc_offset_block()
 
 void cancel_dc_offset_block::set_enabled(bool enabled)
 {
-	if (d_enabled != enabled) {
-		d_enabled = enabled;
-		_build_and_connect_blocks();
-	}
+	std::unique_lock<std::mutex> lock(d_mutex);
+
+	d_enabled = enabled;
 }
 
 void cancel_dc_offset_block::set_buffer_size(size_t buffer_size)
 {
-	if (d_buffer_size != buffer_size) {
-		d_buffer_size = buffer_size;
-		_build_and_connect_blocks();
+	std::unique_lock<std::mutex> lock(d_mutex);
+
+	buffer_size = std::max<size_t>(buffer_size, 1);
+	if (buffer_size == d_buffer_size)
+		return;
+
+	/* Don't drop the samples already gathered, so that the output
+	 * stays aligned with the input */
+	if (!d_ready && d_fill) {
+		float sum;
+
+		volk_32f_accumulator_s32f(&sum, d_buffer.data(), d_fill);
+		d_mean = sum / d_fill;
+		d_dc_offset = d_mean;
+		d_ready = true;
 	}
+
+	d_buffer_size = buffer_size;
+	if (d_buffer.size() < d_buffer_size)
+		d_buffer.resize(d_buffer_size);
 }
 
 float cancel_dc_offset_block::get_dc_offset() const
@@ -70,36 +91,95 @@ float cancel_dc_offset_block::get_dc_offset() const
 	return d_dc_offset;
 }
 
-void cancel_dc_offset_block::_build_and_connect_blocks()
+void cancel_dc_offset_block::forecast(int noutput_items,
+		gr_vector_int &ninput_items_required)
 {
-	// Remove all connections
-	hier_block2::disconnect_all();
-
-	if (d_enabled) {
-		if(d_buffer_size == 0)
-			d_buffer_size = 1;
-		auto avg = gr::blocks::moving_average_ff::make(d_buffer_size, 1.0 / d_buffer_size, d_buffer_size);
-		auto keep = gr::blocks::keep_one_in_n::make(sizeof(float), d_buffer_size);
-		auto repeat = gr::blocks::repeat::make(sizeof(float), d_buffer_size);
-		auto sub = gr::blocks::sub_ff::make();
-
-		hier_block2::connect(this->self(), 0, avg, 0);
-		hier_block2::connect(avg, 0, keep, 0);
-		hier_block2::connect(keep, 0, d_signal, 0);
-		hier_block2::connect(keep, 0, repeat, 0);
-		hier_block2::connect(this->self(), 0, sub, 0);
-		hier_block2::connect(repeat, 0, sub, 1);
-		hier_block2::connect(sub, 0, this->self(), 0);
-	} else {
-		auto avg = gr::blocks::moving_average_ff::make(d_buffer_size, 1.0 / d_buffer_size, d_buffer_size);
-		auto keep = gr::blocks::keep_one_in_n::make(sizeof(float), d_buffer_size);
-
-		hier_block2::connect(this->self(), 0, avg, 0);
-		hier_block2::connect(avg, 0, keep, 0);
-		hier_block2::connect(keep, 0, d_signal, 0);
-
-		auto copy = gr::blocks::copy::make(sizeof(float));
-		hier_block2::connect(this->self(), 0, copy, 0);
-		hier_block2::connect(copy, 0, this->self(), 0);
+	/* A complete buffer can be written out without any new input */
+	ninput_items_required[0] = d_ready ? 0 : 1;
+}
+
+void cancel_dc_offset_block::subtract(const float *in, float *out,
+		size_t n) const
+{
+	if (!d_enabled) {
+		if (in != out)
+			memcpy(out, in, n * sizeof(float));
+		return;
 	}
+
+	const float mean = d_mean;
+
+	for (size_t i = 0; i < n; i++)
+		out[i] = in[i] - mean;
+}
+
+int cancel_dc_offset_block::general_work(int noutput_items,
+		gr_vector_int &ninput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	std::unique_lock<std::mutex> lock(d_mutex);
+
+	const float *in = (const float *) input_items[0];
+	float *out = (float *) output_items[0];
+	const size_t nin = ninput_items[0];
+	const size_t nout = noutput_items;
+	size_t consumed = 0, produced = 0;
+
+	for (;;) {
+		if (d_ready) {
+			size_t n = std::min(d_fill - d_out_pos, nout - produced);
+
+			if (!n)
+				break;
+
+			subtract(&d_buffer[d_out_pos], &out[produced], n);
+			produced += n;
+			d_out_pos += n;
+
+			if (d_out_pos == d_fill) {
+				d_ready = false;
+				d_fill = 0;
+				d_out_pos = 0;
+			}
+			continue;
+		}
+
+		/* A whole buffer is available, no need to gather it */
+		if (!d_fill && nin - consumed >= d_buffer_size &&
+				nout - produced >= d_buffer_size) {
+			float sum;
+
+			volk_32f_accumulator_s32f(&sum, &in[consumed],
+					d_buffer_size);
+			d_mean = sum / d_buffer_size;
+			d_dc_offset = d_mean;
+
+			subtract(&in[consumed], &out[produced], d_buffer_size);
+			consumed += d_buffer_size;
+			produced += d_buffer_size;
+			continue;
+		}
+
+		size_t n = std::min(d_buffer_size - d_fill, nin - consumed);
+
+		if (!n)
+			break;
+
+		memcpy(&d_buffer[d_fill], &in[consumed], n * sizeof(float));
+		d_fill += n;
+		consumed += n;
+
+		if (d_fill == d_buffer_size) {
+			float sum;
+
+			volk_32f_accumulator_s32f(&sum, d_buffer.data(), d_fill);
+			d_mean = sum / d_fill;
+			d_dc_offset = d_mean;
+			d_ready = true;
+		}
+	}
+
+	consume_each(consumed);
+	return produced;
 }
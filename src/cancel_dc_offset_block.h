@@ -20,31 +20,56 @@
 #ifndef CANCEL_DC_OFFSET_BLOCK_H
 #define CANCEL_DC_OFFSET_BLOCK_H
 
-#include <gnuradio/hier_block2.h>
+#include <gnuradio/block.h>
 
-#include "signal_sample.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace adiscope {
-class cancel_dc_offset_block : public gr::hier_block2, public QObject
+/* Subtracts from each buffer of buffer_size samples its own mean. The
+ * samples of a buffer are held until the buffer is complete; when a
+ * whole buffer is already available it is processed in place, in one
+ * pass computing the mean and one subtracting it. The mean of the last
+ * buffer is always measured, even when the cancelling is disabled. */
+class cancel_dc_offset_block : public gr::block
 {
 public:
-        cancel_dc_offset_block(size_t buffer_size, bool enabled);
-        ~cancel_dc_offset_block();
+	typedef boost::shared_ptr<cancel_dc_offset_block> sptr;
 
-        void set_enabled(bool enabled);
+	static sptr make(size_t buffer_size, bool enabled);
+	~cancel_dc_offset_block();
 
+	void set_enabled(bool enabled);
+
+	/* Can be changed while running; a partially filled buffer is
+	 * completed with the samples received so far */
 	void set_buffer_size(size_t buffer_size);
 
 	float get_dc_offset() const;
 
+	void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+	int general_work(int noutput_items,
+			gr_vector_int &ninput_items,
+			gr_vector_const_void_star &input_items,
+			gr_vector_void_star &output_items);
+
 private:
-        bool d_enabled;
-        size_t d_buffer_size;
-	float d_dc_offset;
-	boost::shared_ptr<signal_sample> d_signal;
+	cancel_dc_offset_block(size_t buffer_size, bool enabled);
+
+	void subtract(const float *in, float *out, size_t n) const;
 
-        void _build_and_connect_blocks();
+	std::mutex d_mutex;
+	bool d_enabled;
+	size_t d_buffer_size;
+	std::atomic<float> d_dc_offset;
 
+	/* Buffer being gathered, then written out */
+	std::vector<float> d_buffer;
+	size_t d_fill;
+	size_t d_out_pos;
+	bool d_ready;
+	float d_mean;
 };
 }
 
@@ -25,8 +25,12 @@
 #include "plotpickerwrapper.h"
 
 #include <qwt_plot_layout.h>
+#include <qwt_plot_directpainter.h>
 #include <QIcon>
 
+/* Minimum time between two full repaints while points are streamed */
+#define DBGRAPH_REPLOT_MS 40
+
 using namespace adiscope;
 
 void dBgraph::setupVerticalBars()
@@ -206,6 +210,13 @@ dBgraph::dBgraph(QWidget *parent, bool isdBgraph)
 
 	markerIntersection1->setAxes(QwtAxis::XTop, QwtAxis::YLeft);
 	markerIntersection2->setAxes(QwtAxis::XTop, QwtAxis::YLeft);
+
+	d_directPainter = new QwtPlotDirectPainter(this);
+	d_paintedPoints = 0;
+
+	d_replotTimer.setSingleShot(true);
+	d_replotTimer.setInterval(DBGRAPH_REPLOT_MS);
+	connect(&d_replotTimer, SIGNAL(timeout()), this, SLOT(onReplotTimeout()));
 }
 
 dBgraph::~dBgraph()
@@ -267,7 +278,8 @@ void dBgraph::setAxesTitles(const QString& x, const QString& y)
 	setAxisTitle(QwtAxis::YLeft, yTitle);
 }
 
-void dBgraph::plot(double x, double y)
+/* Returns true if the point replaced one of the previous sweep */
+bool dBgraph::appendPoint(double x, double y)
 {
 	if (!d_plotBar->isVisible() && !xdata.size()) {
 		if (d_plotBarEnabled) {
@@ -275,6 +287,8 @@ void dBgraph::plot(double x, double y)
 		}
 	}
 
+	d_plotBar->setPlotCoord(QPointF(x, d_plotBar->plotCoord().y()));
+
 	if (xdata.size() == numSamples) {
 		xdata[d_plotPosition] = x;
 		ydata[d_plotPosition] = y;
@@ -286,15 +300,55 @@ void dBgraph::plot(double x, double y)
 		if (d_plotPosition == numSamples) {
 			d_plotPosition = 0;
 		}
-	} else {
-		xdata.push_back(x);
-		ydata.push_back(y);
+
+		return true;
 	}
 
-	d_plotBar->setPlotCoord(QPointF(x, d_plotBar->plotCoord().y()));
+	xdata.push_back(x);
+	ydata.push_back(y);
+	return false;
+}
 
+void dBgraph::updateCurve(bool overwritten)
+{
 	curve.setRawSamples(xdata.data(), ydata.data(), xdata.size());
 
+	/* Only the new segment is painted now. Points replacing the ones
+	 * of a previous sweep need the old segments erased, so they wait
+	 * for the next full repaint. */
+	if (!overwritten && isVisible() && d_paintedPoints > 0 &&
+			d_paintedPoints < xdata.size()) {
+		d_directPainter->drawSeries(&curve, d_paintedPoints - 1,
+					    xdata.size() - 1);
+	}
+	d_paintedPoints = xdata.size();
+
+	if (!d_replotTimer.isActive()) {
+		d_replotTimer.start();
+	}
+}
+
+void dBgraph::plot(double x, double y)
+{
+	updateCurve(appendPoint(x, y));
+}
+
+void dBgraph::plot(const QVector<double>& x, const QVector<double>& y)
+{
+	bool overwritten = false;
+	const int count = qMin(x.size(), y.size());
+
+	for (int i = 0; i < count; i++) {
+		overwritten |= appendPoint(x[i], y[i]);
+	}
+
+	if (count) {
+		updateCurve(overwritten);
+	}
+}
+
+void dBgraph::onReplotTimeout()
+{
 	if (d_cursorsEnabled) {
 		onVCursor1Moved(d_vBar1->plotCoord().x());
 		onVCursor2Moved(d_vBar2->plotCoord().x());
@@ -376,6 +430,7 @@ void dBgraph::reset()
 	xdata.clear();
 	ydata.clear();
 	d_plotPosition = 0;
+	d_paintedPoints = 0;
 }
 
 void dBgraph::setColor(const QColor& color)
@@ -560,6 +615,12 @@ void dBgraph::sweepDone()
 	if (d_plotBarEnabled) {
 		d_plotBar->setVisible(false);
 	}
+
+	/* Show the complete sweep without waiting for the timer */
+	if (d_replotTimer.isActive()) {
+		d_replotTimer.stop();
+		onReplotTimeout();
+	}
 }
 
 void dBgraph::onFrequencyCursorPositionChanged(int pos)
@@ -25,6 +25,8 @@
 #include <qwt_plot_curve.h>
 #include <qwt_plot_marker.h>
 
+#include <QTimer>
+
 #include "customFifo.hpp"
 #include "symbol_controller.h"
 #include "plot_line_handle.h"
@@ -35,6 +37,7 @@ namespace adiscope {
 class OscScaleDraw;
 class PrefixFormatter;
 class OscScaleZoomer;
+class QwtPlotDirectPainter;
 
 class dBgraph : public DisplayPlot
 {
@@ -116,6 +119,7 @@ Q_SIGNALS:
 
 public Q_SLOTS:
 	void plot(double x, double y);
+	void plot(const QVector<double>& x, const QVector<double>& y);
 	void reset();
 
 	void setNumSamples(int num);
@@ -153,6 +157,7 @@ public Q_SLOTS:
 	bool addReferenceWaveformFromPlot();
 
 private Q_SLOTS:
+	void onReplotTimeout();
 	void onVCursor1Moved(double);
 	void onVCursor2Moved(double);
 protected Q_SLOTS:
@@ -176,12 +181,20 @@ private:
 	QVector<double> xdata, ydata;
 	unsigned int d_plotPosition;
 
+	/* New points are painted right away on top of the canvas, the
+	 * whole plot is redrawn at most once per DBGRAPH_REPLOT_MS */
+	QwtPlotDirectPainter *d_directPainter;
+	QTimer d_replotTimer;
+	int d_paintedPoints;
+
 	VertBar *d_plotBar;
 	VertBar *d_frequencyBar;
 	PrefixFormatter *d_formatter;
 
 	void setupVerticalBars();
 	void setupReadouts();
+	bool appendPoint(double x, double y);
+	void updateCurve(bool overwritten);
 };
 }
 
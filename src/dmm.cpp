@@ -310,8 +310,13 @@ void DMM::updateValuesList(std::vector<float> values)
 	ui->scaleCh1->setValue(volts_ch1);
 	ui->scaleCh2->setValue(volts_ch2);
 
-	ui->sismograph_ch1->plot(volts_ch1);
-	ui->sismograph_ch2->plot(volts_ch2);
+	/* The values queued meanwhile are added to the graphs together */
+	m_pendingCh1.push_back(volts_ch1);
+	m_pendingCh2.push_back(volts_ch2);
+	if (m_pendingCh1.size() == 1) {
+		QMetaObject::invokeMethod(this, "plotPendingValues",
+					  Qt::QueuedConnection);
+	}
 
 	checkPeakValues(0, volts_ch1);
 	checkPeakValues(1, volts_ch2);
@@ -325,6 +330,15 @@ void DMM::updateValuesList(std::vector<float> values)
 		data_cond.notify_all();
 }
 
+void DMM::plotPendingValues()
+{
+	ui->sismograph_ch1->plot(m_pendingCh1);
+	ui->sismograph_ch2->plot(m_pendingCh2);
+
+	m_pendingCh1.clear();
+	m_pendingCh2.clear();
+}
+
 void DMM::checkPeakValues(int ch, double peak)
 {
 	if(peak < m_min[ch])
@@ -22,6 +22,7 @@
 #define DMM_HPP
 
 #include <QPushButton>
+#include <QVector>
 #include <QWidget>
 #include <atomic>
 
@@ -87,6 +88,9 @@ namespace adiscope {
 
 		std::vector<double> m_min, m_max;
 
+		/* Values waiting to be added to the history graphs in one batch */
+		QVector<double> m_pendingCh1, m_pendingCh2;
+
 		std::vector<bool> m_autoGainEnabled;
 		std::vector<boost::circular_buffer<libm2k::analog::M2K_RANGE>> m_gainHistory;
 		int m_gainHistorySize;
@@ -115,6 +119,7 @@ namespace adiscope {
                 void setLineThicknessCh2(int idx);
 
                 void updateValuesList(std::vector<float> values);
+		void plotPendingValues();
 
 		void toggleAC();
 
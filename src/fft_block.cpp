@@ -23,10 +23,15 @@
 #include <gnuradio/fft/fft_vcc.h>
 #include <gnuradio/fft/fft_vfc.h>
 #include <gnuradio/fft/window.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/filter/freq_xlating_fir_filter_fcc.h>
 #include "stream_to_vector_overlap.h"
 
 #include "fft_block.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace adiscope;
 using namespace gr;
 
@@ -35,19 +40,47 @@ fft_block::fft_block(bool use_complex, size_t fft_size, unsigned int nbthreads)
 			io_signature::make(1, 1, use_complex ?
 				sizeof(gr_complex) : sizeof(float)),
 			io_signature::make(1, 1, sizeof(gr_complex))),
-	d_complex(use_complex)
+	d_complex(use_complex),
+	d_decimation(1),
+	d_samp_rate(0.0)
+{
+	connect_fft(fft_size, nbthreads);
+	hier_block2::connect(this->self(), 0, d_s2v_overlap, 0);
+}
+
+fft_block::fft_block(size_t fft_size, double samp_rate, double center,
+		unsigned int decimation, unsigned int nbthreads)
+	: hier_block2("Zoom FFT",
+			io_signature::make(1, 1, sizeof(float)),
+			io_signature::make(1, 1, sizeof(gr_complex))),
+	d_complex(true),
+	d_decimation(std::max(decimation, 1u)),
+	d_samp_rate(samp_rate)
+{
+	/* The decimating filter only computes the samples it keeps,
+	 * so its cost per input sample does not grow with the zoom */
+	d_xlat = filter::freq_xlating_fir_filter_fcc::make(d_decimation,
+			zoom_taps(samp_rate, d_decimation), 0.0, samp_rate);
+	set_center_frequency(center);
+
+	connect_fft(fft_size, nbthreads);
+	hier_block2::connect(this->self(), 0, d_xlat, 0);
+	hier_block2::connect(d_xlat, 0, d_s2v_overlap, 0);
+}
+
+void fft_block::connect_fft(size_t fft_size, unsigned int nbthreads)
 {
 	auto v2s = blocks::vector_to_stream::make(sizeof(gr_complex), fft_size);
 
 	d_s2v_overlap = adiscope::stream_to_vector_overlap::make(
-				use_complex ? sizeof(gr_complex) : sizeof(float),
+				d_complex ? sizeof(gr_complex) : sizeof(float),
 				fft_size, 0.0);
 
 	/* We use a Hamming window for now */
 	auto window = fft::window::hamming(fft_size);
 
 	//basic_block_sptr fft;
-	if (use_complex)
+	if (d_complex)
 		d_fft = fft::fft_vcc::make(fft_size, true,
 				window, false, nbthreads);
 	else
@@ -55,12 +88,48 @@ fft_block::fft_block(bool use_complex, size_t fft_size, unsigned int nbthreads)
 				window, nbthreads);
 
 	/* Connect everything */
-	hier_block2::connect(this->self(), 0, d_s2v_overlap, 0);
 	hier_block2::connect(d_s2v_overlap, 0, d_fft, 0);
 	hier_block2::connect(d_fft, 0, v2s, 0);
 	hier_block2::connect(v2s, 0, this->self(), 0);
 }
 
+std::vector<gr_complex> fft_block::zoom_taps(double samp_rate,
+		unsigned int decimation)
+{
+	/* Band-pass over [0, span) relative to the mixing frequency:
+	 * a low-pass of half the span, shifted up by half the span.
+	 * After decimation the sample rate is 2 * span, so everything
+	 * that aliases lands in the negative half of the spectrum,
+	 * which is not displayed. */
+	double span = samp_rate / (2.0 * decimation);
+	auto lp = filter::firdes::low_pass(1.0, samp_rate,
+			span * 0.625, span * 0.25);
+
+	std::vector<gr_complex> taps(lp.size());
+	double w = 2.0 * M_PI * (span / 2.0) / samp_rate;
+
+	for (size_t i = 0; i < lp.size(); i++)
+		taps[i] = lp[i] * std::polar(1.0f, (float)(w * i));
+
+	return taps;
+}
+
+void fft_block::set_center_frequency(double center)
+{
+	if (!d_xlat)
+		return;
+
+	double span = d_samp_rate / (2.0 * d_decimation);
+
+	boost::dynamic_pointer_cast<filter::freq_xlating_fir_filter_fcc>(
+			d_xlat)->set_center_freq(center - span / 2.0);
+}
+
+unsigned int fft_block::decimation() const
+{
+	return d_decimation;
+}
+
 fft_block::~fft_block()
 {
 }
@@ -22,6 +22,7 @@
 #define FFT_BLOCK_HPP
 
 #include <gnuradio/hier_block2.h>
+#include <gnuradio/gr_complex.h>
 
 namespace adiscope {
 	class fft_block : public gr::hier_block2
@@ -29,15 +30,35 @@ namespace adiscope {
 	public:
 		fft_block(bool use_complex, size_t fft_size,
 				unsigned int nbthreads = 1);
+
+		/* Zoom FFT: the real input is mixed down around the center
+		 * frequency and decimated before a complex FFT. The first
+		 * half of each output frame then covers
+		 * [center - span / 2, center + span / 2), with
+		 * span = samp_rate / (2 * decimation). */
+		fft_block(size_t fft_size, double samp_rate, double center,
+				unsigned int decimation,
+				unsigned int nbthreads = 1);
 		~fft_block();
 
 		void set_window(const std::vector<float>& window);
 		void set_overlap_factor(double overlap_factor);
+		void set_center_frequency(double center);
+
+		unsigned int decimation() const;
+
+		static std::vector<gr_complex> zoom_taps(double samp_rate,
+				unsigned int decimation);
 
 	private:
 		bool d_complex;
+		unsigned int d_decimation;
+		double d_samp_rate;
 		gr::basic_block_sptr d_fft;
 		gr::basic_block_sptr d_s2v_overlap;
+		gr::basic_block_sptr d_xlat;
+
+		void connect_fft(size_t fft_size, unsigned int nbthreads);
 	};
 }
 
@@ -27,6 +27,8 @@
 #include <gnuradio/blocks/null_sink.h>
 #include <gnuradio/blocks/short_to_float.h>
 
+#include <boost/make_shared.hpp>
+
 #include <iio.h>
 #include <tool_launcher.hpp>
 using namespace adiscope;
@@ -42,7 +44,7 @@ iio_manager::iio_manager(unsigned int block_id,
 	QObject(nullptr),
 	top_block("IIO Manager " + std::to_string(block_id)),
 	id(block_id), _started(false), buffer_size(_buffer_size),
-	m_mixed_source(nullptr)
+	m_mixed_source(nullptr), lock_count(0), restart_on_unlock(false)
 {
 	m_context = libm2k::context::m2kOpen(ctx, "");
 	m_analogin = m_context->getAnalogIn();
@@ -80,6 +82,11 @@ iio_manager::iio_manager(unsigned int block_id,
 
 		hier_block2::connect(dummy_copy, i, dummy, i);
 
+		auto broadcaster = boost::make_shared<stream_broadcaster>(
+					IIO_BROADCASTER_CAPACITY);
+		hier_block2::connect(freq_comp_filt[i][1], 0,
+				broadcaster_sink::make(broadcaster), 0);
+		broadcasters.push_back(broadcaster);
 	}
 
 	dummy_copy->set_enabled(true);
@@ -195,6 +202,11 @@ void iio_manager::update_buffer_size_unlocked()
 			size = it->second;
 	}
 
+	for (auto it = attached.begin(); it != attached.end(); ++it) {
+		if (size < it->second)
+			size = it->second;
+	}
+
 	if (size) {
 		iio_block->set_buffer_size(size);
 		if (m_mixed_source) {
@@ -204,26 +216,98 @@ void iio_manager::update_buffer_size_unlocked()
 	}
 }
 
-void iio_manager::start(iio_manager::port_id copy)
+bool iio_manager::in_use_unlocked() const
 {
-	std::unique_lock<std::mutex> lock(copy_mutex);
+	if (!attached.empty())
+		return true;
 
-	if (copy->enabled())
-		return;
+	for (auto it = copy_blocks.cbegin(); it != copy_blocks.cend(); ++it) {
+		if (it->first->enabled())
+			return true;
+	}
 
-	qDebug(CAT_IIO_MANAGER) << "Enabling copy block" << copy->alias().c_str();
-	copy->set_enabled(true);
+	return false;
+}
 
+void iio_manager::start_unlocked()
+{
 	update_buffer_size_unlocked();
 
 	if (!_started) {
-		qDebug(CAT_IIO_MANAGER) << "Starting top block";
-		top_block::start();
+		if (lock_count) {
+			/* Someone is reconfiguring the flowgraph;
+			 * the last unlock() will start it */
+			restart_on_unlock = true;
+		} else {
+			qDebug(CAT_IIO_MANAGER) << "Starting top block";
+			top_block::start();
+		}
 	}
 
 	_started = true;
 }
 
+void iio_manager::stop_unlocked()
+{
+	if (in_use_unlocked()) {
+		update_buffer_size_unlocked();
+		return;
+	}
+
+	qDebug(CAT_IIO_MANAGER) << "Stopping top block";
+	if (lock_count) {
+		/* Already stopped by lock(), just don't restart it */
+		restart_on_unlock = false;
+	} else {
+		top_block::stop();
+		top_block::wait();
+	}
+
+	_started = false;
+}
+
+void iio_manager::lock()
+{
+	std::unique_lock<std::mutex> lock(copy_mutex);
+
+	if (lock_count++)
+		return;
+
+	restart_on_unlock = _started;
+	if (_started) {
+		gr::top_block::stop();
+		gr::top_block::wait();
+	}
+}
+
+void iio_manager::unlock()
+{
+	std::unique_lock<std::mutex> lock(copy_mutex);
+
+	if (!lock_count || --lock_count)
+		return;
+
+	if (restart_on_unlock) {
+		restart_on_unlock = false;
+		gr::top_block::start();
+
+		Q_EMIT restarted();
+	}
+}
+
+void iio_manager::start(iio_manager::port_id copy)
+{
+	std::unique_lock<std::mutex> lock(copy_mutex);
+
+	if (copy->enabled())
+		return;
+
+	qDebug(CAT_IIO_MANAGER) << "Enabling copy block" << copy->alias().c_str();
+	copy->set_enabled(true);
+
+	start_unlocked();
+}
+
 void iio_manager::set_filter_parameters(int channel, int index, bool enable, float TC, float gain, float sample_rate )
 {
 	freq_comp_filt[channel][index]->set_enable(enable);
@@ -235,7 +319,6 @@ void iio_manager::set_filter_parameters(int channel, int index, bool enable, flo
 void iio_manager::stop(iio_manager::port_id copy)
 {
 	std::unique_lock<std::mutex> lock(copy_mutex);
-	bool inuse = false;
 
 	if (!_started || !copy->enabled())
 		return;
@@ -243,20 +326,7 @@ void iio_manager::stop(iio_manager::port_id copy)
 	qDebug(CAT_IIO_MANAGER) << "Disabling copy block" << copy->alias().c_str();
 	copy->set_enabled(false);
 
-	/* Verify whether all blocks are disabled */
-	for (auto it = copy_blocks.cbegin();
-			!inuse && it != copy_blocks.cend(); ++it)
-		inuse = it->first->enabled();
-
-	if (!inuse) {
-		qDebug(CAT_IIO_MANAGER) << "Stopping top block";
-		top_block::stop();
-		top_block::wait();
-
-		_started = false;
-	} else {
-		update_buffer_size_unlocked();
-	}
+	stop_unlocked();
 }
 
 void iio_manager::stop_all()
@@ -265,6 +335,42 @@ void iio_manager::stop_all()
 		stop(it->first);
 }
 
+broadcaster_source::sptr iio_manager::attach(int src_port,
+		unsigned long _buffer_size)
+{
+	std::unique_lock<std::mutex> lock(copy_mutex);
+
+	if (_buffer_size > IIO_MAX_ATTACH_BUFFER_SIZE) {
+		qWarning(CAT_IIO_MANAGER) << "Buffer size" << _buffer_size <<
+			"too large for an attached consumer, using" <<
+			IIO_MAX_ATTACH_BUFFER_SIZE;
+		_buffer_size = IIO_MAX_ATTACH_BUFFER_SIZE;
+	}
+
+	auto source = broadcaster_source::make(broadcasters.at(src_port));
+	attached.push_back(std::make_pair(source, _buffer_size));
+
+	qDebug(CAT_IIO_MANAGER) << "Attaching consumer to channel" << src_port;
+	start_unlocked();
+
+	return source;
+}
+
+void iio_manager::detach(broadcaster_source::sptr source)
+{
+	std::unique_lock<std::mutex> lock(copy_mutex);
+
+	for (auto it = attached.begin(); it != attached.end(); ++it) {
+		if (it->first == source) {
+			attached.erase(it);
+			break;
+		}
+	}
+
+	if (_started)
+		stop_unlocked();
+}
+
 void iio_manager::connect(gr::basic_block_sptr src, int src_port,
 		gr::basic_block_sptr dst, int dst_port)
 {
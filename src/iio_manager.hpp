@@ -40,10 +40,18 @@
 #include <mutex>
 
 #include "timeout_block.hpp"
+#include "stream_broadcaster.hpp"
 
 /* 1k samples by default */
 #define IIO_BUFFER_SIZE 0x400
 
+/* Samples kept for the attached consumers of each channel */
+#define IIO_BROADCASTER_CAPACITY (1 << 22)
+
+/* Largest buffer size of an attached consumer. A consumer can fall a
+ * few of its buffers behind before it loses samples. */
+#define IIO_MAX_ATTACH_BUFFER_SIZE (IIO_BROADCASTER_CAPACITY / 4)
+
 namespace adiscope {
 	class iio_manager : public QObject, public gr::top_block
 	{
@@ -112,24 +120,26 @@ namespace adiscope {
 		 * locking/unlocking the flowgraph is sort of broken; the tags
 		 * are not properly routed to the blocks connected during the
 		 * reconfiguration. So until GNU Radio gets fixed, we just force
-		 * the whole flowgraph to stop when connecting new blocks. */
-		void lock() {
-			gr::top_block::stop();
-			// cancel acquisition, work might be blocked waiting for a trigger
-			// and the timeout. Don't wait for it just cancel the acquisition
-//			m_analogin->cancelAcquisition();
-//			m_analogin->stopAcquisition();
-//			m_context->stopMixedSignalAcquisition();
-//			m_analogin->cancelAcquisition();
-//			m_context->getDigital()->cancelAcquisition();
-
-//			m_context->stopMixedSignalAcquisition();
-
-			gr::top_block::wait();
-		}
-		void unlock() {
-//			m_context->startMixedSignalAcquisition(buffer_size);
-			gr::top_block::start(); }
+		 * the whole flowgraph to stop when connecting new blocks.
+		 * Nested lock() calls only stop the flowgraph once, and it is
+		 * only restarted by the outermost unlock() if it was running
+		 * (or a client was started in the meantime), which then emits
+		 * restarted(): the samples acquired around the restart are
+		 * lost. */
+		void lock();
+		void unlock();
+
+		/* Attach a consumer to the samples of a channel without
+		 * reconfiguring or stopping the flowgraph owned by the
+		 * manager. The returned source block belongs to the
+		 * consumer's own flowgraph. The hardware source runs while
+		 * at least one consumer is attached. The buffer size is
+		 * limited to IIO_MAX_ATTACH_BUFFER_SIZE. A consumer that
+		 * falls behind skips samples; the first sample after the gap
+		 * is marked with an "overrun" tag. */
+		broadcaster_source::sptr attach(int src_port,
+				unsigned long buffer_size = IIO_BUFFER_SIZE);
+		void detach(broadcaster_source::sptr source);
 
 		/* Set the timeout for the source device */
 		void set_device_timeout(unsigned int mseconds);
@@ -156,6 +166,14 @@ namespace adiscope {
 
 		std::vector<std::pair<port_id, unsigned long> > copy_blocks;
 
+		/* Fan-out stage, always connected after the compensation
+		 * filters of each channel */
+		std::vector<boost::shared_ptr<stream_broadcaster>> broadcasters;
+		std::vector<std::pair<broadcaster_source::sptr, unsigned long> > attached;
+
+		unsigned int lock_count;
+		bool restart_on_unlock;
+
 		gr::m2k::analog_in_source::sptr iio_block;
 		unsigned int nb_channels;
 
@@ -177,12 +195,16 @@ namespace adiscope {
 		void del_connection(gr::basic_block_sptr block, bool reverse);
 
 		void update_buffer_size_unlocked();
+		bool in_use_unlocked() const;
+		void start_unlocked();
+		void stop_unlocked();
 
 	private Q_SLOTS:
 		void got_timeout();
 
 	Q_SIGNALS:
 		void timeout();
+		void restarted();
 	};
 }
 
@@ -33,7 +33,7 @@ adiscope::logic::LogicTool::LogicTool(iio_context *ctx, adiscope::ToolMenuItem *
 
 }
 
-uint16_t *LogicTool::getData()
+const CaptureStore *LogicTool::getCaptureStore() const
 {
-	return m_buffer;
+	return &m_captureStore;
 }
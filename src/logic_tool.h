@@ -23,6 +23,7 @@
 #define LOGICTOOL_H
 
 #include "tool.hpp"
+#include "logicanalyzer/capturestore.h"
 
 namespace adiscope {
 namespace logic {
@@ -35,13 +36,14 @@ public:
 	          ToolLauncher *parent);
 	virtual ~LogicTool() = default;
 
-	uint16_t *getData();
+	const CaptureStore *getCaptureStore() const;
 
 Q_SIGNALS:
 	void dataAvailable(uint64_t, uint64_t);
 
 protected:
 	uint16_t *m_buffer;
+	CaptureStore m_captureStore;
 };
 } // namespace logic
 } // namespace adiscope
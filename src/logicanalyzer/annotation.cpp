@@ -47,9 +47,10 @@ extern "C" {
 
 #include <vector>
 
-Annotation::Annotation(const srd_proto_data *const pdata, const Row *row) :
-    start_sample_(pdata->start_sample),
-    end_sample_(pdata->end_sample),
+Annotation::Annotation(const srd_proto_data *const pdata, const Row *row,
+                       uint64_t sample_offset) :
+    start_sample_(pdata->start_sample + sample_offset),
+    end_sample_(pdata->end_sample + sample_offset),
     row_(row)
 {
     assert(pdata);
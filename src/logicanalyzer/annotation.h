@@ -59,7 +59,8 @@ public:
 public:
     Annotation() = default;
     Annotation(const Annotation &other) = default;
-    Annotation(const srd_proto_data *const pdata, const Row *row);
+    Annotation(const srd_proto_data *const pdata, const Row *row,
+               uint64_t sample_offset = 0);
 
     uint64_t start_sample() const;
     uint64_t end_sample() const;
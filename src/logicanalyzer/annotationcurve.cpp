@@ -52,6 +52,11 @@ using namespace adiscope::logic;
 AnnotationCurve::AnnotationCurve(logic::LogicTool *logic, std::shared_ptr<logic::Decoder> initialDecoder)
 	: GenericLogicPlotCurve(initialDecoder->decoder()->name, initialDecoder->decoder()->id, LogicPlotCurveType::Annotations)
 	, m_visibleRows(0)
+	, m_sampleOffset(0)
+	, m_keepFrom(0)
+	, m_keepUntil(UINT64_MAX)
+	, m_indexedAnnotations(0)
+	, m_cachedUntil(0)
 {
     setSamples(QVector<double>({0.0}), QVector<double>({0.0})),
     setRenderHint(RenderAntialiased, true);
@@ -129,9 +134,22 @@ void AnnotationCurve::annotationCallback(srd_proto_data *pdata, void *annotation
         return;
     }
 
+    // Drop annotations outside of the part of the capture owned by the
+    // current session and those of decoders whose output is cached
+    const uint64_t start = pdata->start_sample + curve->m_sampleOffset;
+    if (start < curve->m_keepFrom || start >= curve->m_keepUntil) {
+        return;
+    }
+
+    if (start < curve->m_cachedUntil &&
+            curve->m_cachedInstances.count(pdata->pdo->di)) {
+        return;
+    }
+
     std::unique_lock<std::mutex> lock(curve->m_mutex);
 
-    (*row_iter).second.emplace_annotation(pdata, &((*row_iter).first));
+    (*row_iter).second.emplace_annotation(pdata, &((*row_iter).first),
+                                          curve->m_sampleOffset);
 //	qDebug() << "Pushed annotation with format: " << format << " to row: " << (*row_iter).first.index();
 }
 
@@ -149,13 +167,56 @@ void AnnotationCurve::setClassRows(const std::map<std::pair<const srd_decoder *,
     m_classRows = classRows;
 }
 
-void AnnotationCurve::setAnnotationRows(const std::map<Row, RowData> &annotationRows)
+void AnnotationCurve::setAnnotationRows(const std::map<Row, RowData> &annotationRows, int keepRows)
 {
-    m_annotationRows = annotationRows;
+    // Rows below keepRows keep their annotations. The map nodes are left
+    // in place as the annotations point to their Row keys
+    auto it = m_annotationRows.begin();
+    while (it != m_annotationRows.end()) {
+        if (it->first.index() >= keepRows || !annotationRows.count(it->first)) {
+            it = m_annotationRows.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto &row : annotationRows) {
+        if (!m_annotationRows.count(row.first)) {
+            m_annotationRows.insert(row);
+        }
+    }
+}
+
+void AnnotationCurve::setDecodeWindow(uint64_t sampleOffset, uint64_t keepFrom, uint64_t keepUntil)
+{
+    m_sampleOffset = sampleOffset;
+    m_keepFrom = keepFrom;
+    m_keepUntil = keepUntil;
+}
+
+void AnnotationCurve::setCachedInstances(const std::set<const srd_decoder_inst *> &instances,
+                                         uint64_t cachedUntil)
+{
+    m_cachedInstances = instances;
+    m_cachedUntil = cachedUntil;
+}
+
+std::pair<uint64_t, uint64_t> AnnotationCurve::getVisibleSampleRange() const
+{
+    if (!plot()) {
+        return std::make_pair(0, 0);
+    }
+
+    const auto interval = plot()->axisInterval(QwtAxis::XBottom);
+
+    return std::make_pair(fromTimeToSample(interval.minValue()),
+                          fromTimeToSample(interval.maxValue()));
 }
 
 void AnnotationCurve::sort_rows()
 {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
     for (auto it = m_annotationRows.begin(); it != m_annotationRows.end(); ++it) {
         it->second.sort_annotations();
     }
@@ -172,6 +233,8 @@ void AnnotationCurve::reset()
 
     m_classRows.clear();
     m_annotationRows.clear();
+    m_annotationIndex.clear();
+    m_indexedAnnotations = 0;
 	m_annotationDecoder->reset();
 	m_visibleRows = 0;
 }
@@ -302,6 +365,48 @@ int AnnotationCurve::getVisibleRows() const
 	return m_visibleRows;
 }
 
+int64_t AnnotationCurve::findAnnotation(const QString &text, uint64_t from, bool forward)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	uint64_t total = 0;
+	for (const auto &row : m_annotationRows) {
+		total += row.second.size();
+	}
+
+	if (total != m_indexedAnnotations) {
+		m_annotationIndex.clear();
+		for (const auto &row : m_annotationRows) {
+			for (uint64_t i = 0; i < row.second.size(); ++i) {
+				const Annotation ann = row.second.getAnnAt(i);
+				for (const QString &value : ann.annotations()) {
+					m_annotationIndex[value.toLower()].push_back(ann.start_sample());
+				}
+			}
+		}
+
+		for (auto &starts : m_annotationIndex) {
+			std::sort(starts.begin(), starts.end());
+		}
+
+		m_indexedAnnotations = total;
+	}
+
+	const auto it = m_annotationIndex.constFind(text.toLower());
+	if (it == m_annotationIndex.constEnd()) {
+		return -1;
+	}
+
+	const std::vector<uint64_t> &starts = it.value();
+	if (forward) {
+		const auto next = std::upper_bound(starts.begin(), starts.end(), from);
+		return next != starts.end() ? *next : -1;
+	}
+
+	const auto next = std::lower_bound(starts.begin(), starts.end(), from);
+	return next != starts.begin() ? *std::prev(next) : -1;
+}
+
 AnnotationDecoder *AnnotationCurve::getAnnotationDecoder()
 {
 	return m_annotationDecoder;
@@ -28,8 +28,10 @@
 
 #include <memory>
 #include <mutex>
+#include <set>
 
 #include <QWidget>
+#include <QHash>
 
 #include "annotation.h"
 #include "row.h"
@@ -70,7 +72,12 @@ public:
     virtual void dataAvailable(uint64_t from, uint64_t to) override;
 
     void setClassRows(const std::map<std::pair<const srd_decoder*, int>, Row> &classRows);
-    void setAnnotationRows(const std::map<Row, RowData> &annotationRows);
+    void setAnnotationRows(const std::map<Row, RowData> &annotationRows, int keepRows = 0);
+
+    void setDecodeWindow(uint64_t sampleOffset, uint64_t keepFrom, uint64_t keepUntil);
+    void setCachedInstances(const std::set<const srd_decoder_inst *> &instances,
+                            uint64_t cachedUntil);
+    std::pair<uint64_t, uint64_t> getVisibleSampleRange() const;
 
     void sort_rows();
 
@@ -84,6 +91,8 @@ public:
 
 	int getVisibleRows() const;
 
+	int64_t findAnnotation(const QString &text, uint64_t from, bool forward);
+
 	AnnotationDecoder *getAnnotationDecoder();
 	std::vector<std::shared_ptr<adiscope::bind::Decoder>> getDecoderBindings();
 
@@ -133,6 +142,20 @@ private:
 
 	mutable int m_visibleRows;
 
+	// Set by the decode thread before each chunk is sent to the session
+	uint64_t m_sampleOffset;
+	uint64_t m_keepFrom;
+	uint64_t m_keepUntil;
+
+	// Start samples of the annotations for each (lower case) text,
+	// rebuilt when the number of annotations changes
+	QHash<QString, std::vector<uint64_t>> m_annotationIndex;
+	uint64_t m_indexedAnnotations;
+
+	// Decoder instances whose annotations are already cached
+	std::set<const srd_decoder_inst *> m_cachedInstances;
+	uint64_t m_cachedUntil;
+
 };
 }
 
@@ -24,10 +24,15 @@
 #include "logic_analyzer.h"
 #include <QDebug>
 #include <algorithm>
+#include <set>
 
 using namespace adiscope;
 
 constexpr uint64_t MAX_CHUNK_SIZE = 256 * 1024;
+// Sample offsets at which decoding may restart to reach the viewport
+constexpr uint64_t DECODE_CHECKPOINT_INTERVAL = 4 * MAX_CHUNK_SIZE;
+// Samples a restarted session is given to resynchronize on the protocol
+constexpr uint64_t DECODE_RESYNC_SAMPLES = 64 * 1024;
 
 std::mutex AnnotationDecoder::g_sessionMutex;
 
@@ -78,6 +83,11 @@ AnnotationDecoder::AnnotationDecoder(AnnotationCurve *annotationCurve, std::shar
     , m_logic(logic)
     , m_decodeCanceled(false)
     , m_lastSample(0)
+    , m_busy(false)
+    , m_sessionStart(0)
+    , m_sessionNext(0)
+    , m_cachedLevels(0)
+    , m_cachedRows(0)
 {
     // 1. Get stacked decoder from annotation Curve
     // 2. Configure curve (channels and annotations)
@@ -114,6 +124,9 @@ AnnotationDecoder::~AnnotationDecoder()
 
 void AnnotationDecoder::stackDecoder(std::shared_ptr<logic::Decoder> decoder)
 {
+    // The decoders below keep their input and options, reuse their output
+    m_cachedLevels = decodeFinished() ? m_stack.size() : 0;
+
     if (m_srdSession) {
         m_decodeCanceled = true;
         srd_session_terminate_reset(m_srdSession);
@@ -139,6 +152,8 @@ void AnnotationDecoder::stackDecoder(std::shared_ptr<logic::Decoder> decoder)
 
 void AnnotationDecoder::unstackDecoder(std::shared_ptr<logic::Decoder> decoder)
 {
+	const bool finished = decodeFinished();
+
 	if (m_srdSession) {
 	    m_decodeCanceled = true;
 	    srd_session_terminate_reset(m_srdSession);
@@ -157,7 +172,9 @@ void AnnotationDecoder::unstackDecoder(std::shared_ptr<logic::Decoder> decoder)
 
 	qDebug() << "stack size before deleting: " << m_stack.size();
 
-	m_stack.erase(std::find(m_stack.begin(), m_stack.end(), decoder));
+	auto it = std::find(m_stack.begin(), m_stack.end(), decoder);
+	m_cachedLevels = finished ? std::distance(m_stack.begin(), it) : 0;
+	m_stack.erase(it);
 
 	qDebug() << "stack size after deleting: " << m_stack.size();
 
@@ -187,27 +204,38 @@ void AnnotationDecoder::startDecode()
         }
     }
 
+    {
+        // clear the current queue content
+        std::unique_lock<std::mutex> lock(m_newDataMutex);
+        m_newDataQueue.clear();
+    }
+
     if (m_lastSample != 0) {
 
 //	m_annotationCurve->reset();
         // set curves class rows and annotation rows
         m_annotationCurve->setClassRows(m_class_rows);
-        m_annotationCurve->setAnnotationRows(m_annotation_rows);
-
-        std::unique_lock<std::mutex> lock(m_newDataMutex);
-        {
-            // clear the current queue content
-            std::queue<std::pair<uint64_t, uint64_t>> empty;
-            m_newDataQueue.swap(empty);
-        }
-        uint64_t q = m_lastSample / MAX_CHUNK_SIZE;
-        uint64_t r = m_lastSample % MAX_CHUNK_SIZE;
-        for (uint64_t i = 0; i < q; ++ i) {
-            m_newDataQueue.emplace(0 + i * MAX_CHUNK_SIZE, MAX_CHUNK_SIZE * (i + 1));
-        }
+        m_annotationCurve->setAnnotationRows(m_annotation_rows, m_cachedRows);
+
+        if (m_cachedLevels < m_stack.size()) {
+            // Start from the last checkpoint before the viewport and
+            // backfill the beginning of the capture afterwards
+            const uint64_t first = std::min(m_annotationCurve->getVisibleSampleRange().first,
+                                            m_lastSample);
+            uint64_t checkpoint = 0;
+            if (first > DECODE_RESYNC_SAMPLES) {
+                checkpoint = (first - DECODE_RESYNC_SAMPLES) / DECODE_CHECKPOINT_INTERVAL
+                        * DECODE_CHECKPOINT_INTERVAL;
+            }
 
-        if (r != 0) {
-            m_newDataQueue.emplace(MAX_CHUNK_SIZE * q, MAX_CHUNK_SIZE * q + r);
+            if (!checkpoint) {
+                queueSegments(0, m_lastSample, 0, UINT64_MAX, false);
+            } else {
+                const uint64_t boundary = checkpoint + DECODE_RESYNC_SAMPLES;
+                queueSegments(checkpoint, m_lastSample, boundary, UINT64_MAX, false);
+                queueSegments(0, std::min(boundary + DECODE_RESYNC_SAMPLES, m_lastSample),
+                              0, boundary, true);
+            }
         }
     }
 
@@ -223,6 +251,8 @@ void AnnotationDecoder::startDecode()
         delete m_decodeThread;
     }
 
+    m_sessionStart = 0;
+    m_sessionNext = 0;
     m_decodeCanceled = false;
     m_decodeThread = new std::thread(&AnnotationDecoder::decodeProc, this);
 
@@ -270,7 +300,12 @@ void AnnotationDecoder::dataAvailable(uint64_t from, uint64_t to)
 
 		m_lastSample = to;
 
-		m_newDataQueue.emplace(from, to);
+		// New data continues the viewport session, ahead of any backfill
+		auto it = std::find_if(m_newDataQueue.begin(), m_newDataQueue.end(),
+				       [](const DecodeSegment &segment) {
+			return segment.backfill;
+		});
+		m_newDataQueue.insert(it, DecodeSegment{from, to, 0, UINT64_MAX, false});
 		lock.unlock();
 		m_newDataCv.notify_one();
 	}
@@ -283,6 +318,8 @@ std::vector<std::shared_ptr<logic::Decoder> > AnnotationDecoder::getDecoderStack
 
 void AnnotationDecoder::unassignChannel(uint16_t chId)
 {
+    m_cachedLevels = 0;
+
     if (m_srdSession) {
         m_decodeCanceled = true;
         srd_session_terminate_reset(m_srdSession);
@@ -325,6 +362,7 @@ void AnnotationDecoder::reset()
 //	std::unique_lock<std::mutex> lock(m_newDataMutex);
 
 	m_lastSample = 0;
+	m_cachedLevels = 0;
 	stopDecode();
 	stackChanged();
 	startDecode();
@@ -332,6 +370,8 @@ void AnnotationDecoder::reset()
 
 void AnnotationDecoder::assignChannel(uint16_t chId, uint16_t bitId)
 {
+    m_cachedLevels = 0;
+
     if (m_srdSession) {
         m_decodeCanceled = true;
         srd_session_terminate_reset(m_srdSession);
@@ -390,15 +430,26 @@ void AnnotationDecoder::stackChanged()
 
     m_stack.front()->set_channels(chls);
 
+    std::set<const srd_decoder_inst *> cachedInstances;
     srd_decoder_inst *prev_di = nullptr;
-    for (const shared_ptr<logic::Decoder>& dec : m_stack) {
-        srd_decoder_inst *const di = dec->create_decoder_inst(m_srdSession);
+    for (size_t level = 0; level < m_stack.size(); ++level) {
+        srd_decoder_inst *const di = m_stack[level]->create_decoder_inst(m_srdSession);
         if (prev_di)
             srd_inst_stack(m_srdSession, prev_di, di);
 
+        if (level < m_cachedLevels)
+            cachedInstances.insert(di);
+
         prev_di = di;
     }
 
+    m_annotationCurve->setCachedInstances(cachedInstances,
+                                          m_cachedLevels ? m_lastSample : 0);
+
+    m_class_rows.clear();
+    m_annotation_rows.clear();
+    m_cachedRows = 0;
+
     // Map out all annotation classes
     int row_index = 0;
     for (const shared_ptr<logic::Decoder>& dec : m_stack) {
@@ -424,7 +475,11 @@ void AnnotationDecoder::stackChanged()
     }
 
     int index = 0;
+    size_t level = 0;
     for (const shared_ptr<logic::Decoder>& dec : m_stack) {
+        if (level++ == m_cachedLevels)
+            m_cachedRows = index;
+
         assert(dec);
         const srd_decoder *const decc = dec->decoder();
         assert(dec->decoder());
@@ -447,34 +502,71 @@ void AnnotationDecoder::stackChanged()
         }
     }
 
+    if (m_cachedLevels >= m_stack.size())
+        m_cachedRows = index;
+
     // set curves class rows and annotation rows
     m_annotationCurve->setClassRows(m_class_rows);
-    m_annotationCurve->setAnnotationRows(m_annotation_rows);
+    m_annotationCurve->setAnnotationRows(m_annotation_rows, m_cachedRows);
 
     // register curve to receive new annotations from libsigrokdecode
     srd_pd_output_callback_add(m_srdSession, SRD_OUTPUT_ANN,
                                AnnotationCurve::annotationCallback, m_annotationCurve);
 }
 
+void AnnotationDecoder::queueSegments(uint64_t from, uint64_t to, uint64_t keepFrom,
+                                      uint64_t keepUntil, bool backfill)
+{
+    std::unique_lock<std::mutex> lock(m_newDataMutex);
+
+    for (uint64_t start = from; start < to; start += MAX_CHUNK_SIZE) {
+        const uint64_t stop = std::min(start + MAX_CHUNK_SIZE, to);
+        m_newDataQueue.push_back(DecodeSegment{start, stop, keepFrom, keepUntil, backfill});
+    }
+}
+
+void AnnotationDecoder::restartSession(uint64_t start)
+{
+    // libsigrokdecode can not save the decoder state, so jumping to a
+    // checkpoint starts a fresh session there and shifts its output
+    srd_session_terminate_reset(m_srdSession);
+    srd_session_metadata_set(m_srdSession, SRD_CONF_SAMPLERATE,
+                             g_variant_new_uint64(m_annotationCurve->getSampleRate()));
+    for (const std::shared_ptr<logic::Decoder> &dec : m_stack) {
+        dec->apply_all_options();
+    }
+
+    if (srd_session_start(m_srdSession) != SRD_OK) {
+        qDebug() << "srd_session_start returned error!";
+    }
+
+    m_sessionStart = start;
+    m_sessionNext = start;
+}
+
+bool AnnotationDecoder::decodeFinished()
+{
+    std::unique_lock<std::mutex> lock(m_newDataMutex);
+
+    return m_newDataQueue.empty() && !m_busy;
+}
+
 void AnnotationDecoder::decodeProc()
 {
     while (!m_decodeCanceled) {
 
         std::unique_lock<std::mutex> lock(m_newDataMutex);
+        m_busy = false;
 
         // Wait for data
-//        if (m_newDataQueue.empty()) {
-            m_newDataCv.wait(lock, [&]{return !m_newDataQueue.empty() || m_decodeCanceled;});
-//        }
+        m_newDataCv.wait(lock, [&]{return !m_newDataQueue.empty() || m_decodeCanceled;});
 
         if (m_decodeCanceled) {
-//            qDebug() << "cancel requested!";
             break;
         }
 
         for (const shared_ptr<logic::Decoder> & dec : m_stack) {
             if (!dec->have_required_channels()) {
-//                qDebug() << "not having required channels!";
                 // TODO: SET ERROR MESSAGE
                 return;
             }
@@ -482,32 +574,41 @@ void AnnotationDecoder::decodeProc()
 
         // TODO: CHECK FOR ERRORS
 
-//        qDebug() << "exit wait!";
-
-        uint64_t start, stop;
-        std::tie(start, stop) = m_newDataQueue.front();
-        m_newDataQueue.pop();
+        const DecodeSegment segment = m_newDataQueue.front();
+        m_newDataQueue.pop_front();
+        const bool backfillDone = segment.backfill &&
+                (m_newDataQueue.empty() || !m_newDataQueue.front().backfill);
+        m_busy = true;
         lock.unlock(); // unlock to allow new data to enter the queue
 
-        uint64_t chunkSize = stop - start;
+        uint64_t chunkSize = segment.stop - segment.start;
         std::unique_ptr<uint16_t []> chunk(new uint16_t[chunkSize]);
 
-        uint16_t *data = m_logic->getData();
-
-	if (!data) {
+        if (m_logic->getCaptureStore()->read(segment.start, chunkSize, chunk.get()) != chunkSize) {
 		continue;
 	}
 
-        memcpy(chunk.get(), data + start, chunkSize * sizeof(uint16_t));
-
-//        qDebug() << "send data!";
         std::lock_guard<std::mutex> srd_lock(g_sessionMutex);
 
-        if (srd_session_send(m_srdSession, start, stop, reinterpret_cast<uint8_t*>(
+        if (segment.start != m_sessionNext) {
+            restartSession(segment.start);
+        }
+
+        m_annotationCurve->setDecodeWindow(m_sessionStart, segment.keepFrom, segment.keepUntil);
+
+        if (srd_session_send(m_srdSession, segment.start - m_sessionStart,
+                             segment.stop - m_sessionStart, reinterpret_cast<uint8_t*>(
                                  chunk.get()), chunkSize, sizeof(uint16_t)) != SRD_OK) {
 //            qDebug() << "No bueno!";
         }
 
+        m_sessionNext = segment.stop;
+
+        // The backfill was appended after the viewport annotations
+        if (backfillDone) {
+            m_annotationCurve->sort_rows();
+        }
+
         // Notify curve that annotations are now available to be drawn on the plot
         // srd_session_send blocks untill all samples are processed
         m_annotationCurve->newAnnotations();
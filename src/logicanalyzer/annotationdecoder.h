@@ -29,7 +29,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
+#include <deque>
 
 #include <libsigrokdecode/libsigrokdecode.h>
 
@@ -68,6 +68,20 @@ private:
 
     void decodeProc();
 
+    void queueSegments(uint64_t from, uint64_t to, uint64_t keepFrom,
+                       uint64_t keepUntil, bool backfill);
+    void restartSession(uint64_t start);
+    bool decodeFinished();
+
+    struct DecodeSegment {
+        uint64_t start;
+        uint64_t stop;
+        // Only annotations starting in [keepFrom, keepUntil) are kept
+        uint64_t keepFrom;
+        uint64_t keepUntil;
+        // Decodes the part of the capture before the viewport checkpoint
+        bool backfill;
+    };
 
 private:
     AnnotationCurve *m_annotationCurve;
@@ -86,7 +100,17 @@ private:
     std::mutex m_newDataMutex;
     std::condition_variable m_newDataCv;
     static std::mutex g_sessionMutex;
-    std::queue<std::pair<uint64_t, uint64_t>> m_newDataQueue;
+    std::deque<DecodeSegment> m_newDataQueue;
+    bool m_busy;
+
+    // Sample numbers of the running session, which can only be fed
+    // contiguous data and is restarted to jump to a checkpoint
+    uint64_t m_sessionStart;
+    uint64_t m_sessionNext;
+
+    // Lower stack levels (and their rows) whose annotations are still valid
+    size_t m_cachedLevels;
+    int m_cachedRows;
     void initDecoderChannels();
 };
 }
@@ -0,0 +1,562 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "captureimport.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QtEndian>
+
+using namespace adiscope::logic;
+
+constexpr int NR_CHANNELS = 16;
+constexpr uint64_t READ_BLOCK_SIZE = 1 << 20;
+constexpr uint64_t WRITE_BLOCK_SIZE = 1 << 16;
+/* VCD files with a fine timescale and long idle times would expand to
+ * more samples than could be handled */
+constexpr uint64_t MAX_IMPORT_SAMPLES = 1ull << 32;
+
+namespace {
+
+/* Hands out the lines of a device without copying them */
+class LineReader
+{
+public:
+	explicit LineReader(QIODevice *device)
+		: m_device(device)
+		, m_buffer(READ_BLOCK_SIZE)
+		, m_begin(0)
+		, m_end(0)
+	{
+	}
+
+	bool readLine(const char *&begin, const char *&end)
+	{
+		for (;;) {
+			const char *data = m_buffer.data();
+			const char *newLine = static_cast<const char *>(
+						memchr(data + m_begin, '\n', m_end - m_begin));
+			if (newLine) {
+				begin = data + m_begin;
+				end = newLine;
+				m_begin = newLine - data + 1;
+				break;
+			}
+
+			if (m_begin) {
+				memmove(m_buffer.data(), data + m_begin, m_end - m_begin);
+				m_end -= m_begin;
+				m_begin = 0;
+			}
+			if (m_end == m_buffer.size()) {
+				m_buffer.resize(m_buffer.size() * 2);
+			}
+
+			const qint64 count = m_device->read(m_buffer.data() + m_end,
+							    m_buffer.size() - m_end);
+			if (count <= 0) {
+				if (m_begin == m_end) {
+					return false;
+				}
+
+				/* Last line, without a line ending */
+				begin = m_buffer.data() + m_begin;
+				end = m_buffer.data() + m_end;
+				m_begin = m_end;
+				break;
+			}
+			m_end += count;
+		}
+
+		if (end != begin && *(end - 1) == '\r') {
+			end--;
+		}
+
+		return true;
+	}
+
+private:
+	QIODevice *m_device;
+	std::vector<char> m_buffer;
+	size_t m_begin;
+	size_t m_end;
+};
+
+/* Splits the lines handed out by a LineReader on white space */
+class TokenReader
+{
+public:
+	explicit TokenReader(QIODevice *device)
+		: m_lines(device)
+		, m_pos(nullptr)
+		, m_end(nullptr)
+	{
+	}
+
+	bool next(const char *&begin, const char *&end)
+	{
+		for (;;) {
+			while (m_pos != m_end && isspace(static_cast<unsigned char>(*m_pos))) {
+				m_pos++;
+			}
+
+			if (m_pos != m_end) {
+				begin = m_pos;
+				while (m_pos != m_end && !isspace(static_cast<unsigned char>(*m_pos))) {
+					m_pos++;
+				}
+				end = m_pos;
+				return true;
+			}
+
+			if (!m_lines.readLine(m_pos, m_end)) {
+				return false;
+			}
+		}
+	}
+
+private:
+	LineReader m_lines;
+	const char *m_pos;
+	const char *m_end;
+};
+
+/* Batches the decoded samples before handing them to the store */
+class SampleWriter
+{
+public:
+	explicit SampleWriter(CaptureStore *store)
+		: m_store(store)
+		, m_written(0)
+	{
+		m_samples.reserve(WRITE_BLOCK_SIZE);
+	}
+
+	~SampleWriter()
+	{
+		flush();
+	}
+
+	void push(uint16_t sample)
+	{
+		m_samples.push_back(sample);
+		if (m_samples.size() == WRITE_BLOCK_SIZE) {
+			flush();
+		}
+	}
+
+	void fill(uint16_t sample, uint64_t count)
+	{
+		while (count) {
+			const uint64_t n = std::min<uint64_t>(count,
+							      WRITE_BLOCK_SIZE - m_samples.size());
+			m_samples.insert(m_samples.end(), n, sample);
+			count -= n;
+			if (m_samples.size() == WRITE_BLOCK_SIZE) {
+				flush();
+			}
+		}
+	}
+
+	void flush()
+	{
+		if (!m_samples.empty()) {
+			m_store->append(m_samples.data(), m_samples.size());
+			m_written += m_samples.size();
+			m_samples.clear();
+		}
+	}
+
+	uint64_t size() const
+	{
+		return m_written + m_samples.size();
+	}
+
+private:
+	CaptureStore *m_store;
+	std::vector<uint16_t> m_samples;
+	uint64_t m_written;
+};
+
+bool tokenIs(const char *begin, const char *end, const char *word)
+{
+	const size_t length = strlen(word);
+	return static_cast<size_t>(end - begin) == length && !memcmp(begin, word, length);
+}
+
+uint64_t parseUnsigned(const char *begin, const char *end, bool *ok = nullptr)
+{
+	uint64_t value = 0;
+	const char *p = begin;
+	for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+		value = value * 10 + (*p - '0');
+	}
+
+	if (ok) {
+		*ok = (p != begin && p == end);
+	}
+
+	return value;
+}
+
+/* Channel number from names like "DIO3", "DIO 3" or "Channel 3" */
+int channelFromName(const std::string &name)
+{
+	const size_t digits = name.find_first_of("0123456789");
+	if (digits == std::string::npos) {
+		return -1;
+	}
+
+	bool ok = false;
+	const int channel = parseUnsigned(name.data() + digits, name.data() + name.size(), &ok);
+
+	return (ok && channel < NR_CHANNELS) ? channel : -1;
+}
+
+} // namespace
+
+CaptureImport::CaptureImport(double defaultSampleRate)
+	: m_sampleRate(defaultSampleRate)
+{
+}
+
+CaptureImport::Format CaptureImport::formatOf(const QString &fileName)
+{
+	const QString suffix = QFileInfo(fileName).suffix().toLower();
+	if (suffix == "vcd") {
+		return VCD;
+	} else if (suffix == "csv" || suffix == "txt") {
+		return CSV;
+	}
+
+	return RAW;
+}
+
+bool CaptureImport::load(const QString &fileName, CaptureStore *store)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		m_error = QObject::tr("Can't open selected file");
+		return false;
+	}
+
+	store->clear();
+
+	bool done = false;
+	switch (formatOf(fileName)) {
+	case VCD:
+		done = loadVcd(&file, store);
+		break;
+	case CSV:
+		done = loadCsv(&file, store);
+		break;
+	case RAW:
+		done = loadRaw(&file, store);
+		break;
+	}
+
+	if (done && !store->size()) {
+		m_error = QObject::tr("The file holds no samples");
+		done = false;
+	}
+
+	if (!done) {
+		store->clear();
+	}
+
+	return done;
+}
+
+bool CaptureImport::loadVcd(QIODevice *device, CaptureStore *store)
+{
+	TokenReader tokens(device);
+	SampleWriter writer(store);
+	std::unordered_map<std::string, int> channels;
+	const char *begin = nullptr;
+	const char *end = nullptr;
+	double timescale = 0;
+
+	/* Declarations */
+	bool definitions = false;
+	std::vector<std::string> args;
+	while (!definitions && tokens.next(begin, end)) {
+		if (*begin != '$') {
+			continue;
+		}
+
+		const std::string keyword(begin, end);
+		args.clear();
+		while (tokens.next(begin, end) && !tokenIs(begin, end, "$end")) {
+			args.emplace_back(begin, end);
+		}
+
+		if (keyword == "$enddefinitions") {
+			definitions = true;
+		} else if (keyword == "$timescale") {
+			std::string text;
+			for (const std::string &arg : args) {
+				text += arg;
+			}
+
+			char *unit = nullptr;
+			const double value = strtod(text.c_str(), &unit);
+			const std::string units(unit);
+			const double scale = units == "s" ? 1 : units == "ms" ? 1e-3
+					   : units == "us" ? 1e-6 : units == "ns" ? 1e-9
+					   : units == "ps" ? 1e-12 : units == "fs" ? 1e-15 : 0;
+			timescale = value * scale;
+		} else if (keyword == "$var" && args.size() >= 4 && args[1] == "1") {
+			int channel = channelFromName(args[3]);
+			if (channel < 0) {
+				channel = channels.size();
+			}
+			if (channel < NR_CHANNELS) {
+				channels[args[2]] = channel;
+			}
+		}
+	}
+
+	if (!definitions || channels.empty()) {
+		m_error = QObject::tr("Invalid VCD file");
+		return false;
+	}
+
+	if (timescale > 0) {
+		m_sampleRate = 1.0 / timescale;
+	}
+
+	/* Value changes */
+	uint16_t value = 0;
+	uint64_t startTime = 0;
+	uint64_t time = 0;
+	bool started = false;
+
+	auto setBit = [&](char state, const char *idBegin, const char *idEnd) {
+		auto it = channels.find(std::string(idBegin, idEnd));
+		if (it == channels.end()) {
+			return;
+		}
+
+		const uint16_t mask = 1 << it->second;
+		value = (state == '1') ? (value | mask) : (value & ~mask);
+	};
+
+	while (tokens.next(begin, end)) {
+		switch (*begin) {
+		case '#': {
+			bool ok = false;
+			const uint64_t t = parseUnsigned(begin + 1, end, &ok);
+			if (!ok) {
+				m_error = QObject::tr("Invalid VCD timestamp");
+				return false;
+			}
+
+			if (!started) {
+				startTime = t;
+				time = t;
+				started = true;
+			} else if (t > time) {
+				if (t - startTime > MAX_IMPORT_SAMPLES) {
+					m_error = QObject::tr("The capture is too long");
+					return false;
+				}
+				writer.fill(value, t - time);
+				time = t;
+			}
+			break;
+		}
+		case '0': case '1':
+		case 'x': case 'X':
+		case 'z': case 'Z':
+			setBit(*begin, begin + 1, end);
+			break;
+		case 'b': case 'B':
+		case 'r': case 'R': {
+			/* Vector value, the identifier is the next token */
+			const char state = *(end - 1);
+			if (tokens.next(begin, end)) {
+				setBit(state, begin, end);
+			}
+			break;
+		}
+		case '$':
+			if (tokenIs(begin, end, "$comment")) {
+				while (tokens.next(begin, end) && !tokenIs(begin, end, "$end")) {
+				}
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (started) {
+		writer.push(value);
+	}
+
+	return true;
+}
+
+bool CaptureImport::loadCsv(QIODevice *device, CaptureStore *store)
+{
+	LineReader lines(device);
+	SampleWriter writer(store);
+	const char *begin = nullptr;
+	const char *end = nullptr;
+
+	char separator = 0;
+	bool sampleColumn = false;
+	std::vector<int> columns;
+
+	auto detectSeparator = [&]() {
+		for (const char *p = begin; p != end; ++p) {
+			if (*p == ',' || *p == '\t' || *p == ';') {
+				separator = *p;
+				return;
+			}
+		}
+		separator = ',';
+	};
+
+	while (lines.readLine(begin, end)) {
+		if (begin == end) {
+			continue;
+		}
+
+		/* Scopy file header */
+		if (*begin == ';') {
+			static const char srKey[] = ";Sample rate";
+			const size_t keyLength = sizeof(srKey) - 1;
+			if (static_cast<size_t>(end - begin) > keyLength + 1 &&
+					!memcmp(begin, srKey, keyLength)) {
+				const std::string number(begin + keyLength + 1, end);
+				const double sampleRate = strtod(number.c_str(), nullptr);
+				if (sampleRate > 0) {
+					m_sampleRate = sampleRate;
+				}
+			}
+			continue;
+		}
+
+		if (!separator) {
+			detectSeparator();
+
+			if (!isdigit(static_cast<unsigned char>(*begin))) {
+				/* Column names, "Sample" followed by the channels */
+				int column = 0;
+				for (const char *p = begin; p <= end; ++p) {
+					const char *field = p;
+					while (p != end && *p != separator) {
+						p++;
+					}
+
+					const std::string name(field, p);
+					if (!column && name == "Sample") {
+						sampleColumn = true;
+					} else {
+						const int channel = channelFromName(name);
+						columns.push_back(channel >= 0 ? channel
+									       : static_cast<int>(columns.size()));
+					}
+					column++;
+				}
+				continue;
+			}
+		}
+
+		uint16_t sample = 0;
+		int column = 0;
+		for (const char *p = begin; p <= end; ++p) {
+			bool high = false;
+			while (p != end && *p != separator) {
+				high |= (*p >= '1' && *p <= '9');
+				p++;
+			}
+
+			const int channel = column - sampleColumn;
+			if (channel >= 0) {
+				const int bit = channel < static_cast<int>(columns.size())
+						? columns[channel] : channel;
+				if (high && bit < NR_CHANNELS) {
+					sample |= 1 << bit;
+				}
+			}
+			column++;
+		}
+
+		writer.push(sample);
+	}
+
+	return true;
+}
+
+bool CaptureImport::loadRaw(QIODevice *device, CaptureStore *store)
+{
+	std::vector<uint16_t> samples(READ_BLOCK_SIZE / sizeof(uint16_t));
+	qint64 pending = 0;
+
+	for (;;) {
+		const qint64 count = device->read(reinterpret_cast<char *>(samples.data()) + pending,
+						  samples.size() * sizeof(uint16_t) - pending);
+		if (count < 0) {
+			m_error = QObject::tr("Can't read selected file");
+			return false;
+		}
+		if (!count) {
+			break;
+		}
+
+		/* An odd byte is kept for the next read */
+		const qint64 bytes = pending + count;
+		const uint64_t n = bytes / sizeof(uint16_t);
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+		for (uint64_t i = 0; i < n; ++i) {
+			samples[i] = qFromLittleEndian(samples[i]);
+		}
+#endif
+		store->append(samples.data(), n);
+
+		pending = bytes % sizeof(uint16_t);
+		if (pending) {
+			memcpy(samples.data(), reinterpret_cast<char *>(samples.data()) + n * sizeof(uint16_t),
+			       pending);
+		}
+	}
+
+	return true;
+}
+
+double CaptureImport::sampleRate() const
+{
+	return m_sampleRate;
+}
+
+QString CaptureImport::errorString() const
+{
+	return m_error;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTUREIMPORT_H
+#define CAPTUREIMPORT_H
+
+#include "capturestore.h"
+
+#include <cstdint>
+
+#include <QString>
+
+class QIODevice;
+
+namespace adiscope {
+namespace logic {
+
+/*
+ * Loads a capture saved to disk into a capture store. Supported are the
+ * Value Change Dump and CSV/TXT files written by the Logic Analyzer export
+ * and raw files holding one little endian 16 bit sample per DIO state.
+ * Files are parsed in place, in large blocks, and the samples are appended
+ * to the store as they are decoded.
+ */
+class CaptureImport
+{
+public:
+	enum Format {
+		VCD,
+		CSV,
+		RAW,
+	};
+
+	/* The sample rate to use when the file does not provide one */
+	explicit CaptureImport(double defaultSampleRate);
+
+	static Format formatOf(const QString &fileName);
+
+	bool load(const QString &fileName, CaptureStore *store);
+
+	double sampleRate() const;
+	QString errorString() const;
+
+private:
+	bool loadVcd(QIODevice *device, CaptureStore *store);
+	bool loadCsv(QIODevice *device, CaptureStore *store);
+	bool loadRaw(QIODevice *device, CaptureStore *store);
+
+	double m_sampleRate;
+	QString m_error;
+};
+
+} // namespace logic
+} // namespace adiscope
+
+#endif // CAPTUREIMPORT_H
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capturesearch.h"
+
+#include <algorithm>
+
+using namespace adiscope::logic;
+
+constexpr int NR_CHANNELS = 16;
+
+CaptureSearch::CaptureSearch(const CaptureStore *store)
+	: m_store(store)
+{
+}
+
+bool CaptureSearch::parsePattern(const QString &pattern, uint16_t &mask, uint16_t &value)
+{
+	/* Written like a binary number, the last character is DIO0 and
+	 * X marks the channels that are not compared */
+	const QString p = pattern.simplified().remove(' ').toUpper();
+	if (p.isEmpty() || p.size() > NR_CHANNELS) {
+		return false;
+	}
+
+	mask = 0;
+	value = 0;
+	for (int i = 0; i < p.size(); ++i) {
+		const uint16_t bit = 1 << (p.size() - 1 - i);
+		if (p[i] == '1') {
+			mask |= bit;
+			value |= bit;
+		} else if (p[i] == '0') {
+			mask |= bit;
+		} else if (p[i] != 'X') {
+			return false;
+		}
+	}
+
+	return mask != 0;
+}
+
+uint64_t CaptureSearch::readBlock(uint64_t block, std::vector<uint16_t> &samples) const
+{
+	/* Read one sample before the block so edges on its first sample
+	 * can be detected */
+	const uint64_t start = block * CaptureStore::blockSize();
+	const uint64_t first = start ? start - 1 : 0;
+
+	samples.resize(start + CaptureStore::blockSize() - first);
+	samples.resize(m_store->read(first, samples.size(), samples.data()));
+
+	return first;
+}
+
+int64_t CaptureSearch::findPattern(uint64_t from, uint16_t mask, uint16_t value,
+				   bool forward) const
+{
+	const uint64_t size = m_store->size();
+	const uint64_t blockSize = CaptureStore::blockSize();
+	const uint64_t blocks = m_store->blockCount();
+	std::vector<uint16_t> samples;
+
+	if (!size || (forward && from + 1 >= size) || (!forward && !from)) {
+		return -1;
+	}
+
+	value &= mask;
+
+	int64_t block = forward ? (from + 1) / blockSize : (std::min(from, size) - 1) / blockSize;
+	for (; block >= 0 && block < static_cast<int64_t>(blocks); block += forward ? 1 : -1) {
+		const CaptureStore::BlockSummary summary = m_store->blockSummary(block);
+
+		/* Some bit expected high is never high or the other way around */
+		if ((value & ~summary.orMask) || (~value & mask & summary.andMask)) {
+			continue;
+		}
+
+		const uint64_t first = readBlock(block, samples);
+		const uint64_t start = std::max<uint64_t>(block * blockSize, forward ? from + 1 : 0);
+		const uint64_t end = std::min<uint64_t>(first + samples.size(), forward ? size : from);
+
+		/* Only the transitions into the pattern are matches, so a long
+		 * matching run is a single result */
+		if (forward) {
+			for (uint64_t i = start; i < end; ++i) {
+				if ((samples[i - first] & mask) == value &&
+						(samples[i - 1 - first] & mask) != value) {
+					return i;
+				}
+			}
+		} else {
+			for (uint64_t i = end; i > start; --i) {
+				const uint64_t s = i - 1;
+				if ((samples[s - first] & mask) == value &&
+						(!s || (samples[s - 1 - first] & mask) != value)) {
+					return s;
+				}
+			}
+		}
+	}
+
+	return -1;
+}
+
+int64_t CaptureSearch::nextEdge(int64_t from, uint16_t bitMask) const
+{
+	const uint64_t blockSize = CaptureStore::blockSize();
+	const int64_t blocks = m_store->blockCount();
+	std::vector<uint16_t> samples;
+
+	const int64_t start = std::max<int64_t>(from + 1, 1);
+	for (int64_t block = start / blockSize; block < blocks; ++block) {
+		if (!(m_store->blockSummary(block).toggleMask & bitMask)) {
+			continue;
+		}
+
+		const uint64_t first = readBlock(block, samples);
+		for (uint64_t i = std::max<uint64_t>(start, first + 1); i < first + samples.size(); ++i) {
+			if ((samples[i - first] ^ samples[i - 1 - first]) & bitMask) {
+				return i;
+			}
+		}
+	}
+
+	return -1;
+}
+
+int64_t CaptureSearch::findPulse(uint64_t from, uint8_t bit, uint64_t maxWidth,
+				 bool forward) const
+{
+	const uint64_t blockSize = CaptureStore::blockSize();
+	const int64_t blocks = m_store->blockCount();
+	const uint16_t bitMask = 1 << bit;
+	std::vector<uint16_t> samples;
+
+	/* A pulse starts on an edge and ends on the next one. Each block is
+	 * decoded once, the edge seen last is carried across blocks. */
+	if (forward) {
+		const uint64_t start = from + 1;
+		int64_t lastEdge = -1;
+
+		for (int64_t block = start / blockSize; block < blocks; ++block) {
+			if (!(m_store->blockSummary(block).toggleMask & bitMask)) {
+				continue;
+			}
+
+			const uint64_t first = readBlock(block, samples);
+			for (uint64_t i = std::max<uint64_t>(start, first + 1); i < first + samples.size(); ++i) {
+				if (!((samples[i - first] ^ samples[i - 1 - first]) & bitMask)) {
+					continue;
+				}
+				if (lastEdge >= 0 && i - lastEdge < maxWidth) {
+					return lastEdge;
+				}
+				lastEdge = i;
+			}
+		}
+	} else {
+		/* The pulse found may end at or after from */
+		int64_t laterEdge = nextEdge(static_cast<int64_t>(from) - 1, bitMask);
+		const uint64_t before = laterEdge >= 0 ? laterEdge : m_store->size();
+
+		for (int64_t block = before ? static_cast<int64_t>((before - 1) / blockSize) : -1;
+				block >= 0; --block) {
+			if (!(m_store->blockSummary(block).toggleMask & bitMask)) {
+				continue;
+			}
+
+			const uint64_t first = readBlock(block, samples);
+			const uint64_t end = std::min<uint64_t>(before, first + samples.size());
+			for (uint64_t i = end; i > std::max<uint64_t>(first + 1, 1); --i) {
+				const uint64_t edge = i - 1;
+				if (!((samples[edge - first] ^ samples[edge - 1 - first]) & bitMask)) {
+					continue;
+				}
+				if (laterEdge >= 0 && edge < from && laterEdge - edge < maxWidth) {
+					return edge;
+				}
+				laterEdge = edge;
+			}
+		}
+	}
+
+	return -1;
+}
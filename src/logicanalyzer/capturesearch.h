@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTURESEARCH_H
+#define CAPTURESEARCH_H
+
+#include "capturestore.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <QString>
+
+namespace adiscope {
+namespace logic {
+
+/*
+ * Searches a capture for samples matching a bit pattern or for pulses
+ * narrower than a given width. Blocks that can not contain a match, as
+ * told by the store block summaries, are skipped without being decoded.
+ * All searches return the matching sample or -1; a pattern matches on
+ * the first sample of a run of matching samples.
+ */
+class CaptureSearch
+{
+public:
+	explicit CaptureSearch(const CaptureStore *store);
+
+	int64_t findPattern(uint64_t from, uint16_t mask, uint16_t value,
+			    bool forward) const;
+	int64_t findPulse(uint64_t from, uint8_t bit, uint64_t maxWidth,
+			  bool forward) const;
+
+	static bool parsePattern(const QString &pattern, uint16_t &mask,
+				 uint16_t &value);
+
+private:
+	int64_t nextEdge(int64_t from, uint16_t bitMask) const;
+	uint64_t readBlock(uint64_t block, std::vector<uint16_t> &samples) const;
+
+	const CaptureStore *m_store;
+};
+
+} // namespace logic
+} // namespace adiscope
+
+#endif // CAPTURESEARCH_H
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capturestore.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace adiscope::logic;
+
+/* Samples per chunk, run offsets within a chunk must fit in 16 bits */
+constexpr uint32_t CHUNK_SIZE = 1 << 16;
+/* A run takes twice the space of a raw sample */
+constexpr uint32_t MAX_RUNS_PER_CHUNK = CHUNK_SIZE / 2;
+
+CaptureStore::CaptureStore()
+	: m_size(0)
+{
+}
+
+void CaptureStore::clear()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_chunks.clear();
+	m_size = 0;
+}
+
+void CaptureStore::encode(Chunk &chunk, const uint16_t *data, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; ++i) {
+		chunk.summary.orMask |= data[i];
+		chunk.summary.andMask &= data[i];
+		if (chunk.hasLast && chunk.last != data[i]) {
+			chunk.summary.toggleMask |= chunk.last ^ data[i];
+			chunk.summary.transitions++;
+		}
+		chunk.last = data[i];
+		chunk.hasLast = true;
+
+		if (!chunk.raw.empty()) {
+			chunk.raw.push_back(data[i]);
+		} else if (chunk.runs.empty() || chunk.runs.back().value != data[i]) {
+			if (chunk.runs.size() == MAX_RUNS_PER_CHUNK) {
+				/* Too many transitions, fall back to raw samples */
+				chunk.raw.reserve(CHUNK_SIZE);
+				chunk.raw.resize(chunk.size);
+				for (size_t r = 0; r < chunk.runs.size(); ++r) {
+					const uint32_t end = r + 1 < chunk.runs.size() ?
+								chunk.runs[r + 1].offset : chunk.size;
+					std::fill(chunk.raw.begin() + chunk.runs[r].offset,
+						  chunk.raw.begin() + end, chunk.runs[r].value);
+				}
+				std::vector<Run>().swap(chunk.runs);
+				chunk.raw.push_back(data[i]);
+			} else {
+				chunk.runs.push_back({static_cast<uint16_t>(chunk.size), data[i]});
+			}
+		}
+
+		chunk.size++;
+	}
+
+	if (chunk.size == CHUNK_SIZE) {
+		chunk.runs.shrink_to_fit();
+	}
+}
+
+void CaptureStore::append(const uint16_t *data, uint64_t count)
+{
+	/* Only the capture thread appends, so the chunks are encoded
+	 * without holding the lock and published at the end */
+	std::vector<Chunk> chunks;
+	bool extendsTail = false;
+	uint16_t previous = 0;
+	bool hasPrevious = false;
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (!m_chunks.empty() && m_chunks.back().size < CHUNK_SIZE) {
+			chunks.push_back(m_chunks.back());
+			extendsTail = true;
+		} else if (!m_chunks.empty()) {
+			previous = m_chunks.back().last;
+			hasPrevious = true;
+		}
+	}
+
+	while (count) {
+		if (chunks.empty() || chunks.back().size == CHUNK_SIZE) {
+			if (!chunks.empty()) {
+				previous = chunks.back().last;
+				hasPrevious = true;
+			}
+			chunks.push_back(Chunk{0, {}, {}, {0, 0xffff, 0, 0}, previous, hasPrevious});
+		}
+
+		Chunk &chunk = chunks.back();
+		const uint32_t n = std::min<uint64_t>(CHUNK_SIZE - chunk.size, count);
+		encode(chunk, data, n);
+
+		data += n;
+		count -= n;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	auto it = chunks.begin();
+	if (extendsTail && it != chunks.end()) {
+		m_size += it->size - m_chunks.back().size;
+		m_chunks.back() = std::move(*it);
+		++it;
+	}
+
+	for (; it != chunks.end(); ++it) {
+		m_size += it->size;
+		m_chunks.push_back(std::move(*it));
+	}
+}
+
+void CaptureStore::assign(const uint16_t *data, uint64_t count)
+{
+	clear();
+	append(data, count);
+}
+
+uint64_t CaptureStore::size() const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	return m_size;
+}
+
+uint64_t CaptureStore::memoryUsage() const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	uint64_t bytes = 0;
+	for (const Chunk &chunk : m_chunks) {
+		bytes += chunk.runs.capacity() * sizeof(Run) +
+				chunk.raw.capacity() * sizeof(uint16_t);
+	}
+
+	return bytes;
+}
+
+bool CaptureStore::runAt(uint64_t sample, uint64_t &runEnd, uint16_t &value) const
+{
+	if (sample >= m_size) {
+		return false;
+	}
+
+	const uint64_t chunkStart = sample - sample % CHUNK_SIZE;
+	const Chunk &chunk = m_chunks[sample / CHUNK_SIZE];
+	const uint32_t offset = sample % CHUNK_SIZE;
+
+	if (!chunk.raw.empty()) {
+		value = chunk.raw[offset];
+		uint32_t end = offset + 1;
+		while (end < chunk.size && chunk.raw[end] == value) {
+			end++;
+		}
+		runEnd = chunkStart + end;
+	} else {
+		auto next = std::upper_bound(chunk.runs.begin(), chunk.runs.end(), offset,
+					     [](uint32_t off, const Run &run) {
+			return off < run.offset;
+		});
+		value = std::prev(next)->value;
+		runEnd = chunkStart + (next != chunk.runs.end() ? next->offset : chunk.size);
+	}
+
+	return true;
+}
+
+uint16_t CaptureStore::sampleAt(uint64_t sample) const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	uint64_t runEnd = 0;
+	uint16_t value = 0;
+	runAt(sample, runEnd, value);
+
+	return value;
+}
+
+uint64_t CaptureStore::read(uint64_t from, uint64_t count, uint16_t *dest) const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (from >= m_size) {
+		return 0;
+	}
+
+	count = std::min(count, m_size - from);
+
+	uint64_t done = 0;
+	while (done < count) {
+		const uint64_t sample = from + done;
+		const Chunk &chunk = m_chunks[sample / CHUNK_SIZE];
+		const uint32_t offset = sample % CHUNK_SIZE;
+		const uint32_t n = std::min<uint64_t>(chunk.size - offset, count - done);
+
+		if (!chunk.raw.empty()) {
+			memcpy(dest + done, chunk.raw.data() + offset, n * sizeof(uint16_t));
+		} else {
+			auto run = std::prev(std::upper_bound(chunk.runs.begin(), chunk.runs.end(), offset,
+							      [](uint32_t off, const Run &r) {
+				return off < r.offset;
+			}));
+
+			uint32_t pos = offset;
+			while (pos < offset + n) {
+				auto next = std::next(run);
+				const uint32_t end = std::min<uint32_t>(
+							next != chunk.runs.end() ? next->offset : chunk.size,
+							offset + n);
+				std::fill(dest + done + (pos - offset), dest + done + (end - offset),
+					  run->value);
+				pos = end;
+				run = next;
+			}
+		}
+
+		done += n;
+	}
+
+	return count;
+}
+
+uint64_t CaptureStore::blockSize()
+{
+	return CHUNK_SIZE;
+}
+
+uint64_t CaptureStore::blockCount() const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	return m_chunks.size();
+}
+
+CaptureStore::BlockSummary CaptureStore::blockSummary(uint64_t block) const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (block >= m_chunks.size()) {
+		return BlockSummary{0, 0, 0, 0};
+	}
+
+	return m_chunks[block].summary;
+}
+
+CaptureStore::Cursor::Cursor(const CaptureStore *store, uint64_t sample)
+	: m_store(store)
+	, m_position(0)
+	, m_runEnd(0)
+	, m_value(0)
+{
+	seek(sample);
+}
+
+void CaptureStore::Cursor::seek(uint64_t sample)
+{
+	std::unique_lock<std::mutex> lock(m_store->m_mutex);
+
+	m_position = sample;
+	if (!m_store->runAt(sample, m_runEnd, m_value)) {
+		m_position = m_store->m_size;
+		m_runEnd = m_position;
+	}
+}
+
+bool CaptureStore::Cursor::next()
+{
+	if (atEnd()) {
+		return false;
+	}
+
+	seek(m_runEnd);
+
+	return !atEnd();
+}
+
+bool CaptureStore::Cursor::atEnd() const
+{
+	return m_position == m_runEnd;
+}
+
+uint64_t CaptureStore::Cursor::position() const
+{
+	return m_position;
+}
+
+uint64_t CaptureStore::Cursor::runEnd() const
+{
+	return m_runEnd;
+}
+
+uint16_t CaptureStore::Cursor::value() const
+{
+	return m_value;
+}
+
+uint64_t CaptureStore::Cursor::read(uint16_t *dest, uint64_t count)
+{
+	const uint64_t n = m_store->read(m_position, count, dest);
+	seek(m_position + n);
+
+	return n;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTURESTORE_H
+#define CAPTURESTORE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace adiscope {
+namespace logic {
+
+/*
+ * Sample store for digital captures. Samples are kept in fixed size chunks,
+ * each one holding either the value transitions (runs of identical samples)
+ * or, when the signal toggles too often for that to pay off, the raw samples.
+ * A single writer may append while other threads read.
+ */
+class CaptureStore
+{
+public:
+	/* Walks the capture one run of identical samples at a time */
+	class Cursor
+	{
+	public:
+		explicit Cursor(const CaptureStore *store, uint64_t sample = 0);
+
+		void seek(uint64_t sample);
+		bool next();
+		bool atEnd() const;
+
+		uint64_t position() const;
+		uint64_t runEnd() const;
+		uint16_t value() const;
+
+		uint64_t read(uint16_t *dest, uint64_t count);
+
+	private:
+		const CaptureStore *m_store;
+		uint64_t m_position;
+		uint64_t m_runEnd;
+		uint16_t m_value;
+	};
+
+	/* Per chunk summary used to skip whole blocks when searching */
+	struct BlockSummary {
+		uint16_t orMask;
+		uint16_t andMask;
+		// bits changing inside the block or from the previous block
+		uint16_t toggleMask;
+		uint32_t transitions;
+	};
+
+	CaptureStore();
+
+	void clear();
+	void append(const uint16_t *data, uint64_t count);
+	void assign(const uint16_t *data, uint64_t count);
+
+	uint64_t size() const;
+	uint64_t memoryUsage() const;
+
+	uint16_t sampleAt(uint64_t sample) const;
+	uint64_t read(uint64_t from, uint64_t count, uint16_t *dest) const;
+
+	static uint64_t blockSize();
+	uint64_t blockCount() const;
+	BlockSummary blockSummary(uint64_t block) const;
+
+private:
+	struct Run {
+		uint16_t offset;
+		uint16_t value;
+	};
+
+	struct Chunk {
+		uint32_t size;
+		std::vector<Run> runs;
+		std::vector<uint16_t> raw;
+		BlockSummary summary;
+		// last sample, of the previous chunk while this one is empty
+		uint16_t last;
+		bool hasLast;
+	};
+
+	static void encode(Chunk &chunk, const uint16_t *data, uint32_t count);
+	bool runAt(uint64_t sample, uint64_t &runEnd, uint16_t &value) const;
+
+	mutable std::mutex m_mutex;
+	std::vector<Chunk> m_chunks;
+	uint64_t m_size;
+};
+
+} // namespace logic
+} // namespace adiscope
+
+#endif // CAPTURESTORE_H
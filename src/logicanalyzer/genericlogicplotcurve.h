@@ -62,14 +62,13 @@ public:
 	virtual void dataAvailable(uint64_t from, uint64_t to) {}
 	virtual void reset() {}
 
+	uint64_t fromTimeToSample(double time) const;
+	double fromSampleToTime(uint64_t sample) const;
+
 Q_SIGNALS:
 	void nameChanged(QString);
 	void pixelOffsetChanged(double);
 
-protected:
-	uint64_t fromTimeToSample(double time) const;
-	double fromSampleToTime(uint64_t sample) const;
-
 protected:
 	QString m_name;
 	QString m_id;
@@ -31,6 +31,11 @@
 #include "logicanalyzer/logicdatacurve.h"
 #include "logicanalyzer/annotationcurve.h"
 #include "logicanalyzer/decoder.h"
+#include "logicanalyzer/capturesearch.h"
+#include "logicanalyzer/captureimport.h"
+#include "measurement_gui.h"
+#include "statistic_widget.h"
+#include "symbol.h"
 
 #include "gui/basemenu.h"
 #include "logicgroupitem.h"
@@ -44,6 +49,10 @@
 #include <QDateTime>
 
 #include <QTabWidget>
+#include <QGridLayout>
+#include <QPushButton>
+
+#include <limits>
 
 #include "filter.hpp"
 
@@ -64,6 +73,12 @@ constexpr int MAX_SR_STREAM = 5e6; // 10M
 constexpr int MAX_KERNEL_BUFFERS = 64;
 constexpr int DIGITAL_NR_CHANNELS = 16;
 
+enum SearchType {
+	SEARCH_PATTERN,
+	SEARCH_PULSE,
+	SEARCH_ANNOTATION,
+};
+
 /* helper method to sort srd_decoder objects based on ids(name) */
 static gint sort_pds(gconstpointer a, gconstpointer b)
 {
@@ -124,6 +139,20 @@ LogicAnalyzer::LogicAnalyzer(struct iio_context *ctx, adiscope::Filter *filt,
 	m_timer(new QTimer(this)),
 	m_timerTimeout(1000),
 	m_exportSettings(nullptr),
+	m_searchType(nullptr),
+	m_searchChannel(nullptr),
+	m_searchText(nullptr),
+	m_searchResult(nullptr),
+	m_importResult(nullptr),
+	m_measure(DIGITAL_NR_CHANNELS),
+	m_measureStart(0),
+	m_measureEnd(std::numeric_limits<uint64_t>::max()),
+	m_measureReset(true),
+	m_measureGuiPending(false),
+	m_measureWidget(nullptr),
+	m_measureGate(nullptr),
+	m_measureStatistics(nullptr),
+	m_statisticsWidget(nullptr),
 	m_saveRestoreSettings(nullptr),
 	m_oscPlot(nullptr),
 	m_oscChannelSelected(-1),
@@ -295,14 +324,7 @@ void LogicAnalyzer::setData(const uint16_t * const data, int size)
 
 	qDebug() << "Set data arrived: ";
 
-	if (m_buffer) {
-		delete m_buffer;
-		m_buffer = nullptr;
-	}
-
-	m_buffer = new uint16_t[size];
-
-	memcpy(m_buffer, data, size * sizeof(uint16_t));
+	m_captureStore.assign(data, size);
 	Q_EMIT dataAvailable(0, size);
 
 //	if (m_oscPlot) {
@@ -1215,6 +1237,10 @@ void LogicAnalyzer::channelSelectedChanged(int chIdx, bool selected)
 
 		updateChannelGroupWidget(true);
 
+		m_measureWidget->setVisible(m_selectedChannel < m_nbChannels);
+		resetStatistics();
+		updateMeasurementsGui(false);
+
 		if (m_selectedChannel < m_nbChannels) {
 			ui->triggerComboBox->setVisible(true);
 			ui->labelTrigger->setVisible(true);
@@ -1246,6 +1272,7 @@ void LogicAnalyzer::channelSelectedChanged(int chIdx, bool selected)
 		}
 	} else if (m_selectedChannel == chIdx && !selected) {
 		m_selectedChannel = -1;
+		m_measureWidget->setVisible(false);
 		ui->hardwareName->setText("");
 		ui->nameLineEdit->setDisabled(true);
 		ui->nameLineEdit->setText("");
@@ -1403,6 +1430,9 @@ void LogicAnalyzer::setupUi()
 	ui->groupWidget->setVisible(false);
 	ui->stackDecoderWidget->setVisible(false);
 
+	setupSearch();
+	setupMeasurements();
+
 	// Export Settings
 	m_exportSettings = new ExportSettings(this);
 	m_exportSettings->enableExportButton(false);
@@ -1413,6 +1443,345 @@ void LogicAnalyzer::setupUi()
 	m_exportSettings->disableUIMargins();
 	connect(m_exportSettings->getExportButton(), &QPushButton::clicked,
 		this, &LogicAnalyzer::exportData);
+
+	// Import of a capture saved to disk
+	QWidget *importWidget = new QWidget(this);
+	QVBoxLayout *importLayout = new QVBoxLayout(importWidget);
+	importLayout->setContentsMargins(0, 10, 0, 10);
+	QPushButton *importBtn = new QPushButton(tr("Import"), importWidget);
+	importBtn->setProperty("blue_button", true);
+	importBtn->setMinimumHeight(30);
+	m_importResult = new QLabel(importWidget);
+	importLayout->addWidget(importBtn);
+	importLayout->addWidget(m_importResult);
+	ui->exportLayout->addWidget(importWidget);
+	connect(importBtn, &QPushButton::clicked, this, &LogicAnalyzer::importData);
+}
+
+void LogicAnalyzer::setupSearch()
+{
+	QWidget *searchWidget = new QWidget(this);
+	QGridLayout *layout = new QGridLayout(searchWidget);
+	layout->setContentsMargins(0, 10, 0, 10);
+
+	QLabel *label = new QLabel(tr("SEARCH"), searchWidget);
+	label->setProperty("subsection_label", true);
+	layout->addWidget(label, 0, 0, 1, 2);
+
+	m_searchType = new QComboBox(searchWidget);
+	m_searchType->addItem(tr("Pattern"));
+	m_searchType->addItem(tr("Pulse narrower than"));
+	m_searchType->addItem(tr("Annotation"));
+	layout->addWidget(m_searchType, 1, 0);
+
+	m_searchChannel = new QComboBox(searchWidget);
+	for (int i = 0; i < DIGITAL_NR_CHANNELS; ++i) {
+		m_searchChannel->addItem("DIO" + QString::number(i));
+	}
+	layout->addWidget(m_searchChannel, 1, 1);
+
+	m_searchText = new QLineEdit(searchWidget);
+	layout->addWidget(m_searchText, 2, 0, 1, 2);
+
+	QPushButton *previousBtn = new QPushButton(tr("Previous"), searchWidget);
+	QPushButton *nextBtn = new QPushButton(tr("Next"), searchWidget);
+	previousBtn->setProperty("blue_button", true);
+	nextBtn->setProperty("blue_button", true);
+	layout->addWidget(previousBtn, 3, 0);
+	layout->addWidget(nextBtn, 3, 1);
+
+	m_searchResult = new QLabel(searchWidget);
+	layout->addWidget(m_searchResult, 4, 0, 1, 2);
+
+	auto updatePlaceholder = [=](int type) {
+		m_searchChannel->setEnabled(type == SEARCH_PULSE);
+		if (type == SEARCH_PATTERN) {
+			m_searchText->setPlaceholderText(tr("e.g. 1X01, last digit is DIO0"));
+		} else if (type == SEARCH_PULSE) {
+			m_searchText->setPlaceholderText(tr("Width in samples"));
+		} else {
+			m_searchText->setPlaceholderText(tr("Decoded value"));
+		}
+		m_searchResult->clear();
+	};
+	updatePlaceholder(SEARCH_PATTERN);
+
+	connect(m_searchType, QOverload<int>::of(&QComboBox::currentIndexChanged),
+		updatePlaceholder);
+	connect(previousBtn, &QPushButton::clicked, [=](){ search(false); });
+	connect(nextBtn, &QPushButton::clicked, [=](){ search(true); });
+	connect(m_searchText, &QLineEdit::returnPressed, [=](){ search(true); });
+
+	ui->exportLayout->addWidget(searchWidget);
+}
+
+void LogicAnalyzer::search(bool forward)
+{
+	if (!m_captureStore.size() || m_plotCurves.isEmpty()) {
+		m_searchResult->setText(tr("Nothing captured"));
+		return;
+	}
+
+	/* Search from the sample in the middle of the plot */
+	GenericLogicPlotCurve *timeCurve = m_plotCurves.first();
+	const uint64_t from = timeCurve->fromTimeToSample(m_plot.HorizOffset());
+	const QString query = m_searchText->text();
+	int64_t found = -1;
+
+	if (m_searchType->currentIndex() == SEARCH_PATTERN) {
+		uint16_t mask = 0;
+		uint16_t value = 0;
+		if (!CaptureSearch::parsePattern(query, mask, value)) {
+			m_searchResult->setText(tr("Invalid pattern"));
+			return;
+		}
+		found = CaptureSearch(&m_captureStore).findPattern(from, mask, value, forward);
+	} else if (m_searchType->currentIndex() == SEARCH_PULSE) {
+		bool ok = false;
+		const qulonglong width = query.toULongLong(&ok);
+		if (!ok || !width) {
+			m_searchResult->setText(tr("Invalid width"));
+			return;
+		}
+		found = CaptureSearch(&m_captureStore).findPulse(from, m_searchChannel->currentIndex(),
+								  width, forward);
+	} else {
+		for (GenericLogicPlotCurve *curve : qAsConst(m_plotCurves)) {
+			AnnotationCurve *annotationCurve = dynamic_cast<AnnotationCurve *>(curve);
+			if (!annotationCurve) {
+				continue;
+			}
+
+			const int64_t start = annotationCurve->findAnnotation(query, from, forward);
+			if (start >= 0 && (found < 0 || (forward ? start < found : start > found))) {
+				found = start;
+			}
+		}
+	}
+
+	if (found < 0) {
+		m_searchResult->setText(tr("No match"));
+		return;
+	}
+
+	m_horizOffset = timeCurve->fromSampleToTime(found);
+	m_plot.setHorizOffset(m_horizOffset);
+	m_plot.replot();
+	updateBufferPreviewer(0, m_lastCapturedSample);
+
+	m_searchResult->setText(tr("Found at sample %1").arg(found));
+}
+
+void LogicAnalyzer::setupMeasurements()
+{
+	m_measureWidget = new QWidget(this);
+	QGridLayout *layout = new QGridLayout(m_measureWidget);
+	layout->setContentsMargins(0, 20, 0, 0);
+
+	QLabel *label = new QLabel(tr("MEASUREMENTS"), m_measureWidget);
+	label->setProperty("subsection_label", true);
+	layout->addWidget(label, 0, 0, 1, 2);
+
+	int row = 1;
+	const QList<std::shared_ptr<MeasurementData>> measurements = m_measure.measurements(0);
+	for (const std::shared_ptr<MeasurementData> &data : measurements) {
+		std::shared_ptr<MeasurementGui> gui;
+		switch (data->unitType()) {
+		case MeasurementData::TIME:
+			gui = std::make_shared<TimeMeasurementGui>();
+			break;
+		case MeasurementData::PERCENTAGE:
+			gui = std::make_shared<PercentageMeasurementGui>();
+			break;
+		case MeasurementData::DIMENSIONLESS:
+			gui = std::make_shared<DimensionlessMeasurementGui>();
+			break;
+		default:
+			gui = std::make_shared<MetricMeasurementGui>();
+			break;
+		}
+
+		QLabel *name = new QLabel(m_measureWidget);
+		QLabel *value = new QLabel(m_measureWidget);
+		gui->init(name, value);
+		gui->update(*data, 1);
+		layout->addWidget(name, row, 0);
+		layout->addWidget(value, row, 1);
+		m_measureGuis.push_back(gui);
+		row++;
+	}
+
+	QComboBox *reference = new QComboBox(m_measureWidget);
+	for (int i = 0; i < DIGITAL_NR_CHANNELS; ++i) {
+		reference->addItem("DIO" + QString::number(i));
+	}
+	layout->addWidget(new QLabel(tr("Skew reference"), m_measureWidget), row, 0);
+	layout->addWidget(reference, row++, 1);
+
+	m_measureGate = new CustomSwitch(m_measureWidget);
+	layout->addWidget(new QLabel(tr("Gate with cursors"), m_measureWidget), row, 0);
+	layout->addWidget(m_measureGate, row++, 1);
+
+	m_measureStatistics = new CustomSwitch(m_measureWidget);
+	layout->addWidget(new QLabel(tr("Statistics"), m_measureWidget), row, 0);
+	layout->addWidget(m_measureStatistics, row++, 1);
+
+	QFile file(":stylesheets/stylesheets/customSwitch.qss");
+	file.open(QFile::ReadOnly);
+	const QString styleSheet = QString::fromLatin1(file.readAll());
+	m_measureGate->setStyleSheet(styleSheet);
+	m_measureStatistics->setStyleSheet(styleSheet);
+
+	/* Average, min and max of each measurement over the captured buffers */
+	m_statisticsWidget = new QWidget(m_measureWidget);
+	QVBoxLayout *statisticsLayout = new QVBoxLayout(m_statisticsWidget);
+	statisticsLayout->setContentsMargins(0, 0, 0, 0);
+	for (const std::shared_ptr<MeasurementData> &data : measurements) {
+		StatisticWidget *statistic = new StatisticWidget(m_statisticsWidget);
+		statistic->initForMeasurement(*data);
+		statisticsLayout->addWidget(statistic);
+		m_statisticWidgets.push_back(statistic);
+	}
+	m_statistics.resize(measurements.size());
+	m_statisticsWidget->setVisible(false);
+	layout->addWidget(m_statisticsWidget, row, 0, 1, 2);
+
+	// before the bottom spacers of the channel settings menu
+	ui->verticalLayout_9->insertWidget(ui->verticalLayout_9->count() - 2, m_measureWidget);
+	m_measureWidget->setVisible(false);
+
+	// measure each buffer in the capture thread, only once
+	connect(this, &LogicAnalyzer::dataAvailable, this, [=](uint64_t from, uint64_t to){
+		if (m_oscPlot) {
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_measureMutex);
+			if (!from) {
+				m_measureReset = true;
+			}
+			advanceMeasurement(to);
+		}
+
+		const bool complete = to >= m_bufferSize;
+		if (!m_measureGuiPending.exchange(true) || complete) {
+			QMetaObject::invokeMethod(this, [=](){
+				m_measureGuiPending = false;
+				updateMeasurementsGui(complete);
+			}, Qt::QueuedConnection);
+		}
+	}, Qt::DirectConnection);
+
+	connect(reference, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int index){
+		{
+			std::unique_lock<std::mutex> lock(m_measureMutex);
+			m_measure.setReferenceChannel(index);
+			m_measure.measure();
+		}
+		updateMeasurementsGui(false);
+	});
+
+	connect(m_measureGate, &CustomSwitch::toggled, [=](){
+		resetStatistics();
+		remeasure();
+	});
+	connect(ui->cursorsBox, &QCheckBox::toggled, [=](){
+		if (m_measureGate->isChecked()) {
+			resetStatistics();
+			remeasure();
+		}
+	});
+	for (VertBar *bar : {m_plot.vBar1(), m_plot.vBar2()}) {
+		connect(bar, static_cast<void (HorizDebugSymbol::*)(double)>(&HorizDebugSymbol::positionChanged),
+			[=](){
+			if (m_measureGate->isChecked() && ui->cursorsBox->isChecked()) {
+				remeasure();
+			}
+		});
+	}
+
+	connect(m_measureStatistics, &CustomSwitch::toggled, [=](bool on){
+		resetStatistics();
+		m_statisticsWidget->setVisible(on);
+	});
+}
+
+void LogicAnalyzer::advanceMeasurement(uint64_t available)
+{
+	/* Called with m_measureMutex held */
+	if (m_measureReset) {
+		if (available <= m_measureStart) {
+			return;
+		}
+		m_measure.reset(m_measureStart, m_captureStore.sampleAt(m_measureStart));
+		m_measureReset = false;
+	}
+
+	m_measure.setSampleRate(m_sampleRate);
+	m_measure.advance(&m_captureStore, std::min(available, m_measureEnd));
+	m_measure.measure();
+}
+
+void LogicAnalyzer::remeasure()
+{
+	uint64_t start = 0;
+	uint64_t end = std::numeric_limits<uint64_t>::max();
+
+	if (m_measureGate->isChecked() && ui->cursorsBox->isChecked()) {
+		const uint64_t s1 = m_plotCurves.first()->fromTimeToSample(m_plot.vBar1()->plotCoord().x());
+		const uint64_t s2 = m_plotCurves.first()->fromTimeToSample(m_plot.vBar2()->plotCoord().x());
+		start = std::min(s1, s2);
+		end = std::max(s1, s2);
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_measureMutex);
+		m_measureStart = start;
+		m_measureEnd = end;
+		m_measureReset = true;
+		advanceMeasurement(m_lastCapturedSample);
+	}
+
+	updateMeasurementsGui(false);
+}
+
+void LogicAnalyzer::updateMeasurementsGui(bool pushStatistics)
+{
+	if (m_selectedChannel < 0 || m_selectedChannel >= m_nbChannels) {
+		return;
+	}
+
+	std::vector<MeasurementData> values;
+	{
+		std::unique_lock<std::mutex> lock(m_measureMutex);
+		for (const std::shared_ptr<MeasurementData> &data : m_measure.measurements(m_selectedChannel)) {
+			values.push_back(*data);
+		}
+	}
+
+	for (int i = 0; i < m_measureGuis.size(); ++i) {
+		m_measureGuis[i]->update(values[i], 1);
+	}
+
+	if (!m_measureStatistics->isChecked()) {
+		return;
+	}
+
+	for (int i = 0; i < m_statistics.size(); ++i) {
+		if (pushStatistics && values[i].measured()) {
+			m_statistics[i].pushNewData(values[i].value());
+		}
+		m_statisticWidgets[i]->updateStatistics(m_statistics[i]);
+	}
+}
+
+void LogicAnalyzer::resetStatistics()
+{
+	for (int i = 0; i < m_statistics.size(); ++i) {
+		m_statistics[i].clear();
+		m_statisticWidgets[i]->updateStatistics(m_statistics[i]);
+	}
 }
 
 void LogicAnalyzer::connectSignalsAndSlots()
@@ -1766,12 +2135,7 @@ void LogicAnalyzer::startStop(bool start)
 
 		m_captureThread = new std::thread([=](){
 
-			if (m_buffer) {
-				delete[] m_buffer;
-				m_buffer = nullptr;
-			}
-
-			m_buffer = new uint16_t[bufferSizeAdjusted];
+			m_captureStore.clear();
 			QMetaObject::invokeMethod(this, [=](){
 				m_exportSettings->enableExportButton(true);
 			}, Qt::DirectConnection);
@@ -1885,7 +2249,11 @@ void LogicAnalyzer::startStop(bool start)
 					}
 
 					const uint16_t * const temp = m_m2kDigital->getSamplesP(chunk_size);
-					memcpy(m_buffer + absIndex, temp, sizeof(uint16_t) * captureSize);
+					// a new run of the capture replaces the stored one
+					if (!absIndex) {
+						m_captureStore.clear();
+					}
+					m_captureStore.append(temp, captureSize);
 
 					absIndex += captureSize;
 					totalSamples -= captureSize;
@@ -2535,6 +2903,85 @@ void LogicAnalyzer::exportData()
 	}
 }
 
+void LogicAnalyzer::importData()
+{
+	QStringList filter;
+	filter += QString(tr("Value Change Dump(*.vcd)"));
+	filter += QString(tr("Comma-separated values files (*.csv)"));
+	filter += QString(tr("Tab-delimited values files (*.txt)"));
+	filter += QString(tr("Raw 16 bit samples (*.bin *.raw)"));
+	filter += QString(tr("All Files(*)"));
+
+	const QString fileName = QFileDialog::getOpenFileName(this,
+	    tr("Import"), "", filter.join(";;"), nullptr,
+	    (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
+
+	if (fileName.isEmpty()) {
+		return;
+	}
+
+	importCapture(fileName);
+}
+
+bool LogicAnalyzer::importCapture(const QString &fileName)
+{
+	if (m_started) {
+		auto btn = dynamic_cast<CustomPushButton *>(run_button);
+		if (btn) {
+			btn->setChecked(false);
+		}
+	}
+
+	CaptureImport importer(m_sampleRate);
+	if (!importer.load(fileName, &m_captureStore)) {
+		m_importResult->setText(importer.errorString());
+		m_lastCapturedSample = 0;
+		for (GenericLogicPlotCurve *curve : qAsConst(m_plotCurves)) {
+			curve->reset();
+		}
+		m_plot.replot();
+		return false;
+	}
+
+	const uint64_t size = m_captureStore.size();
+	const double sampleRate = importer.sampleRate();
+
+	/* The imported capture might not fit the hardware limits of the
+	 * spin buttons, use the values as they are */
+	{
+		QSignalBlocker sampleRateBlocker(m_sampleRateButton);
+		QSignalBlocker bufferSizeBlocker(m_bufferSizeButton);
+		m_sampleRateButton->setValue(sampleRate);
+		m_bufferSizeButton->setValue(size);
+	}
+	onSampleRateValueChanged(sampleRate);
+	onBufferSizeChanged(size);
+
+	m_plot.setSampleRatelabelValue(m_sampleRate);
+	m_plot.setBufferSizeLabelValue(m_bufferSize);
+	m_plot.setTimeBaseLabelValue(m_bufferSize / m_sampleRate / m_plot.xAxisNumDiv());
+
+	const double delay = ui->btnStreamOneShot->isChecked() ? m_timeTriggerOffset * m_sampleRate
+							      : 0;
+	for (GenericLogicPlotCurve *curve : qAsConst(m_plotCurves)) {
+		curve->reset();
+		curve->setSampleRate(m_sampleRate);
+		curve->setBufferSize(m_bufferSize);
+		curve->setTimeTriggerOffset(delay);
+	}
+
+	m_lastCapturedSample = size;
+	Q_EMIT dataAvailable(0, size);
+
+	m_exportSettings->enableExportButton(true);
+	m_plot.replot();
+	updateBufferPreviewer(0, m_lastCapturedSample);
+
+	m_importResult->setText(tr("Imported %1 samples").arg(size));
+
+	return true;
+}
+
 bool LogicAnalyzer::exportTabCsv(const QString &separator, const QString &fileName)
 {
 	FileManager fm("Logic Analyzer");
@@ -2549,11 +2996,12 @@ bool LogicAnalyzer::exportTabCsv(const QString &separator, const QString &fileNa
 
 	QVector<QVector<double>> data;
 
-	if (!m_buffer) {
+	if (!m_captureStore.size()) {
 		return false;
 	} else {
-		for (unsigned int i = 0; i < m_lastCapturedSample; ++i) {
-			uint64_t sample = m_buffer[i];
+		CaptureStore::Cursor cursor(&m_captureStore);
+		for (; !cursor.atEnd() && cursor.position() < m_lastCapturedSample; cursor.next()) {
+			const uint64_t sample = cursor.value();
 			QVector<double> line;
 			for (unsigned int ch = 0; ch < DIGITAL_NR_CHANNELS; ++ch) {
 				int bit = (sample >> ch) & 1;
@@ -2561,7 +3009,11 @@ bool LogicAnalyzer::exportTabCsv(const QString &separator, const QString &fileNa
 					line.push_back(bit);
 				}
 			}
-			data.push_back(line);
+
+			const uint64_t end = std::min<uint64_t>(cursor.runEnd(), m_lastCapturedSample);
+			for (uint64_t i = cursor.position(); i < end; ++i) {
+				data.push_back(line);
+			}
 		}
 	}
 
@@ -2623,15 +3075,13 @@ bool LogicAnalyzer::exportVcd(const QString &fileName, const QString &startSep,
 	out << startSep << "upscope" << endSep;
 	out << startSep << "enddefinitions" << endSep;
 
-	/* Write the values */
-	if (m_buffer) {
-		for (uint64_t i = 0; i < m_lastCapturedSample; i++) {
-			current_sample = m_buffer[i];
-			if (i == 0) {
-				prev_sample = current_sample;
-			} else {
-				prev_sample = m_buffer[i - 1];
-			}
+	/* Write the values, only the start of each run can hold a change */
+	if (m_captureStore.size()) {
+		CaptureStore::Cursor cursor(&m_captureStore);
+		prev_sample = cursor.value();
+		for (; !cursor.atEnd() && cursor.position() < m_lastCapturedSample; cursor.next()) {
+			const uint64_t i = cursor.position();
+			current_sample = cursor.value();
 			timestamp_written = false;
 			p = 0;
 			for (unsigned int ch = 0; ch < DIGITAL_NR_CHANNELS; ch++) {
@@ -2656,6 +3106,7 @@ bool LogicAnalyzer::exportVcd(const QString &fileName, const QString &startSep,
 			if (timestamp_written) {
 				out << "\n";
 			}
+			prev_sample = current_sample;
 		}
 	} else {
 		file.close();
@@ -30,6 +30,9 @@
 #include <QQueue>
 #include <QScrollBar>
 #include <QTimer>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QLabel>
 
 #include "logic_tool.h"
 #include "oscilloscope_plot.hpp"
@@ -39,6 +42,7 @@
 #include "saverestoretoolsettings.h"
 
 #include "genericlogicplotcurve.h"
+#include "logicmeasure.h"
 
 #include <libm2k/m2k.hpp>
 #include <libm2k/contextbuilder.hpp>
@@ -62,6 +66,9 @@ class BaseMenu;
 class LogicAnalyzer_API;
 class ExportSettings;
 class StateUpdater;
+class MeasurementGui;
+class StatisticWidget;
+class CustomSwitch;
 
 namespace logic {
 
@@ -126,6 +133,8 @@ private Q_SLOTS:
 	void readPreferences();
 
 	void exportData();
+	void importData();
+	bool importCapture(const QString &fileName);
 	bool exportTabCsv(const QString &separator, const QString &fileName);
 	bool exportVcd(const QString &fileName, const QString &startSep, const QString &endSep);
 
@@ -146,6 +155,15 @@ private:
 
 	void setupTriggerMenu();
 
+	void setupSearch();
+	void search(bool forward);
+
+	void setupMeasurements();
+	void advanceMeasurement(uint64_t available);
+	void remeasure();
+	void updateMeasurementsGui(bool pushStatistics);
+	void resetStatistics();
+
 private:
 	// TODO: consisten naming (m_ui, m_crUi)
 	Ui::LogicAnalyzer *ui;
@@ -203,6 +221,27 @@ private:
 	ExportSettings *m_exportSettings;
 	QMap<int, bool> m_exportConfig;
 
+	QComboBox *m_searchType;
+	QComboBox *m_searchChannel;
+	QLineEdit *m_searchText;
+	QLabel *m_searchResult;
+	QLabel *m_importResult;
+
+	// measurements of the selected channel
+	LogicMeasure m_measure;
+	std::mutex m_measureMutex;
+	uint64_t m_measureStart;
+	uint64_t m_measureEnd;
+	bool m_measureReset;
+	std::atomic<bool> m_measureGuiPending;
+	QWidget *m_measureWidget;
+	CustomSwitch *m_measureGate;
+	CustomSwitch *m_measureStatistics;
+	QWidget *m_statisticsWidget;
+	QVector<std::shared_ptr<MeasurementGui>> m_measureGuis;
+	QVector<StatisticWidget *> m_statisticWidgets;
+	QVector<Statistic> m_statistics;
+
 	/* mixed signal view */
 	std::unique_ptr<SaveRestoreToolSettings> m_saveRestoreSettings;
 	CapturePlot *m_oscPlot;
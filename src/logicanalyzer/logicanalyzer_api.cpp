@@ -27,6 +27,7 @@
 #include "ui_cursors_settings.h"
 
 #include <QCheckBox>
+#include <algorithm>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -410,6 +411,22 @@ void LogicAnalyzer_API::setNotes(QString str)
 	m_logic->ui->instrumentNotes->setNotes(str);
 }
 
+QByteArray LogicAnalyzer_API::getDataBuffer() const
+{
+	const CaptureStore *store = m_logic->getCaptureStore();
+	const uint64_t size = std::min<uint64_t>(m_logic->m_lastCapturedSample, store->size());
+
+	QByteArray buffer(size * sizeof(uint16_t), Qt::Uninitialized);
+	store->read(0, size, reinterpret_cast<uint16_t *>(buffer.data()));
+
+	return buffer;
+}
+
+bool LogicAnalyzer_API::importCapture(const QString &fileName)
+{
+	return m_logic->importCapture(fileName);
+}
+
 bool LogicAnalyzer_API::hasCursors() const
 {
 	return m_logic->ui->cursorsBox->isChecked();
@@ -65,6 +65,9 @@ class LogicAnalyzer_API : public ApiObject
 	/* notes */
 	Q_PROPERTY(QString notes READ getNotes WRITE setNotes)
 
+	/* captured samples, 16 bit each, for an Uint16Array view */
+	Q_PROPERTY(QByteArray data_buffer READ getDataBuffer STORED false)
+
 public:
 	explicit LogicAnalyzer_API(logic::LogicAnalyzer *logic):
 	ApiObject(), m_logic(logic) {
@@ -129,6 +132,10 @@ public:
 	QString getNotes();
 	void setNotes(QString str);
 
+	QByteArray getDataBuffer() const;
+
+	Q_INVOKABLE bool importCapture(const QString &fileName);
+
 private:
 	logic::LogicAnalyzer *m_logic;
 
@@ -64,8 +64,6 @@ void LogicDataCurve::dataAvailable(uint64_t from, uint64_t to)
 	    reset();
     }
 
-    m_data = m_logic->getData();
-
     // Take into account the last pushed edge from the previous chunk of
     // available data
     uint64_t currentSample = from;
@@ -77,11 +75,14 @@ void LogicDataCurve::dataAvailable(uint64_t from, uint64_t to)
 	    return;
     }
 
-    for (; currentSample < to - 1; ++currentSample) {
-        bool transition = (m_data[currentSample] & (1 << m_bit)) ^ (m_data[currentSample + 1] & (1 << m_bit));
-        bool high = (m_data[currentSample] & (1 << m_bit)) > (m_data[currentSample + 1] & (1 << m_bit));
-        if (transition) {
-            m_edges.emplace_back(currentSample, high);
+    // Only run boundaries in the capture store can hold an edge
+    adiscope::logic::CaptureStore::Cursor cursor(m_logic->getCaptureStore(), currentSample);
+    bool previous = cursor.value() & (1 << m_bit);
+    while (cursor.next() && cursor.position() < to) {
+        const bool current = cursor.value() & (1 << m_bit);
+        if (current != previous) {
+            m_edges.emplace_back(cursor.position() - 1, previous);
+            previous = current;
         }
     }
 
@@ -121,7 +122,7 @@ void LogicDataCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap,
 
     if (!m_edges.size()) {
 	    if (m_startSample != m_endSample) {
-		const bool logicLevel = (m_logic->getData()[m_startSample] & (1 << m_bit)) >> m_bit;
+		const bool logicLevel = (m_logic->getCaptureStore()->sampleAt(m_startSample) & (1 << m_bit)) >> m_bit;
 		displayedData += QPointF(fromSampleToTime(m_startSample), logicLevel * heightInPoints + m_pixelOffset);
 		displayedData += QPointF(fromSampleToTime(m_endSample), logicLevel * heightInPoints + m_pixelOffset);
 
@@ -197,10 +198,17 @@ void LogicDataCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap,
     start = start < 0 ? 0 : start;
     end = end > (m_endSample - 1) ? (m_endSample - 1) : end;
 
+    if (end < start) {
+	return;
+    }
+
+    std::vector<uint16_t> samples(end - start + 1);
+    m_logic->getCaptureStore()->read(start, samples.size(), samples.data());
+
     QVector<QPointF> points;
-    for (; start <= end; ++start) {
-	double y = ((m_logic->getData()[start] & (1 << m_bit)) >> m_bit) * heightInPoints + m_pixelOffset;
-	points += QPointF(fromSampleToTime(start), y);
+    for (size_t i = 0; i < samples.size(); ++i) {
+	double y = ((samples[i] & (1 << m_bit)) >> m_bit) * heightInPoints + m_pixelOffset;
+	points += QPointF(fromSampleToTime(start + i), y);
     }
 
     QwtPointSeriesData *d2 = new QwtPointSeriesData(points);
@@ -55,8 +55,6 @@ private:
 
 	adiscope::logic::LogicTool *m_logic;
 
-    // pointer to data which this curve listens to
-    uint16_t *m_data;
     // bit to watch in each sample from m_data
     uint8_t m_bit;
 
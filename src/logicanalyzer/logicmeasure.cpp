@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logicmeasure.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <QObject>
+
+using namespace adiscope;
+using namespace adiscope::logic;
+
+LogicMeasure::LogicMeasure(int nbChannels)
+	: m_nbChannels(nbChannels)
+	, m_sampleRate(1.0)
+	, m_referenceChannel(0)
+	, m_position(0)
+	, m_last(0)
+	, m_timing(nbChannels)
+	, m_measurements(nbChannels)
+{
+	for (int ch = 0; ch < m_nbChannels; ++ch) {
+		QList<std::shared_ptr<MeasurementData>> &list = m_measurements[ch];
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("Frequency"),
+								 MeasurementData::HORIZONTAL, "Hz", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("Period"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("+Width"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("+Width Min"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("+Width Max"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("-Width"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("-Width Min"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("-Width Max"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("+Duty"),
+								 MeasurementData::HORIZONTAL, "%", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("Edges"),
+								 MeasurementData::HORIZONTAL, "", ch));
+		list.push_back(std::make_shared<MeasurementData>(QObject::tr("Skew"),
+								 MeasurementData::HORIZONTAL, "s", ch));
+
+		for (auto &data : list) {
+			data->setEnabled(true);
+		}
+	}
+
+	reset(0, 0);
+}
+
+void LogicMeasure::Width::push(uint64_t width)
+{
+	min = count ? std::min(min, width) : width;
+	max = count ? std::max(max, width) : width;
+	sum += width;
+	count++;
+}
+
+double LogicMeasure::Width::mean() const
+{
+	return count ? static_cast<double>(sum) / count : 0.0;
+}
+
+double LogicMeasure::sampleRate() const
+{
+	return m_sampleRate;
+}
+
+void LogicMeasure::setSampleRate(double sampleRate)
+{
+	m_sampleRate = sampleRate;
+}
+
+int LogicMeasure::referenceChannel() const
+{
+	return m_referenceChannel;
+}
+
+void LogicMeasure::setReferenceChannel(int channel)
+{
+	m_referenceChannel = channel;
+}
+
+void LogicMeasure::reset(uint64_t start, uint16_t initial)
+{
+	m_position = start;
+	m_last = initial;
+
+	for (ChannelTiming &timing : m_timing) {
+		timing = ChannelTiming{-1, -1, -1, 0, {}, {}, {}};
+	}
+}
+
+uint64_t LogicMeasure::position() const
+{
+	return m_position;
+}
+
+void LogicMeasure::processEdges(uint64_t sample, uint16_t changed, uint16_t value)
+{
+	const int64_t s = static_cast<int64_t>(sample);
+
+	for (int ch = 0; changed && ch < m_nbChannels; ++ch, changed >>= 1) {
+		if (!(changed & 1)) {
+			continue;
+		}
+
+		ChannelTiming &timing = m_timing[ch];
+		timing.edges++;
+
+		if (value & (1 << ch)) {
+			if (timing.lastFall >= 0) {
+				timing.low.push(s - timing.lastFall);
+			}
+			if (timing.lastRise >= 0) {
+				timing.period.push(s - timing.lastRise);
+			} else {
+				timing.firstRise = s;
+			}
+			timing.lastRise = s;
+		} else {
+			if (timing.lastRise >= 0) {
+				timing.high.push(s - timing.lastRise);
+			}
+			timing.lastFall = s;
+		}
+	}
+}
+
+void LogicMeasure::process(const uint16_t *samples, uint64_t count)
+{
+	/* Compare four samples at a time against the last value, the signals
+	 * are idle most of the time so only a few samples are looked at one
+	 * by one */
+	uint64_t i = 0;
+	uint16_t last = m_last;
+
+	while (i < count) {
+		const uint64_t repeated = last * 0x0001000100010001ull;
+		while (i + 4 <= count) {
+			uint64_t word;
+			memcpy(&word, samples + i, sizeof(word));
+			if (word != repeated) {
+				break;
+			}
+			i += 4;
+		}
+
+		const uint64_t end = std::min(i + 4, count);
+		for (; i < end; ++i) {
+			const uint16_t changed = samples[i] ^ last;
+			if (changed) {
+				last = samples[i];
+				processEdges(m_position + i, changed, last);
+			}
+		}
+	}
+
+	m_last = last;
+	m_position += count;
+}
+
+void LogicMeasure::advance(const CaptureStore *store, uint64_t until)
+{
+	until = std::min(until, store->size());
+
+	const uint64_t blockSize = CaptureStore::blockSize();
+	while (m_position < until) {
+		const uint64_t block = m_position / blockSize;
+		const uint64_t end = std::min((block + 1) * blockSize, until);
+
+		/* Nothing changes inside this block, nor from the previous one */
+		if (store->blockSummary(block).toggleMask == 0) {
+			m_position = end;
+			continue;
+		}
+
+		m_block.resize(end - m_position);
+		const uint64_t count = store->read(m_position, m_block.size(), m_block.data());
+		if (!count) {
+			break;
+		}
+		process(m_block.data(), count);
+	}
+}
+
+void LogicMeasure::measure()
+{
+	const ChannelTiming &reference = m_timing[m_referenceChannel];
+
+	for (int ch = 0; ch < m_nbChannels; ++ch) {
+		const ChannelTiming &timing = m_timing[ch];
+		QList<std::shared_ptr<MeasurementData>> &list = m_measurements[ch];
+
+		auto set = [&](int id, bool measured, double value) {
+			list[id]->setMeasured(measured);
+			list[id]->setValue(measured ? value : 0);
+		};
+
+		const double period = timing.period.mean() / m_sampleRate;
+		set(FREQUENCY, timing.period.count, period ? 1.0 / period : 0);
+		set(PERIOD, timing.period.count, period);
+		set(P_WIDTH, timing.high.count, timing.high.mean() / m_sampleRate);
+		set(P_WIDTH_MIN, timing.high.count, timing.high.min / m_sampleRate);
+		set(P_WIDTH_MAX, timing.high.count, timing.high.max / m_sampleRate);
+		set(N_WIDTH, timing.low.count, timing.low.mean() / m_sampleRate);
+		set(N_WIDTH_MIN, timing.low.count, timing.low.min / m_sampleRate);
+		set(N_WIDTH_MAX, timing.low.count, timing.low.max / m_sampleRate);
+
+		const uint64_t total = timing.high.sum + timing.low.sum;
+		set(P_DUTY, timing.high.count && timing.low.count,
+		    total ? 100.0 * timing.high.sum / total : 0);
+		set(EDGES, true, timing.edges);
+
+		/* Delay of the first rising edge relative to the reference channel */
+		set(SKEW, timing.firstRise >= 0 && reference.firstRise >= 0,
+		    static_cast<double>(timing.firstRise - reference.firstRise) / m_sampleRate);
+	}
+}
+
+QList<std::shared_ptr<MeasurementData>> LogicMeasure::measurements(int channel) const
+{
+	return m_measurements[channel];
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGICMEASURE_H
+#define LOGICMEASURE_H
+
+#include "capturestore.h"
+#include "gui/measure.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <QList>
+
+namespace adiscope {
+namespace logic {
+
+/*
+ * Timing measurements for all the digital channels, computed from the edges
+ * found in a single pass over the samples. The samples can be fed
+ * incrementally, so a streaming capture only processes each buffer once.
+ */
+class LogicMeasure
+{
+public:
+	enum defaultMeasurements {
+		FREQUENCY = 0,
+		PERIOD,
+		P_WIDTH,
+		P_WIDTH_MIN,
+		P_WIDTH_MAX,
+		N_WIDTH,
+		N_WIDTH_MIN,
+		N_WIDTH_MAX,
+		P_DUTY,
+		EDGES,
+		SKEW,
+		DEFAULT_MEASUREMENT_COUNT
+	};
+
+	explicit LogicMeasure(int nbChannels = 16);
+
+	double sampleRate() const;
+	void setSampleRate(double sampleRate);
+	int referenceChannel() const;
+	void setReferenceChannel(int channel);
+
+	/* Start measuring from the given sample, having the given value */
+	void reset(uint64_t start, uint16_t initial);
+	uint64_t position() const;
+
+	void process(const uint16_t *samples, uint64_t count);
+	/* Process the store samples up to (excluding) the given one */
+	void advance(const CaptureStore *store, uint64_t until);
+
+	/* Update the measurement values from the edges found so far */
+	void measure();
+	QList<std::shared_ptr<MeasurementData>> measurements(int channel) const;
+
+private:
+	struct Width {
+		uint64_t min;
+		uint64_t max;
+		uint64_t sum;
+		uint64_t count;
+
+		void push(uint64_t width);
+		double mean() const;
+	};
+
+	struct ChannelTiming {
+		int64_t lastRise;
+		int64_t lastFall;
+		int64_t firstRise;
+		uint64_t edges;
+		Width period;
+		Width high;
+		Width low;
+	};
+
+	void processEdges(uint64_t sample, uint16_t changed, uint16_t value);
+
+	int m_nbChannels;
+	double m_sampleRate;
+	int m_referenceChannel;
+	uint64_t m_position;
+	uint16_t m_last;
+	std::vector<ChannelTiming> m_timing;
+	std::vector<uint16_t> m_block;
+	std::vector<QList<std::shared_ptr<MeasurementData>>> m_measurements;
+};
+
+} // namespace logic
+} // namespace adiscope
+
+#endif // LOGICMEASURE_H
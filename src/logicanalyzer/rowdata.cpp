@@ -104,9 +104,10 @@ std::pair<uint64_t, uint64_t> RowData::get_annotation_subset(uint64_t start_samp
     return std::make_pair(first, last);
 }
 
-void RowData::emplace_annotation(srd_proto_data *pdata, const Row *row)
+void RowData::emplace_annotation(srd_proto_data *pdata, const Row *row,
+                                 uint64_t sample_offset)
 {
-    annotations_.emplace_back(pdata, row);
+    annotations_.emplace_back(pdata, row, sample_offset);
 }
 
 
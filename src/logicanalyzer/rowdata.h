@@ -71,7 +71,8 @@ public:
         vector<Annotation> &dest,
         uint64_t start_sample, uint64_t end_sample) const;
 
-    void emplace_annotation(srd_proto_data *pdata, const Row *row);
+    void emplace_annotation(srd_proto_data *pdata, const Row *row,
+                            uint64_t sample_offset = 0);
 
     std::pair<uint64_t, uint64_t> get_annotation_subset(uint64_t start_sample,
                                                         uint64_t end_sample) const;
@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mask_test.hpp"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/* Vertical extent of the regions built around a reference trace */
+#define MASK_TEST_OPEN_LIMIT 1e9
+
+using namespace adiscope;
+
+MaskTest::MaskTest(unsigned int nb_channels) :
+	m_channels(nb_channels),
+	m_x0(0.0),
+	m_step(1.0),
+	m_compiled(false),
+	m_enabled(false),
+	m_stopOnFail(false),
+	m_halted(false),
+	m_tested(0),
+	m_failed(0),
+	m_recordCapacity(16)
+{
+	for (Channel &ch : m_channels) {
+		ch.failed = 0;
+		ch.violations = 0;
+	}
+}
+
+MaskTest::~MaskTest()
+{
+}
+
+unsigned int MaskTest::channelCount() const
+{
+	return m_channels.size();
+}
+
+void MaskTest::setEnabled(bool enabled)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_enabled = enabled;
+}
+
+bool MaskTest::enabled() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_enabled;
+}
+
+void MaskTest::setRegions(unsigned int chn, const QVector<QPolygonF> &regions)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (chn >= m_channels.size()) {
+		return;
+	}
+
+	m_channels[chn].regions = regions;
+	m_compiled = false;
+}
+
+QVector<QPolygonF> MaskTest::regions(unsigned int chn) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (chn >= m_channels.size()) {
+		return QVector<QPolygonF>();
+	}
+
+	return m_channels[chn].regions;
+}
+
+void MaskTest::setReference(unsigned int chn, const double *x, const double *y,
+			    size_t nb_points, double dx, double dy)
+{
+	if (!nb_points) {
+		clearRegions(chn);
+		return;
+	}
+
+	QPolygonF upper, lower;
+	upper.reserve(nb_points + 2);
+	lower.reserve(nb_points + 2);
+
+	/* Sliding max/min over the points within +-dx, using monotonic
+	 * queues of indices so the envelope is built in a single pass */
+	std::deque<size_t> qmax, qmin;
+	size_t next = 0;
+
+	dx = std::abs(dx);
+	for (size_t i = 0; i < nb_points; i++) {
+		while (next < nb_points && x[next] <= x[i] + dx) {
+			while (!qmax.empty() && y[qmax.back()] <= y[next]) {
+				qmax.pop_back();
+			}
+			while (!qmin.empty() && y[qmin.back()] >= y[next]) {
+				qmin.pop_back();
+			}
+			qmax.push_back(next);
+			qmin.push_back(next);
+			next++;
+		}
+
+		while (x[qmax.front()] < x[i] - dx) {
+			qmax.pop_front();
+		}
+		while (x[qmin.front()] < x[i] - dx) {
+			qmin.pop_front();
+		}
+
+		upper.append(QPointF(x[i], y[qmax.front()] + dy));
+		lower.append(QPointF(x[i], y[qmin.front()] - dy));
+	}
+
+	upper << QPointF(x[nb_points - 1], MASK_TEST_OPEN_LIMIT)
+	      << QPointF(x[0], MASK_TEST_OPEN_LIMIT);
+	lower << QPointF(x[nb_points - 1], -MASK_TEST_OPEN_LIMIT)
+	      << QPointF(x[0], -MASK_TEST_OPEN_LIMIT);
+
+	setRegions(chn, QVector<QPolygonF>() << upper << lower);
+}
+
+void MaskTest::clearRegions(unsigned int chn)
+{
+	setRegions(chn, QVector<QPolygonF>());
+}
+
+bool MaskTest::hasRegions() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (const Channel &ch : m_channels) {
+		if (!ch.regions.isEmpty()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void MaskTest::setTimeBase(double x0, double step)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (x0 != m_x0 || step != m_step) {
+		m_x0 = x0;
+		m_step = step;
+		m_compiled = false;
+	}
+}
+
+void MaskTest::setStopOnFail(bool stop)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stopOnFail = stop;
+
+	if (!stop) {
+		m_halted = false;
+	}
+}
+
+bool MaskTest::stopOnFail() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stopOnFail;
+}
+
+bool MaskTest::halted() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_halted;
+}
+
+void MaskTest::rearm()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_halted = false;
+}
+
+void MaskTest::setRecordCapacity(unsigned int frames)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_recordCapacity = frames;
+
+	while (m_failures.size() > m_recordCapacity) {
+		m_failures.pop_front();
+	}
+}
+
+void MaskTest::setFailCallback(const std::function<void()> &callback)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_failCallback = callback;
+}
+
+void MaskTest::compileRegion(const QPolygonF &region,
+			     const std::vector<double> &x, Limits &limits)
+{
+	const int nb_points = region.size();
+
+	for (int i = 0; i < nb_points; i++) {
+		QPointF a = region[i];
+		QPointF b = region[(i + 1) % nb_points];
+
+		if (a.x() == b.x()) {
+			continue;
+		}
+		if (a.x() > b.x()) {
+			std::swap(a, b);
+		}
+
+		auto first = std::lower_bound(x.begin(), x.end(), a.x());
+		auto last = std::upper_bound(first, x.end(), b.x());
+		const double slope = (b.y() - a.y()) / (b.x() - a.x());
+
+		for (auto it = first; it != last; ++it) {
+			const size_t idx = it - x.begin();
+			const float y = a.y() + slope * (*it - a.x());
+
+			limits.low[idx] = std::min(limits.low[idx], y);
+			limits.high[idx] = std::max(limits.high[idx], y);
+		}
+	}
+}
+
+/* An empty interval (low > high) marks the samples a region does not
+ * cover, so they can never be in violation */
+void MaskTest::compile(const double *x, size_t nb_samples)
+{
+	m_grid.assign(x, x + nb_samples);
+
+	for (Channel &ch : m_channels) {
+		ch.limits.resize(ch.regions.size());
+
+		for (int r = 0; r < ch.regions.size(); r++) {
+			Limits &limits = ch.limits[r];
+
+			limits.low.assign(nb_samples,
+					  std::numeric_limits<float>::max());
+			limits.high.assign(nb_samples,
+					   std::numeric_limits<float>::lowest());
+			compileRegion(ch.regions[r], m_grid, limits);
+		}
+	}
+
+	m_compiled = true;
+}
+
+template <typename T>
+bool MaskTest::testFrame(const T * const *data, size_t nb_samples)
+{
+	uint32_t failing = 0;
+
+	m_tested++;
+
+	for (size_t c = 0; c < m_channels.size(); c++) {
+		Channel &ch = m_channels[c];
+		uint64_t count = 0;
+
+		if (!data[c]) {
+			continue;
+		}
+
+		for (const Limits &limits : ch.limits) {
+			const T *y = data[c];
+			const float *low = limits.low.data();
+			const float *high = limits.high.data();
+
+			for (size_t i = 0; i < nb_samples; i++) {
+				count += (y[i] >= low[i]) & (y[i] <= high[i]);
+			}
+		}
+
+		if (count) {
+			failing |= 1u << c;
+			ch.failed++;
+			ch.violations += count;
+		}
+	}
+
+	if (!failing) {
+		return false;
+	}
+
+	m_failed++;
+
+	if (m_recordCapacity) {
+		MaskFailure failure;
+
+		failure.timestamp = QDateTime::currentMSecsSinceEpoch();
+		failure.frame = m_tested - 1;
+		failure.channels = failing;
+		failure.x = m_grid;
+		failure.data.resize(m_channels.size());
+
+		for (size_t c = 0; c < m_channels.size(); c++) {
+			if (data[c]) {
+				failure.data[c].assign(data[c],
+						       data[c] + nb_samples);
+			}
+		}
+
+		if (m_failures.size() >= m_recordCapacity) {
+			m_failures.pop_front();
+		}
+		m_failures.push_back(std::move(failure));
+	}
+
+	if (m_stopOnFail) {
+		m_halted = true;
+	}
+
+	return true;
+}
+
+bool MaskTest::test(const float * const *data, size_t nb_samples)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (!m_enabled || m_halted || !nb_samples) {
+		return false;
+	}
+
+	if (!m_compiled || m_grid.size() != nb_samples) {
+		std::vector<double> x(nb_samples);
+
+		for (size_t i = 0; i < nb_samples; i++) {
+			x[i] = m_x0 + i * m_step;
+		}
+		compile(x.data(), nb_samples);
+	}
+
+	if (!testFrame(data, nb_samples)) {
+		return false;
+	}
+
+	auto callback = m_failCallback;
+	lock.unlock();
+
+	if (callback) {
+		callback();
+	}
+
+	return true;
+}
+
+bool MaskTest::test(const double * const *data, const double *x,
+		    size_t nb_samples)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (!m_enabled || m_halted || !nb_samples) {
+		return false;
+	}
+
+	if (!m_compiled || m_grid.size() != nb_samples ||
+			!std::equal(m_grid.begin(), m_grid.end(), x)) {
+		compile(x, nb_samples);
+	}
+
+	if (!testFrame(data, nb_samples)) {
+		return false;
+	}
+
+	auto callback = m_failCallback;
+	lock.unlock();
+
+	if (callback) {
+		callback();
+	}
+
+	return true;
+}
+
+void MaskTest::resetCounters()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_tested = 0;
+	m_failed = 0;
+	m_halted = false;
+	m_failures.clear();
+
+	for (Channel &ch : m_channels) {
+		ch.failed = 0;
+		ch.violations = 0;
+	}
+}
+
+uint64_t MaskTest::testedFrames() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_tested;
+}
+
+uint64_t MaskTest::failedFrames() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_failed;
+}
+
+uint64_t MaskTest::failedFrames(unsigned int chn) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return chn < m_channels.size() ? m_channels[chn].failed : 0;
+}
+
+uint64_t MaskTest::violations(unsigned int chn) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return chn < m_channels.size() ? m_channels[chn].violations : 0;
+}
+
+std::vector<MaskFailure> MaskTest::failures() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::vector<MaskFailure>(m_failures.begin(), m_failures.end());
+}
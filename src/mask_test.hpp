@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MASK_TEST_HPP
+#define MASK_TEST_HPP
+
+#include <QPolygonF>
+#include <QVector>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace adiscope {
+/* A frame that violated the mask, kept for later inspection */
+struct MaskFailure
+{
+	qint64 timestamp;
+	uint64_t frame;
+	uint32_t channels;	// bit mask of the failing channels
+	std::vector<double> x;
+	std::vector<std::vector<double>> data;
+};
+
+/* Go/no-go testing of every acquired frame against keep-out regions.
+ *
+ * Each channel owns a set of x-monotone polygons (every vertical line
+ * crosses a region at most once), given in plot coordinates. Before
+ * testing, the regions are compiled for the sample positions of the
+ * frame into one [low, high] forbidden interval per sample and region,
+ * so testing a frame is a single comparison pass over the samples. The
+ * compiled limits are only rebuilt when the sample positions change.
+ *
+ * Frames are tested from the acquisition thread, while the settings and
+ * the results are accessed from the GUI, so all the methods lock. */
+class MaskTest
+{
+public:
+	explicit MaskTest(unsigned int nb_channels);
+	~MaskTest();
+
+	unsigned int channelCount() const;
+
+	void setEnabled(bool enabled);
+	bool enabled() const;
+
+	void setRegions(unsigned int chn, const QVector<QPolygonF> &regions);
+	QVector<QPolygonF> regions(unsigned int chn) const;
+
+	/* Build the regions above and below a reference trace. The trace
+	 * is widened by dx along the x axis (max/min of the neighbouring
+	 * points) and by dy along the y axis. */
+	void setReference(unsigned int chn, const double *x, const double *y,
+			  size_t nb_points, double dx, double dy);
+	void clearRegions(unsigned int chn);
+	bool hasRegions() const;
+
+	/* Position of the samples for the frames given without an x axis,
+	 * x = x0 + i * step */
+	void setTimeBase(double x0, double step);
+
+	/* Stop testing (halt) after the first failure until rearm() */
+	void setStopOnFail(bool stop);
+	bool stopOnFail() const;
+	bool halted() const;
+	void rearm();
+
+	/* Number of failing frames kept, oldest ones are dropped */
+	void setRecordCapacity(unsigned int frames);
+
+	/* Called from the testing thread after each failing frame */
+	void setFailCallback(const std::function<void()> &callback);
+
+	/* Return true when at least one channel violated the mask. The
+	 * data holds one pointer per channel, null for untested ones. */
+	bool test(const float * const *data, size_t nb_samples);
+	bool test(const double * const *data, const double *x,
+		  size_t nb_samples);
+
+	void resetCounters();
+	uint64_t testedFrames() const;
+	uint64_t failedFrames() const;
+	uint64_t failedFrames(unsigned int chn) const;
+	uint64_t violations(unsigned int chn) const;
+	std::vector<MaskFailure> failures() const;
+
+private:
+	struct Limits {
+		std::vector<float> low;
+		std::vector<float> high;
+	};
+
+	struct Channel {
+		QVector<QPolygonF> regions;
+		std::vector<Limits> limits;
+		uint64_t failed;
+		uint64_t violations;
+	};
+
+	mutable std::mutex m_mutex;
+	std::vector<Channel> m_channels;
+	std::vector<double> m_grid;
+	double m_x0;
+	double m_step;
+	bool m_compiled;
+	bool m_enabled;
+	bool m_stopOnFail;
+	bool m_halted;
+	uint64_t m_tested;
+	uint64_t m_failed;
+	unsigned int m_recordCapacity;
+	std::deque<MaskFailure> m_failures;
+	std::function<void()> m_failCallback;
+
+	void compile(const double *x, size_t nb_samples);
+	static void compileRegion(const QPolygonF &region,
+				  const std::vector<double> &x, Limits &limits);
+
+	template <typename T>
+	bool testFrame(const T * const *data, size_t nb_samples);
+};
+}
+
+#endif /* MASK_TEST_HPP */
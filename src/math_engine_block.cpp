@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "math_engine_block.h"
+
+#include <gnuradio/io_signature.h>
+
+using namespace adiscope;
+
+math_engine_block::sptr math_engine_block::make(unsigned int nb_inputs,
+		const std::vector<std::string> &functions, float lo, float hi)
+{
+	return gnuradio::get_initial_sptr(
+			new math_engine_block(nb_inputs, functions, lo, hi));
+}
+
+math_engine_block::math_engine_block(unsigned int nb_inputs,
+		const std::vector<std::string> &functions, float lo, float hi) :
+	gr::sync_block("math_engine_block",
+			gr::io_signature::make(nb_inputs, nb_inputs,
+				sizeof(float)),
+			gr::io_signature::make(functions.size(),
+				functions.size(), sizeof(float))),
+	d_lo(lo),
+	d_hi(hi)
+{
+	for (const std::string &function : functions)
+		d_expressions.emplace_back(function, nb_inputs);
+}
+
+math_engine_block::~math_engine_block()
+{
+}
+
+int math_engine_block::work(int noutput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	const float * const *in = (const float * const *) input_items.data();
+
+	for (unsigned int i = 0; i < d_expressions.size(); i++) {
+		float *out = (float *) output_items[i];
+
+		d_expressions[i].evaluate(in, out, noutput_items);
+
+		for (int j = 0; j < noutput_items; j++)
+			out[j] = out[j] < d_lo ? d_lo :
+				(out[j] > d_hi ? d_hi : out[j]);
+	}
+
+	return noutput_items;
+}
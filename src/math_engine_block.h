@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATH_ENGINE_BLOCK_H
+#define MATH_ENGINE_BLOCK_H
+
+#include <gnuradio/sync_block.h>
+
+#include <string>
+#include <vector>
+
+#include "math_expression.hpp"
+
+namespace adiscope {
+	/* Evaluates all the math channels of an instrument in one block.
+	 * Each input is read once per call to work() and output N holds
+	 * the result of function N, clamped to [lo, hi]. */
+	class math_engine_block : public gr::sync_block
+	{
+	public:
+		typedef boost::shared_ptr<math_engine_block> sptr;
+
+		/* Throws std::runtime_error if a function is invalid */
+		static sptr make(unsigned int nb_inputs,
+				const std::vector<std::string> &functions,
+				float lo, float hi);
+		~math_engine_block();
+
+		int work(int noutput_items,
+				gr_vector_const_void_star &input_items,
+				gr_vector_void_star &output_items);
+
+	private:
+		math_engine_block(unsigned int nb_inputs,
+				const std::vector<std::string> &functions,
+				float lo, float hi);
+
+		std::vector<math_expression> d_expressions;
+		float d_lo, d_hi;
+	};
+}
+
+#endif /* MATH_ENGINE_BLOCK_H */
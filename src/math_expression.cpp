@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "math_expression.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+/* Samples processed by each instruction at once */
+#define MATH_EXPRESSION_CHUNK	256
+
+using namespace adiscope;
+
+static const struct {
+	const char *name;
+	float (*fn)(float);
+} math_functions[] = {
+	{ "sin", [](float x) { return std::sin(x); } },
+	{ "asin", [](float x) { return std::asin(x); } },
+	{ "sinh", [](float x) { return std::sinh(x); } },
+	{ "cos", [](float x) { return std::cos(x); } },
+	{ "acos", [](float x) { return std::acos(x); } },
+	{ "cosh", [](float x) { return std::cosh(x); } },
+	{ "tan", [](float x) { return std::tan(x); } },
+	{ "atan", [](float x) { return std::atan(x); } },
+	{ "tanh", [](float x) { return std::tanh(x); } },
+	{ "log", [](float x) { return std::log(x); } },
+	{ "log10", [](float x) { return std::log10(x); } },
+	{ "exp", [](float x) { return std::exp(x); } },
+	{ "sqrt", [](float x) { return std::sqrt(x); } },
+};
+
+math_expression::math_expression(const std::string &function,
+		unsigned int nb_inputs) :
+	d_function(function),
+	d_nb_inputs(nb_inputs),
+	d_pos(0)
+{
+	int root = parse_sum();
+
+	skip_spaces();
+	if (d_pos != d_function.size())
+		fail("unexpected character");
+
+	unsigned int max_depth = 0;
+	emit(root, 0, max_depth);
+
+	d_scratch.assign(max_depth,
+			std::vector<float>(MATH_EXPRESSION_CHUNK));
+	d_stack.resize(max_depth);
+	d_nodes.clear();
+}
+
+void math_expression::fail(const std::string &what) const
+{
+	throw std::runtime_error("Invalid math function \"" + d_function +
+			"\": " + what + " at position " +
+			std::to_string(d_pos));
+}
+
+void math_expression::skip_spaces()
+{
+	while (d_pos < d_function.size() && std::isspace(
+				(unsigned char) d_function[d_pos]))
+		d_pos++;
+}
+
+bool math_expression::accept(char c)
+{
+	skip_spaces();
+	if (d_pos < d_function.size() && d_function[d_pos] == c) {
+		d_pos++;
+		return true;
+	}
+
+	return false;
+}
+
+static float fold(int op, float a, float b)
+{
+	switch (op) {
+	case 0: return a + b;
+	case 1: return a - b;
+	case 2: return a * b;
+	case 3: return a / b;
+	default: return std::pow(a, b);
+	}
+}
+
+int math_expression::make_const(float value)
+{
+	d_nodes.push_back({ OP_CONST, 0, value, -1, -1 });
+	return d_nodes.size() - 1;
+}
+
+int math_expression::make_node(opcode op, int left, int right,
+		unsigned int arg, float value)
+{
+	bool const_left = left >= 0 && d_nodes[left].op == OP_CONST;
+	bool const_right = right < 0 || d_nodes[right].op == OP_CONST;
+
+	/* Constant folding */
+	if (const_left && const_right) {
+		float a = d_nodes[left].value;
+
+		switch (op) {
+		case OP_NEG:
+			return make_const(-a);
+		case OP_FUNC:
+			return make_const(math_functions[arg].fn(a));
+		case OP_ADD: case OP_SUB: case OP_MUL:
+		case OP_DIV: case OP_POW:
+			return make_const(fold(op - OP_ADD, a,
+						d_nodes[right].value));
+		default:
+			break;
+		}
+	}
+
+	d_nodes.push_back({ op, arg, value, left, right });
+	return d_nodes.size() - 1;
+}
+
+int math_expression::parse_sum()
+{
+	int left = parse_product();
+
+	for (;;) {
+		if (accept('+'))
+			left = make_node(OP_ADD, left, parse_product());
+		else if (accept('-'))
+			left = make_node(OP_SUB, left, parse_product());
+		else
+			return left;
+	}
+}
+
+int math_expression::parse_product()
+{
+	int left = parse_unary();
+
+	for (;;) {
+		if (accept('*'))
+			left = make_node(OP_MUL, left, parse_unary());
+		else if (accept('/'))
+			left = make_node(OP_DIV, left, parse_unary());
+		else
+			return left;
+	}
+}
+
+int math_expression::parse_unary()
+{
+	if (accept('-'))
+		return make_node(OP_NEG, parse_unary(), -1);
+	if (accept('+'))
+		return parse_unary();
+
+	return parse_power();
+}
+
+/* Right associative, and binds tighter than the unary minus */
+int math_expression::parse_power()
+{
+	int base = parse_primary();
+
+	if (accept('^'))
+		return make_node(OP_POW, base, parse_unary());
+
+	return base;
+}
+
+int math_expression::parse_primary()
+{
+	if (accept('(')) {
+		int idx = parse_sum();
+
+		if (!accept(')'))
+			fail("missing )");
+		return idx;
+	}
+
+	skip_spaces();
+	if (d_pos == d_function.size())
+		fail("unexpected end");
+
+	const std::string &f = d_function;
+	size_t start = d_pos;
+
+	/* Numbers use either the point or the comma of the locale */
+	if (std::isdigit((unsigned char) f[d_pos]) ||
+			f[d_pos] == '.' || f[d_pos] == ',') {
+		while (d_pos < f.size() &&
+				std::isdigit((unsigned char) f[d_pos]))
+			d_pos++;
+		if (d_pos < f.size() && (f[d_pos] == '.' || f[d_pos] == ','))
+			d_pos++;
+		while (d_pos < f.size() &&
+				std::isdigit((unsigned char) f[d_pos]))
+			d_pos++;
+
+		size_t exp = d_pos;
+		if (exp < f.size() && (f[exp] == 'e' || f[exp] == 'E')) {
+			exp++;
+			if (exp < f.size() && (f[exp] == '+' || f[exp] == '-'))
+				exp++;
+			if (exp < f.size() &&
+					std::isdigit((unsigned char) f[exp])) {
+				d_pos = exp;
+				while (d_pos < f.size() && std::isdigit(
+							(unsigned char) f[d_pos]))
+					d_pos++;
+			}
+		}
+
+		std::string text = f.substr(start, d_pos - start);
+		std::replace(text.begin(), text.end(), ',', '.');
+
+		std::istringstream stream(text);
+		stream.imbue(std::locale::classic());
+
+		double value;
+		if (!(stream >> value))
+			fail("invalid number");
+
+		return make_const(value);
+	}
+
+	if (!std::isalpha((unsigned char) f[d_pos]))
+		fail("unexpected character");
+
+	while (d_pos < f.size() && (std::isalnum((unsigned char) f[d_pos]) ||
+				f[d_pos] == '_'))
+		d_pos++;
+
+	std::string name = f.substr(start, d_pos - start);
+
+	if (name == "pi")
+		return make_const(M_PI);
+	if (name == "e")
+		return make_const(M_E);
+
+	if (name[0] == 't' && name.find_first_not_of("0123456789", 1) ==
+			std::string::npos) {
+		unsigned int input = name.size() > 1 ?
+			std::stoul(name.substr(1)) : 0;
+
+		if (input >= d_nb_inputs || (name.size() == 1 &&
+					d_nb_inputs > 1))
+			fail("no input " + name);
+
+		return make_node(OP_INPUT, -1, -1, input);
+	}
+
+	for (unsigned int i = 0; i < sizeof(math_functions) /
+			sizeof(math_functions[0]); i++) {
+		if (name != math_functions[i].name)
+			continue;
+
+		if (!accept('('))
+			fail("missing ( after " + name);
+
+		int arg = parse_sum();
+
+		if (!accept(')'))
+			fail("missing )");
+
+		return make_node(OP_FUNC, arg, -1, i);
+	}
+
+	fail("unknown name " + name);
+}
+
+void math_expression::emit(int idx, unsigned int depth,
+		unsigned int &max_depth)
+{
+	const node &n = d_nodes[idx];
+
+	max_depth = std::max(max_depth, depth + 1);
+
+	if (n.left >= 0)
+		emit(n.left, depth, max_depth);
+	if (n.right >= 0)
+		emit(n.right, depth + 1, max_depth);
+
+	d_program.push_back({ n.op, n.arg, n.value });
+}
+
+template <typename F>
+static inline void apply(const float *a, float ca, bool const_a,
+		const float *b, float cb, bool const_b,
+		float *dst, size_t n, F f)
+{
+	if (const_a) {
+		for (size_t i = 0; i < n; i++)
+			dst[i] = f(ca, b[i]);
+	} else if (const_b) {
+		for (size_t i = 0; i < n; i++)
+			dst[i] = f(a[i], cb);
+	} else {
+		for (size_t i = 0; i < n; i++)
+			dst[i] = f(a[i], b[i]);
+	}
+}
+
+void math_expression::evaluate(const float * const *inputs, float *out,
+		size_t n)
+{
+	for (size_t off = 0; off < n; off += MATH_EXPRESSION_CHUNK) {
+		size_t len = std::min<size_t>(n - off, MATH_EXPRESSION_CHUNK);
+		unsigned int sp = 0;
+
+		for (const instruction &ins : d_program) {
+			switch (ins.op) {
+			case OP_INPUT:
+				d_stack[sp++] = { inputs[ins.arg] + off,
+					0.0f, false };
+				continue;
+			case OP_CONST:
+				d_stack[sp++] = { nullptr, ins.value, true };
+				continue;
+			default:
+				break;
+			}
+
+			if (ins.op == OP_NEG || ins.op == OP_FUNC) {
+				slot &a = d_stack[sp - 1];
+				float *dst = d_scratch[sp - 1].data();
+
+				if (ins.op == OP_NEG) {
+					for (size_t i = 0; i < len; i++)
+						dst[i] = -a.data[i];
+				} else {
+					float (*fn)(float) =
+						math_functions[ins.arg].fn;
+
+					for (size_t i = 0; i < len; i++)
+						dst[i] = fn(a.data[i]);
+				}
+
+				a.data = dst;
+				continue;
+			}
+
+			const slot &a = d_stack[sp - 2];
+			const slot &b = d_stack[sp - 1];
+			float *dst = d_scratch[sp - 2].data();
+
+#define APPLY(expr) apply(a.data, a.value, a.is_const, \
+		b.data, b.value, b.is_const, dst, len, \
+		[](float x, float y) { return (expr); })
+
+			switch (ins.op) {
+			case OP_ADD:
+				APPLY(x + y);
+				break;
+			case OP_SUB:
+				APPLY(x - y);
+				break;
+			case OP_MUL:
+				APPLY(x * y);
+				break;
+			case OP_DIV:
+				APPLY(x / y);
+				break;
+			default:
+				if (b.is_const && b.value == 2.0f)
+					apply(a.data, a.value, a.is_const,
+						b.data, b.value, b.is_const,
+						dst, len, [](float x, float) {
+						return x * x; });
+				else
+					APPLY(std::pow(x, y));
+				break;
+			}
+
+#undef APPLY
+
+			d_stack[sp - 2] = { dst, 0.0f, false };
+			sp--;
+		}
+
+		const slot &result = d_stack[0];
+
+		if (result.is_const)
+			std::fill(out + off, out + off + len, result.value);
+		else
+			memcpy(out + off, result.data, len * sizeof(float));
+	}
+}
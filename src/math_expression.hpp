@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATH_EXPRESSION_HPP
+#define MATH_EXPRESSION_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace adiscope {
+	/* Math channel function compiled once into a small stack program.
+	 * The program is run over chunks of samples, each instruction
+	 * processing a whole chunk in a tight loop, so the cost per sample
+	 * depends only on the number of operations of the function.
+	 *
+	 * The syntax is the one of the math panel: numbers, e, pi, the
+	 * inputs t0..tN (or t with a single input), + - * / ^, parentheses
+	 * and the functions listed in the panel. Constant sub-expressions
+	 * are folded at compile time. */
+	class math_expression
+	{
+	public:
+		/* Throws std::runtime_error on a syntax error */
+		math_expression(const std::string &function,
+				unsigned int nb_inputs);
+
+		void evaluate(const float * const *inputs, float *out,
+				size_t n);
+
+		const std::string& function() const { return d_function; }
+		unsigned int nb_operations() const { return d_program.size(); }
+
+	private:
+		enum opcode {
+			OP_INPUT, OP_CONST,
+			OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+			OP_NEG, OP_FUNC,
+		};
+
+		struct instruction {
+			opcode op;
+			unsigned int arg;	// input or function index
+			float value;
+		};
+
+		struct slot {
+			const float *data;
+			float value;
+			bool is_const;
+		};
+
+		struct node {
+			opcode op;
+			unsigned int arg;
+			float value;
+			int left, right;
+		};
+
+		std::string d_function;
+		unsigned int d_nb_inputs;
+		std::vector<node> d_nodes;
+		std::vector<instruction> d_program;
+		std::vector<std::vector<float>> d_scratch;
+		std::vector<slot> d_stack;
+
+		/* Parser */
+		size_t d_pos;
+
+		int parse_sum();
+		int parse_product();
+		int parse_unary();
+		int parse_power();
+		int parse_primary();
+		bool accept(char c);
+		void skip_spaces();
+		[[noreturn]] void fail(const std::string &what) const;
+
+		int make_node(opcode op, int left, int right,
+				unsigned int arg = 0, float value = 0.0f);
+		int make_const(float value);
+		void emit(int idx, unsigned int depth, unsigned int &max_depth);
+	};
+}
+
+#endif /* MATH_EXPRESSION_HPP */
@@ -97,10 +97,8 @@ void NetworkAnalyzer::_configureAdcFlowgraph(size_t buffer_size)
 		// Make sure the values are sorted in ascending order (1000,..,100e6)
 		sampleRates = m_m2k_analogin->getAvailableSampleRates();
 
-		dc_cancel1 = gnuradio::get_initial_sptr(
-					new cancel_dc_offset_block(1, false));
-		dc_cancel2 = gnuradio::get_initial_sptr(
-					new cancel_dc_offset_block(1, false));
+		dc_cancel1 = cancel_dc_offset_block::make(1, false);
+		dc_cancel2 = cancel_dc_offset_block::make(1, false);
 
 		capture1 = gr::blocks::vector_source_s::make(std::vector<short>(), false, 1);
 		capture2 = gr::blocks::vector_source_s::make(std::vector<short>(), false, 1);
@@ -237,6 +235,8 @@ NetworkAnalyzer::NetworkAnalyzer(struct iio_context *ctx, Filter *filt,
 
 	connect(this, &NetworkAnalyzer::sweepDone,
 	[=]() {
+		plotPendingPoints();
+
 		if (ui->runSingleWidget->runButtonChecked()) {
 			thd = QtConcurrent::run(this, &NetworkAnalyzer::goertzel);
 			return;
@@ -1553,12 +1553,15 @@ void NetworkAnalyzer::plot(double frequency, double mag1, double mag2,
 
 	bool hasError = _checkMagForOverrange(mag + magBonus);
 
-	m_dBgraph.plot(frequency, mag + magBonus);
-	m_phaseGraph.plot(frequency, adjusted_phase_deg);
-	ui->xygraph->plot(phase_deg, mag + magBonus);
-	ui->nicholsgraph->plot(phase_deg, mag + magBonus);
-
-	d_frequencyHandle->triggerMove();
+	/* The points queued meanwhile are added to the graphs together */
+	m_pendingFrequency.push_back(frequency);
+	m_pendingMagnitude.push_back(mag + magBonus);
+	m_pendingPhase.push_back(adjusted_phase_deg);
+	m_pendingPhaseDeg.push_back(phase_deg);
+	if (m_pendingFrequency.size() == 1) {
+		QMetaObject::invokeMethod(this, "plotPendingPoints",
+					  Qt::QueuedConnection);
+	}
 
 	int responseChanel = ui->btnRefChn->isChecked() ? 1 : 0;
 	libm2k::analog::ANALOG_IN_CHANNEL chn = static_cast<libm2k::analog::ANALOG_IN_CHANNEL>(responseChanel);
@@ -1577,6 +1580,25 @@ void NetworkAnalyzer::plot(double frequency, double mag1, double mag2,
 	magBonus = autoUpdateGainMode(mag, magBonus, dcVoltage);
 }
 
+void NetworkAnalyzer::plotPendingPoints()
+{
+	if (m_pendingFrequency.isEmpty()) {
+		return;
+	}
+
+	m_dBgraph.plot(m_pendingFrequency, m_pendingMagnitude);
+	m_phaseGraph.plot(m_pendingFrequency, m_pendingPhase);
+	ui->xygraph->plot(m_pendingPhaseDeg, m_pendingMagnitude);
+	ui->nicholsgraph->plot(m_pendingPhaseDeg, m_pendingMagnitude);
+
+	m_pendingFrequency.clear();
+	m_pendingMagnitude.clear();
+	m_pendingPhase.clear();
+	m_pendingPhaseDeg.clear();
+
+	d_frequencyHandle->triggerMove();
+}
+
 bool NetworkAnalyzer::_checkMagForOverrange(double magnitude)
 {
 	int responseChannel = ui->btnRefChn->isChecked() ? 1 : 0;
@@ -1723,6 +1745,7 @@ void NetworkAnalyzer::startStop(bool pressed)
 
 	if (pressed) {
 		m_m2k_analogin->setKernelBuffersCount(1);
+		plotPendingPoints();
 		if (shouldClear) {
 			m_dBgraph.reset();
 			m_phaseGraph.reset();
@@ -1750,6 +1773,7 @@ void NetworkAnalyzer::startStop(bool pressed)
 			HANDLE_EXCEPTION(e)
 			qDebug(CAT_NETWORK_ANALYZER) << e.what();
 		}
+		plotPendingPoints();
 		m_dBgraph.sweepDone();
 		m_phaseGraph.sweepDone();
 		ui->statusLabel->setText(tr("Stopped"));
@@ -148,6 +148,12 @@ private:
 	QVector<networkIteration> iterations;
 	QVector<NetworkIterationStats> iterationStats;
 
+	/* Sweep points waiting to be added to the graphs in one batch */
+	QVector<double> m_pendingFrequency;
+	QVector<double> m_pendingMagnitude;
+	QVector<double> m_pendingPhase;
+	QVector<double> m_pendingPhaseDeg;
+
 	std::thread *iterationsThread;
 	bool iterationsThreadCanceled;
 	bool iterationsThreadReady;
@@ -264,6 +270,7 @@ private Q_SLOTS:
 	void updateNumSamplesPerDecade(bool force = false);
 	void updateSampleStepSize(bool force = false);
 	void plot(double frequency, double mag, double mag2, double phase, float dcVoltage);
+	void plotPendingPoints();
 	void _saveChannelBuffers(double frequency, double sample_rate, std::vector<float> data1, std::vector<float> data2);
 
 	void toggleCursors(bool en);
@@ -176,6 +176,20 @@ void NyquistGraph::plot(double azimuth, double radius)
 	replot();
 }
 
+void NyquistGraph::plot(const QVector<double>& azimuth,
+			const QVector<double>& radius)
+{
+	const int count = qMin(azimuth.size(), radius.size());
+
+	for (int i = 0; i < count && curve.dataSize() != numSamples + 1; i++) {
+		samples->addSample(QwtPointPolar(azimuth[i], radius[i]));
+	}
+
+	if (count) {
+		replot();
+	}
+}
+
 int NyquistGraph::getNumSamples() const
 {
 	return numSamples;
@@ -74,6 +74,7 @@ namespace adiscope {
 		void setBgColor(const QColor& color);
 		void setNumSamples(int num);
 		void plot(double x, double y);
+		void plot(const QVector<double>& x, const QVector<double>& y);
 		void reset();
 		void setThickness(int value);
 
@@ -23,7 +23,6 @@
 
 /* GNU Radio includes */
 #include <gnuradio/blocks/float_to_complex.h>
-#include <scopy/math.h>
 #include <gnuradio/blocks/sub.h>
 #include <gnuradio/filter/iir_filter_ffd.h>
 #include <gnuradio/blocks/nlog10_ff.h>
@@ -41,6 +40,10 @@
 #include <QComboBox>
 #include <QDockWidget>
 #include <QElapsedTimer>
+#include <QCheckBox>
+#include <QDateTime>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QtConcurrent>
 
 /* libm2k includes */
@@ -90,6 +93,14 @@
 #define MAX_MATH_RANGE SHRT_MAX
 #define MIN_MATH_RANGE SHRT_MIN
 #define MAX_AMPL 25
+#define OSC_ACQ_DEFAULT_FACTOR 16
+#define OSC_ACQ_MAX_FACTOR 1024
+#define OSC_HISTORY_DEFAULT_SIZE 32
+#define OSC_HISTORY_MAX_SIZE 1000
+#define OSC_HISTORY_MAX_BYTES (256 * 1024 * 1024)
+#define OSC_MASK_DEFAULT_TOLERANCE 0.1
+#define OSC_RECORDER_STATUS_MS 500
+#define OSC_SW_TRIGGER_RATE_MS 1000
 
 using namespace adiscope;
 using namespace gr;
@@ -146,6 +157,11 @@ Oscilloscope::Oscilloscope(struct iio_context *ctx, Filter *filt,
 	horiz_offset(0),
 	reset_horiz_offset(true),
 	wheelEventGuard(nullptr),
+	maskTest(nullptr),
+	recorder(nullptr),
+	swTriggerTypeBox(nullptr),
+	sw_trigger_en(false),
+	sw_trigger_hw_en(true),
 	miniHistogram(true),
 	gatingEnabled(false),
 	m_filtering_enabled(true),
@@ -163,10 +179,8 @@ Oscilloscope::Oscilloscope(struct iio_context *ctx, Filter *filt,
 		symmBufferMode->setTriggerBufferMaxSize(8192); // 8192 is what hardware supports
 		symmBufferMode->setTimeDivisionCount(plot.xAxisNumDiv());
 	}
-	dc_cancel.push_back(gnuradio::get_initial_sptr(
-			new cancel_dc_offset_block(1, true)));
-	dc_cancel.push_back(gnuradio::get_initial_sptr(
-			new cancel_dc_offset_block(1, true)));
+	dc_cancel.push_back(cancel_dc_offset_block::make(1, true));
+	dc_cancel.push_back(cancel_dc_offset_block::make(1, true));
 
 	/* Measurements Settings */
 	measure_settings_init();
@@ -196,6 +210,12 @@ Oscilloscope::Oscilloscope(struct iio_context *ctx, Filter *filt,
 			400, "Osc XY", nb_channels / 2, (QObject*)&xy_plot);
 
 	this->qt_time_block->set_trigger_mode(TRIG_MODE_TAG, 0, "buffer_start");
+	this->qt_time_block->set_frame_callback([=](
+			const std::vector<const float *> &frames, int nitems) {
+		timeFrameReceived(frames, nitems);
+	});
+
+	this->sw_trigger_block = software_trigger_block::make(nb_channels);
 
 	// get target fps from preferences
 	double targetFps = getScopyPreferences()->getTarget_fps();
@@ -295,7 +315,8 @@ Oscilloscope::Oscilloscope(struct iio_context *ctx, Filter *filt,
 		ids[i] = iio->connect(adc_samp_conv_block, i, i,
 				true, qt_time_block->nsamps());
 
-		iio->connect(adc_samp_conv_block, i, qt_time_block, i);
+		iio->connect(adc_samp_conv_block, i, sw_trigger_block, i);
+		iio->connect(sw_trigger_block, i, qt_time_block, i);
 
 		iio->connect(adc_samp_conv_block, i, qt_hist_block, i);
 	}
@@ -734,6 +755,15 @@ Oscilloscope::Oscilloscope(struct iio_context *ctx, Filter *filt,
 	connect(&trigger_settings, SIGNAL(triggerModeChanged(int)),
 		this, SLOT(onTriggerModeChanged(int)));
 
+	connect(&trigger_settings, SIGNAL(sourceChanged(int)),
+		SLOT(updateHistoryInfo()));
+	connect(&trigger_settings, SIGNAL(analogTriggerEnabled(bool)),
+		SLOT(updateHistoryInfo()));
+	connect(&trigger_settings, SIGNAL(levelChanged(double)),
+		SLOT(updateHistoryInfo()));
+	connect(&trigger_settings, SIGNAL(triggerModeChanged(int)),
+		SLOT(updateHistoryInfo()));
+
 	connect(&*iio, SIGNAL(timeout()),
 			&trigger_settings, SLOT(autoTriggerDisable()));
 	connect(&plot, SIGNAL(newData()),
@@ -842,12 +872,6 @@ Oscilloscope::Oscilloscope(struct iio_context *ctx, Filter *filt,
 
 		auto max_elem = max_element(probe_attenuation.begin(), probe_attenuation.begin() + nb_channels);
 
-		auto const values = math_rails.values();
-		for (auto rail : values) {
-			rail->set_lo(MIN_MATH_RANGE);
-			rail->set_hi(MAX_MATH_RANGE);
-		}
-
 		if (started)
 			iio->unlock();
 
@@ -884,6 +908,12 @@ Oscilloscope::Oscilloscope(struct iio_context *ctx, Filter *filt,
 	init_buffer_scrolling();
 
 	export_settings_init();
+	acquisition_settings_init();
+	persistence_settings_init();
+	mask_settings_init();
+	recorder_settings_init();
+	sw_trigger_settings_init();
+	history_settings_init();
 	cursor_panel_init();
 	setFFT_params(true);
 
@@ -1313,6 +1343,8 @@ Oscilloscope::~Oscilloscope()
 	ui->runSingleWidget->toggle(false);
 	setDynamicProperty(runButton(), "disabled", false);
 
+	qt_time_block->set_frame_callback(nullptr);
+
 	bool started = isIioManagerStarted();
 	if (started)
 		iio->lock();
@@ -1320,17 +1352,11 @@ Oscilloscope::~Oscilloscope()
 	for (unsigned int i = 0; i < nb_channels; i++)
 		iio->disconnect(ids[i]);
 
-	if (fft_is_visible) {
-		if (fft_channels.size() > 0) {
-			fft_channels.clear();
-			fft_blocks.clear();
-			ctm_blocks.clear();
-		}
-	}
-
 	if (started)
 		iio->unlock();
 
+	stopFftFlow();
+
 	gr::hier_block2_sptr hier = iio->to_hier_block2();
 	qDebug(CAT_OSCILLOSCOPE) << "OSC disconnected:\n" << gr::dot_graph(hier).c_str();
 
@@ -1350,6 +1376,11 @@ Oscilloscope::~Oscilloscope()
 	delete autoset_id;
 	delete ch_ui;
 	delete gsettings_ui;
+	delete history;
+	qt_time_block->set_mask_test(nullptr);
+	delete maskTest;
+	stopPlayback();
+	recorder->stop();
 	delete measure_panel_ui;
 	delete cursor_readouts_ui;
 	delete statistics_panel_ui;
@@ -1413,7 +1444,7 @@ void Oscilloscope::readPreferences()
 	setFilteringEnabled(prefPanel->getOsc_filtering_enabled());
 	double fps = prefPanel->getTarget_fps();
 	iio->set_data_rate(std::max(fps, 15.0)); // minimum 15 buffers/second
-	qt_time_block->set_update_time(1.0/fps);
+	setTimeSinksUpdateTime();
 	qt_fft_block->set_update_time(1.0/fps);;
 	qt_xy_block->set_update_time(1.0/fps);;
 	qt_hist_block->set_update_time(1.0/fps);;
@@ -1470,7 +1501,8 @@ void Oscilloscope::enableMixedSignalView(ChannelWidget *cw)
 
 		// connect analog
 		for (int i = 0; i < nb_channels; ++i) {
-			iio->disconnect(block, i, qt_time_block, i);
+			iio->disconnect(block, i, sw_trigger_block, i);
+			iio->disconnect(sw_trigger_block, i, qt_time_block, i);
 			iio->connect(block, i, mixed_sink, i);
 		}
 
@@ -1519,7 +1551,8 @@ void Oscilloscope::disableMixedSignalView()
 		// disconnect analog
 		for (int i = 0; i < nb_channels; ++i) {
 			iio->disconnect(block, i, mixed_sink, i);
-			iio->connect(block, i, qt_time_block, i);
+			iio->connect(block, i, sw_trigger_block, i);
+			iio->connect(sw_trigger_block, i, qt_time_block, i);
 		}
 
 		// disconnect digital
@@ -1669,11 +1702,11 @@ void Oscilloscope::activateAcCoupling(int i)
 	dynamic_pointer_cast<adc_sample_conv>(
 					adc_samp_conv_block);
 
-	iio->disconnect(block, i, qt_time_block, i);
+	iio->disconnect(block, i, sw_trigger_block, i);
 	iio->disconnect(adc_samp_conv_block, i, math_probe_atten.at(i), 0);
 
 	iio->connect(block, i, dc_cancel.at(i), 0);
-	iio->connect(dc_cancel.at(i), 0, qt_time_block, i);
+	iio->connect(dc_cancel.at(i), 0, sw_trigger_block, i);
 	iio->connect(dc_cancel.at(i), 0, math_probe_atten.at(i), 0);
 
 	iio->disconnect(block, i, qt_hist_block, i);
@@ -1713,29 +1746,15 @@ void Oscilloscope::activateAcCoupling(int i)
 	}
 
 	if (fft_is_visible) {
-		for (unsigned int i = 0; i < nb_channels; i++) {
-			iio->disconnect(fft_channels.at(i).first, fft_channels.at(i).second,
-					fft_blocks.at(i), 0);
-		}
-		fft_channels.clear();
-
-		for(unsigned int ch = 0; ch < nb_channels; ch++) {
-			if (chnAcCoupled.at(ch)) {
-				fft_channels.push_back(QPair<gr::basic_block_sptr, int>(
-							      dc_cancel.at(ch), 0));
-			} else {
-				fft_channels.push_back(QPair<gr::basic_block_sptr, int>(
-							      adc_samp_conv_block, ch));
-			}
-
-			iio->connect(fft_channels.at(ch).first, fft_channels.at(ch).second,
-				     fft_blocks.at(ch), 0);
-		}
+		fft_dc_cancel.at(i)->set_enabled(true);
 	}
 
 	for(int ch = 0; ch < nb_channels; ch++) {
 		iio->set_buffer_size(ids[ch], active_sample_count);
 		dc_cancel.at(ch)->set_buffer_size(active_sample_count);
+		if (fft_is_visible) {
+			fft_dc_cancel.at(ch)->set_buffer_size(active_sample_count);
+		}
 	}
 	if (mixed_source) {
 		mixed_source->set_buffer_size(active_sample_count);
@@ -1767,9 +1786,9 @@ void Oscilloscope::deactivateAcCoupling(int i)
 	iio->connect(adc_samp_conv_block, i, math_probe_atten.at(i), 0);
 
 	iio->disconnect(block, i, dc_cancel.at(i), 0);
-	iio->disconnect(dc_cancel.at(i), 0, qt_time_block, i);
+	iio->disconnect(dc_cancel.at(i), 0, sw_trigger_block, i);
 
-	iio->connect(block, i, qt_time_block, i);
+	iio->connect(block, i, sw_trigger_block, i);
 
 	iio->disconnect(dc_cancel.at(i), 0, qt_hist_block, i);
 	iio->connect(block, i, qt_hist_block, i);
@@ -1810,29 +1829,15 @@ void Oscilloscope::deactivateAcCoupling(int i)
 	}
 
 	if (fft_is_visible) {
-		for (unsigned int ch = 0; ch < nb_channels; ch++) {
-			iio->disconnect(fft_channels.at(ch).first, fft_channels.at(ch).second,
-					fft_blocks.at(ch), 0);
-		}
-		fft_channels.clear();
-
-		for(unsigned int ch = 0; ch < nb_channels; ch++) {
-			if (chnAcCoupled.at(ch) && ch != i) {
-				fft_channels.push_back(QPair<gr::basic_block_sptr, int>(
-							      dc_cancel.at(ch), 0));
-			} else {
-				fft_channels.push_back(QPair<gr::basic_block_sptr, int>(
-							      adc_samp_conv_block, ch));
-			}
-
-			iio->connect(fft_channels.at(ch).first, fft_channels.at(ch).second,
-				     fft_blocks.at(ch), 0);
-		}
+		fft_dc_cancel.at(i)->set_enabled(false);
 	}
 
 	for(int ch = 0; ch < nb_channels; ch++) {
 		iio->set_buffer_size(ids[ch], active_sample_count);
 		dc_cancel.at(ch)->set_buffer_size(active_sample_count);
+		if (fft_is_visible) {
+			fft_dc_cancel.at(ch)->set_buffer_size(active_sample_count);
+		}
 	}
 	if (mixed_source) {
 		mixed_source->set_buffer_size(active_sample_count);
@@ -2017,112 +2022,1101 @@ void Oscilloscope::toggleCursorsMode(bool toggled)
 		cursor_readouts_ui->VoltageCursors->setVisible(true);
 	}
 
-	cr_ui->btnLockVertical->setEnabled(toggled);
-	plot.trackModeEnabled(toggled);
+	cr_ui->btnLockVertical->setEnabled(toggled);
+	plot.trackModeEnabled(toggled);
+}
+
+void Oscilloscope::toolDetached(bool detached)
+{
+	if (detached) {
+		this->setMinimumSize(910, 490);
+		this->setSizePolicy(QSizePolicy::Preferred,
+				    QSizePolicy::Preferred);
+	} else {
+		this->setMinimumWidth(0);
+		this->setSizePolicy(QSizePolicy::MinimumExpanding,
+				    QSizePolicy::MinimumExpanding);
+	}
+}
+
+void Oscilloscope::pause(bool paused)
+{
+	if (ui->runSingleWidget->runButtonChecked()){
+		toggle_blockchain_flow(!paused);
+		trigger_settings.setAdcRunningState(!paused);
+	}
+}
+
+void Oscilloscope::export_settings_init()
+{
+
+	exportSettings = new ExportSettings();
+	exportSettings->enableExportButton(false);
+	gsettings_ui->export_2->addWidget(exportSettings);
+
+	for (int i = 0; i < nb_channels; ++i){
+		exportSettings->addChannel(i, QString("Channel") +
+					   QString::number(i + 1));
+	}
+
+	connect(exportSettings->getExportButton(), SIGNAL(clicked()), this,
+		SLOT(btnExport_clicked()));
+	connect(this, &Oscilloscope::activateExportButton,
+		[=](){
+		exportSettings->enableExportButton(true);
+	});
+}
+
+void Oscilloscope::btnExport_clicked(){
+
+	exportConfig = exportSettings->getExportConfig();
+	pause(true);
+	QStringList filter;
+	filter += QString(tr("Comma-separated values files (*.csv)"));
+	filter += QString(tr("Tab-delimited values files (*.txt)"));
+	filter += QString(tr("All Files(*)"));
+
+	QString selectedFilter = filter[0];
+
+	QString fileName = QFileDialog::getSaveFileName(this,
+	    tr("Export"), "", filter.join(";;"),
+	    &selectedFilter, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
+
+	if (fileName.split(".").size() <= 1) {
+		// file name w/o extension. Let's append it
+		QString ext = selectedFilter.split(".")[1].split(")")[0];
+		fileName += "." + ext;
+	}
+	bool atleastOneChannelEnabled = false;
+
+	auto keys = exportConfig.keys();
+	for (auto x : qAsConst(keys))
+		if (exportConfig[x]){
+			atleastOneChannelEnabled = true;
+			break;
+		}
+	if (!atleastOneChannelEnabled){
+		return;
+	}
+
+	if (!fileName.isEmpty()){
+		FileManager fm("Oscilloscope");
+		fm.open(fileName, FileManager::EXPORT);
+
+		int channels_number = nb_channels + nb_math_channels;
+		QVector<double> time_data;
+
+		for (int i = 0; i < plot.Curve(0)->data()->size(); ++i) {
+			time_data.push_back(plot.Curve(0)->sample(i).x());
+		}
+
+		fm.save(time_data, "Time(S)");
+
+		for (int i = 0; i < channels_number; ++i){
+			if (exportConfig[i]){
+				QVector<double> data;
+				int samples = plot.Curve(i)->data()->size();
+				for (int j = 0; j < samples; ++j)
+					data.push_back(plot.Curve(i)->data()->sample(j).y());
+				QString chNo = (i > 1) ? QString::number(i - 1) : QString::number(i + 1);
+
+				fm.save(data, ((i > 1) ? "M" : "CH") + chNo + "(V)");
+			}
+		}
+
+		fm.setSampleRate(active_sample_rate);
+		fm.performWrite();
+	}
+	pause(false);
+}
+
+/* Append a section to the general settings menu, below the X-Y
+ * settings, titled like the sections of the menu itself. Its content
+ * goes in the returned layout, from the second row on. */
+QGridLayout *Oscilloscope::addSettingsSection(const QString &title)
+{
+	QWidget *widget = new QWidget(this);
+	QGridLayout *layout = new QGridLayout(widget);
+	layout->setContentsMargins(0, 5, 0, 0);
+
+	QHBoxLayout *titleLayout = new QHBoxLayout();
+	titleLayout->setSpacing(0);
+
+	QLabel *label = new QLabel(title, widget);
+	label->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+	label->setProperty("subsection_label", true);
+	titleLayout->addWidget(label);
+
+	QFrame *line = new QFrame(widget);
+	line->setFrameShape(QFrame::HLine);
+	line->setFixedHeight(1);
+	line->setProperty("subsection_line", true);
+	titleLayout->addWidget(line);
+
+	layout->addLayout(titleLayout, 0, 0, 1, 2);
+	gsettings_ui->toolSections->addWidget(widget);
+
+	return layout;
+}
+
+void Oscilloscope::acquisition_settings_init()
+{
+	QGridLayout *layout = addSettingsSection(tr("ACQUISITION"));
+	QWidget *widget = layout->parentWidget();
+
+	acquisitionModeBox = new QComboBox(widget);
+	acquisitionModeBox->addItem(tr("Normal"), ACQ_MODE_NORMAL);
+	acquisitionModeBox->addItem(tr("Average"), ACQ_MODE_AVERAGE);
+	acquisitionModeBox->addItem(tr("Peak detect"), ACQ_MODE_PEAK_DETECT);
+	acquisitionModeBox->addItem(tr("High resolution"), ACQ_MODE_HIGH_RES);
+	layout->addWidget(acquisitionModeBox, 1, 0);
+
+	acquisitionFactorBox = new QSpinBox(widget);
+	acquisitionFactorBox->setRange(1, OSC_ACQ_MAX_FACTOR);
+	acquisitionFactorBox->setValue(OSC_ACQ_DEFAULT_FACTOR);
+	acquisitionFactorBox->setEnabled(false);
+	layout->addWidget(acquisitionFactorBox, 1, 1);
+
+	auto apply = [=]() {
+		auto mode = static_cast<acquisition_mode>(
+				acquisitionModeBox->currentData().toInt());
+
+		acquisitionFactorBox->setEnabled(mode != ACQ_MODE_NORMAL);
+		acquisitionFactorBox->setSuffix(mode == ACQ_MODE_AVERAGE ?
+				tr(" frames") : tr(" samples"));
+		qt_time_block->set_acquisition_mode(mode,
+				acquisitionFactorBox->value());
+	};
+
+	connect(acquisitionModeBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+		apply);
+	connect(acquisitionFactorBox, QOverload<int>::of(&QSpinBox::valueChanged),
+		apply);
+}
+
+void Oscilloscope::persistence_settings_init()
+{
+	QGridLayout *layout = addSettingsSection(tr("PERSISTENCE"));
+	QWidget *widget = layout->parentWidget();
+
+	persistenceEnableBox = new QCheckBox(tr("Enable"), widget);
+	layout->addWidget(persistenceEnableBox, 1, 0);
+
+	/* Weight kept by the older frames on every new frame */
+	persistenceDecayBox = new QComboBox(widget);
+	persistenceDecayBox->addItem(tr("Infinite"), 1.0);
+	persistenceDecayBox->addItem(tr("Long"), 0.98);
+	persistenceDecayBox->addItem(tr("Medium"), 0.9);
+	persistenceDecayBox->addItem(tr("Short"), 0.6);
+	persistenceDecayBox->setCurrentIndex(2);
+	layout->addWidget(persistenceDecayBox, 1, 1);
+
+	QPushButton *clearBtn = new QPushButton(tr("Clear"), widget);
+	clearBtn->setProperty("blue_button", true);
+	layout->addWidget(clearBtn, 2, 1);
+
+	connect(persistenceEnableBox, &QCheckBox::toggled, [=](bool en) {
+		plot.setPersistenceEnabled(en);
+		xy_plot.setPersistenceEnabled(en);
+
+		/* Grade every acquired frame, not only the plotted ones */
+		qt_time_block->set_persistence(en);
+		qt_xy_block->set_persistence(en);
+		for (auto it = math_sinks.constBegin();
+		     it != math_sinks.constEnd(); ++it) {
+			it.value()->set_persistence(en);
+		}
+	});
+	connect(persistenceDecayBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+		[=](int) {
+		double decay = persistenceDecayBox->currentData().toDouble();
+
+		plot.setPersistenceDecay(decay);
+		xy_plot.setPersistenceDecay(decay);
+	});
+	connect(clearBtn, &QPushButton::clicked, [=]() {
+		plot.clearPersistence();
+		xy_plot.clearPersistence();
+	});
+
+	plot.setPersistenceDecay(persistenceDecayBox->currentData().toDouble());
+	xy_plot.setPersistenceDecay(persistenceDecayBox->currentData().toDouble());
+}
+
+void Oscilloscope::mask_settings_init()
+{
+	maskTest = new MaskTest(nb_channels);
+	maskTest->setFailCallback([=]() {
+		QMetaObject::invokeMethod(this, "onMaskTestFailed",
+					  Qt::QueuedConnection);
+	});
+	setMaskTimeBase();
+	qt_time_block->set_mask_test(maskTest);
+
+	QGridLayout *layout = addSettingsSection(tr("MASK TEST"));
+	QWidget *widget = layout->parentWidget();
+
+	maskEnableBox = new QCheckBox(tr("Enable"), widget);
+	maskStopBox = new QCheckBox(tr("Stop on fail"), widget);
+	layout->addWidget(maskEnableBox, 1, 0);
+	layout->addWidget(maskStopBox, 1, 1);
+
+	layout->addWidget(new QLabel(tr("Tolerance"), widget), 2, 0);
+	maskToleranceBox = new QDoubleSpinBox(widget);
+	maskToleranceBox->setRange(0.0, 100.0);
+	maskToleranceBox->setDecimals(3);
+	maskToleranceBox->setSingleStep(0.01);
+	maskToleranceBox->setValue(OSC_MASK_DEFAULT_TOLERANCE);
+	maskToleranceBox->setSuffix(tr(" V"));
+	layout->addWidget(maskToleranceBox, 2, 1);
+
+	QPushButton *fromTraceBtn = new QPushButton(tr("From trace"), widget);
+	QPushButton *loadBtn = new QPushButton(tr("Load mask"), widget);
+	fromTraceBtn->setProperty("blue_button", true);
+	loadBtn->setProperty("blue_button", true);
+	layout->addWidget(fromTraceBtn, 3, 0);
+	layout->addWidget(loadBtn, 3, 1);
+
+	maskStatusLabel = new QLabel(widget);
+	QPushButton *resetBtn = new QPushButton(tr("Reset"), widget);
+	resetBtn->setProperty("blue_button", true);
+	layout->addWidget(maskStatusLabel, 4, 0);
+	layout->addWidget(resetBtn, 4, 1);
+
+	connect(maskEnableBox, &QCheckBox::toggled, [=](bool en) {
+		maskTest->setEnabled(en);
+		updateMaskStatus();
+	});
+	connect(maskStopBox, &QCheckBox::toggled, [=](bool en) {
+		maskTest->setStopOnFail(en);
+	});
+	connect(resetBtn, &QPushButton::clicked, [=]() {
+		maskTest->resetCounters();
+		updateMaskStatus();
+	});
+	connect(fromTraceBtn, SIGNAL(clicked()), SLOT(btnMaskFromTrace_clicked()));
+	connect(loadBtn, SIGNAL(clicked()), SLOT(btnMaskLoad_clicked()));
+
+	updateMaskStatus();
+}
+
+/* Same sample positions as the ones of the time plot */
+void Oscilloscope::setMaskTimeBase()
+{
+	if (!maskTest || active_sample_rate <= 0) {
+		return;
+	}
+
+	maskTest->setTimeBase(active_trig_sample_count / active_sample_rate,
+			      1.0 / active_sample_rate);
+}
+
+void Oscilloscope::btnMaskFromTrace_clicked()
+{
+	const int chn = current_ch_widget;
+
+	if (chn < 0 || chn >= (int)nb_channels) {
+		return;
+	}
+
+	const double *y = plot.channelData(chn);
+	const size_t nb_samples = plot.Curve(chn)->data()->size();
+
+	if (!y || !nb_samples) {
+		return;
+	}
+
+	std::vector<double> x(nb_samples);
+	for (size_t i = 0; i < nb_samples; i++) {
+		x[i] = plot.Curve(chn)->sample(i).x();
+	}
+
+	/* Allow for one sample of jitter around the reference */
+	maskTest->setReference(chn, x.data(), y, nb_samples,
+			       1.0 / active_sample_rate,
+			       maskToleranceBox->value());
+	maskTest->resetCounters();
+	plot.setMaskRegions(chn, maskTest->regions(chn));
+	updateMaskStatus();
+}
+
+/* Text file with one "x,y" point per line. Regions are separated by an
+ * empty line and lines starting with '#' are ignored. The mask applies
+ * to the selected channel. */
+void Oscilloscope::btnMaskLoad_clicked()
+{
+	const int chn = current_ch_widget;
+
+	if (chn < 0 || chn >= (int)nb_channels) {
+		return;
+	}
+
+	QString fileName = QFileDialog::getOpenFileName(this,
+		tr("Load mask"), "", tr("Mask files (*.csv *.txt);;All Files(*)"),
+		nullptr, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
+	if (fileName.isEmpty()) {
+		return;
+	}
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return;
+	}
+
+	QVector<QPolygonF> regions;
+	QPolygonF region;
+	QTextStream in(&file);
+
+	while (!in.atEnd()) {
+		QString line = in.readLine().trimmed();
+
+		if (line.startsWith('#')) {
+			continue;
+		}
+
+		if (line.isEmpty()) {
+			if (region.size() > 2) {
+				regions.append(region);
+			}
+			region.clear();
+			continue;
+		}
+
+		QStringList values = line.split(QRegExp("[,;\\s]+"));
+		bool okx = false, oky = false;
+
+		if (values.size() >= 2) {
+			double x = values[0].toDouble(&okx);
+			double y = values[1].toDouble(&oky);
+
+			if (okx && oky) {
+				region.append(QPointF(x, y));
+			}
+		}
+	}
+
+	if (region.size() > 2) {
+		regions.append(region);
+	}
+
+	maskTest->setRegions(chn, regions);
+	maskTest->resetCounters();
+	plot.setMaskRegions(chn, regions);
+	updateMaskStatus();
+}
+
+void Oscilloscope::onMaskTestFailed()
+{
+	updateMaskStatus();
+
+	if (maskTest->halted() && ui->runSingleWidget->runButtonChecked()) {
+		ui->runSingleWidget->toggle(false);
+	}
+}
+
+void Oscilloscope::updateMaskStatus()
+{
+	if (!maskTest->enabled()) {
+		maskStatusLabel->setText(tr("Disabled"));
+		return;
+	}
+
+	maskStatusLabel->setText(tr("Failed %1 / %2")
+				 .arg(maskTest->failedFrames())
+				 .arg(maskTest->testedFrames()));
+}
+
+void Oscilloscope::recorder_settings_init()
+{
+	recorder = new StreamRecorder(this);
+	recorderTimer = new QTimer(this);
+	recorderTimer->setInterval(OSC_RECORDER_STATUS_MS);
+
+	QGridLayout *layout = addSettingsSection(tr("RECORDER"));
+	QWidget *widget = layout->parentWidget();
+
+	recordBtn = new QPushButton(tr("Record to file"), widget);
+	recordBtn->setCheckable(true);
+	recordBtn->setProperty("blue_button", true);
+	layout->addWidget(recordBtn, 1, 0);
+
+	recorderStatusLabel = new QLabel(widget);
+	layout->addWidget(recorderStatusLabel, 1, 1);
+
+	playbackBtn = new QPushButton(tr("Play recording"), widget);
+	playbackBtn->setCheckable(true);
+	playbackBtn->setProperty("blue_button", true);
+	layout->addWidget(playbackBtn, 2, 0);
+
+	playbackSpeedBox = new QComboBox(widget);
+	for (double speed : { 0.01, 0.1, 0.5, 1.0, 2.0, 10.0 }) {
+		playbackSpeedBox->addItem(QString("%1x").arg(speed), speed);
+	}
+	playbackSpeedBox->setCurrentIndex(3);
+	layout->addWidget(playbackSpeedBox, 2, 1);
+
+	connect(recordBtn, SIGNAL(toggled(bool)), SLOT(btnRecord_toggled(bool)));
+	connect(playbackBtn, SIGNAL(toggled(bool)), SLOT(btnPlayback_toggled(bool)));
+	connect(recorderTimer, SIGNAL(timeout()), SLOT(updateRecorderStatus()));
+	/* Queued, as it is emitted with the lock of the manager held */
+	connect(&*iio, SIGNAL(restarted()), this, SLOT(onIioRestarted()),
+		Qt::QueuedConnection);
+	connect(playbackSpeedBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+		[=](int) {
+		if (playback_source) {
+			playback_source->set_speed(
+				playbackSpeedBox->currentData().toDouble());
+		}
+	});
+}
+
+void Oscilloscope::sw_trigger_settings_init()
+{
+	swTriggerTimer = new QTimer(this);
+	swTriggerTimer->setInterval(OSC_SW_TRIGGER_RATE_MS);
+	sw_trigger_last_count = 0;
+
+	QGridLayout *layout = addSettingsSection(tr("SOFTWARE TRIGGER"));
+	QWidget *widget = layout->parentWidget();
+
+	swTriggerTypeBox = new QComboBox(widget);
+	swTriggerTypeBox->addItem(tr("Off"), software_trigger_block::TRIGGER_OFF);
+	swTriggerTypeBox->addItem(tr("Edge"), software_trigger_block::TRIGGER_EDGE);
+	swTriggerTypeBox->addItem(tr("Pulse width"), software_trigger_block::TRIGGER_PULSE_WIDTH);
+	swTriggerTypeBox->addItem(tr("Runt"), software_trigger_block::TRIGGER_RUNT);
+	swTriggerTypeBox->addItem(tr("Window"), software_trigger_block::TRIGGER_WINDOW);
+	swTriggerTypeBox->addItem(tr("Timeout"), software_trigger_block::TRIGGER_TIMEOUT);
+	swTriggerTypeBox->addItem(tr("Slew rate"), software_trigger_block::TRIGGER_SLEW_RATE);
+	swTriggerTypeBox->addItem(tr("Nth edge"), software_trigger_block::TRIGGER_NTH_EDGE);
+	layout->addWidget(new QLabel(tr("Type"), widget), 1, 0);
+	layout->addWidget(swTriggerTypeBox, 1, 1);
+
+	swTriggerSourceBox = new QComboBox(widget);
+	for (unsigned int i = 0; i < nb_channels; i++) {
+		swTriggerSourceBox->addItem(tr("Channel %1").arg(i + 1));
+	}
+	layout->addWidget(new QLabel(tr("Source"), widget), 2, 0);
+	layout->addWidget(swTriggerSourceBox, 2, 1);
+
+	/* Slope of the edges, polarity of the pulses, entering or
+	 * leaving the window, staying high or low for the timeout */
+	swTriggerPolarityBox = new QComboBox(widget);
+	swTriggerPolarityBox->addItem(tr("Positive"));
+	swTriggerPolarityBox->addItem(tr("Negative"));
+	layout->addWidget(new QLabel(tr("Polarity"), widget), 3, 0);
+	layout->addWidget(swTriggerPolarityBox, 3, 1);
+
+	auto makeBox = [=](double min, double max, double value,
+			   const QString &suffix) {
+		QDoubleSpinBox *box = new QDoubleSpinBox(widget);
+		box->setRange(min, max);
+		box->setDecimals(3);
+		box->setValue(value);
+		box->setSuffix(suffix);
+		return box;
+	};
+
+	swTriggerLevelABox = makeBox(-25.0, 25.0, 0.0, tr(" V"));
+	swTriggerLevelBBox = makeBox(-25.0, 25.0, 1.0, tr(" V"));
+	swTriggerHystBox = makeBox(0.0, 5.0, 0.05, tr(" V"));
+	swTriggerMinBox = makeBox(0.0, 1e6, 0.0, tr(" µs"));
+	swTriggerMaxBox = makeBox(0.0, 1e6, 0.0, tr(" µs"));
+	swTriggerHoldoffBox = makeBox(0.0, 1e6, 0.0, tr(" µs"));
+	swTriggerMaxBox->setSpecialValueText(tr("No limit"));
+	swTriggerLevelBBox->setToolTip(tr("Upper level of the runt, window "
+					  "and slew rate triggers"));
+	swTriggerMinBox->setToolTip(tr("Minimum width, transition time or timeout"));
+
+	swTriggerCountBox = new QSpinBox(widget);
+	swTriggerCountBox->setRange(1, 1000000);
+
+	layout->addWidget(new QLabel(tr("Level"), widget), 4, 0);
+	layout->addWidget(swTriggerLevelABox, 4, 1);
+	layout->addWidget(new QLabel(tr("Upper level"), widget), 5, 0);
+	layout->addWidget(swTriggerLevelBBox, 5, 1);
+	layout->addWidget(new QLabel(tr("Hysteresis"), widget), 6, 0);
+	layout->addWidget(swTriggerHystBox, 6, 1);
+	layout->addWidget(new QLabel(tr("Min time"), widget), 7, 0);
+	layout->addWidget(swTriggerMinBox, 7, 1);
+	layout->addWidget(new QLabel(tr("Max time"), widget), 8, 0);
+	layout->addWidget(swTriggerMaxBox, 8, 1);
+	layout->addWidget(new QLabel(tr("Edge count"), widget), 9, 0);
+	layout->addWidget(swTriggerCountBox, 9, 1);
+	layout->addWidget(new QLabel(tr("Holdoff"), widget), 10, 0);
+	layout->addWidget(swTriggerHoldoffBox, 10, 1);
+
+	swTriggerRateLabel = new QLabel(widget);
+	layout->addWidget(swTriggerRateLabel, 11, 0, 1, 2);
+
+	connect(swTriggerTypeBox, SIGNAL(currentIndexChanged(int)),
+		SLOT(updateSoftwareTrigger()));
+	connect(swTriggerSourceBox, SIGNAL(currentIndexChanged(int)),
+		SLOT(updateSoftwareTrigger()));
+	connect(swTriggerPolarityBox, SIGNAL(currentIndexChanged(int)),
+		SLOT(updateSoftwareTrigger()));
+	for (QDoubleSpinBox *box : { swTriggerLevelABox, swTriggerLevelBBox,
+			swTriggerHystBox, swTriggerMinBox, swTriggerMaxBox,
+			swTriggerHoldoffBox }) {
+		connect(box, SIGNAL(valueChanged(double)),
+			SLOT(updateSoftwareTrigger()));
+	}
+	connect(swTriggerCountBox, SIGNAL(valueChanged(int)),
+		SLOT(updateSoftwareTrigger()));
+	connect(swTriggerTimer, SIGNAL(timeout()),
+		SLOT(updateSoftwareTriggerRate()));
+
+	updateSoftwareTrigger();
+}
+
+/* When a software trigger is selected the hardware acquires continuously
+ * and the time sink aligns its frames on the tags of the trigger block.
+ * The block delays the samples by the pretrigger part of the buffer so
+ * the trigger lands at the same position as a hardware one. */
+void Oscilloscope::updateSoftwareTrigger()
+{
+	if (!swTriggerTypeBox) {
+		return;
+	}
+
+	auto samples = [=](double us) {
+		return (uint64_t)qRound64(us * 1e-6 * active_sample_rate);
+	};
+
+	software_trigger_block::config cfg;
+	cfg.type = (software_trigger_block::trigger_type)
+			swTriggerTypeBox->currentData().toInt();
+	cfg.channel = swTriggerSourceBox->currentIndex();
+	cfg.rising = swTriggerPolarityBox->currentIndex() == 0;
+	cfg.level_a = swTriggerLevelABox->value();
+	cfg.level_b = swTriggerLevelBBox->value();
+	cfg.hysteresis = swTriggerHystBox->value();
+	cfg.min_samples = samples(swTriggerMinBox->value());
+	cfg.max_samples = samples(swTriggerMaxBox->value());
+	cfg.count = swTriggerCountBox->value();
+	cfg.holdoff = samples(swTriggerHoldoffBox->value());
+
+	const bool en = cfg.type != software_trigger_block::TRIGGER_OFF;
+
+	/* Without a software trigger the block must not delay the samples,
+	 * or they would move away from the hardware buffer_start tags */
+	long long pretrigger = 0;
+	if (en) {
+		pretrigger = std::min<long long>(-active_trig_sample_count,
+				qt_time_block->nsamps());
+	}
+	sw_trigger_block->set_pretrigger(std::max(pretrigger, 0LL));
+	sw_trigger_block->set_config(cfg);
+
+	if (en) {
+		qt_time_block->set_trigger_mode(TRIG_MODE_TAG, cfg.channel,
+						"sw_trigger");
+	}
+
+	if (en == sw_trigger_en) {
+		return;
+	}
+
+	sw_trigger_en = en;
+
+	if (en) {
+		sw_trigger_hw_en = trigger_settings.analogEnabled();
+		trigger_settings.setTriggerEnable(false);
+		sw_trigger_last_count = sw_trigger_block->trigger_count();
+		swTriggerTimer->start();
+	} else {
+		qt_time_block->set_trigger_mode(TRIG_MODE_TAG, 0, "buffer_start");
+		trigger_settings.setTriggerEnable(sw_trigger_hw_en);
+		swTriggerTimer->stop();
+	}
+
+	updateSoftwareTriggerRate();
+}
+
+void Oscilloscope::updateSoftwareTriggerRate()
+{
+	if (!sw_trigger_en) {
+		swTriggerRateLabel->clear();
+		return;
+	}
+
+	const uint64_t count = sw_trigger_block->trigger_count();
+	const double rate = (count - sw_trigger_last_count) * 1000.0 /
+			OSC_SW_TRIGGER_RATE_MS;
+	sw_trigger_last_count = count;
+
+	swTriggerRateLabel->setText(tr("%1 triggers/s, %2 total")
+				    .arg(rate, 0, 'g', 4).arg(count));
+}
+
+/* The raw samples are recorded as they come from the hardware, after
+ * the frequency compensation filters. A recording holds one gapless
+ * stream at one sample rate: the acquisition is forced continuous and
+ * untriggered while recording, and the recording is stopped when the
+ * flowgraph restarts or the sample rate changes. */
+void Oscilloscope::btnRecord_toggled(bool checked)
+{
+	if (!checked) {
+		recorder->stop();
+		trigger_settings.setContinuousAcquisition(false);
+		try {
+			m_m2k_analogin->getTrigger()->setAnalogStreamingFlag(
+						!d_displayOneBuffer);
+		} catch (libm2k::m2k_exception &e) {
+			HANDLE_EXCEPTION(e)
+			qDebug(CAT_OSCILLOSCOPE) << e.what();
+		}
+		updateRecorderStatus();
+		if (!playbackBtn->isChecked()) {
+			recorderTimer->stop();
+		}
+		return;
+	}
+
+	QString fileName = QFileDialog::getSaveFileName(this,
+		tr("Record to file"), "", tr("Scopy recordings (*.bin);;All Files(*)"),
+		nullptr, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
+
+	auto conv = boost::dynamic_pointer_cast<adc_sample_conv>(
+				adc_samp_conv_block);
+	std::vector<double> scale, offset;
+
+	for (unsigned int i = 0; conv && i < nb_channels; i++) {
+		const double zero = conv->conversionWrapper(i, 0, true);
+
+		offset.push_back(zero);
+		scale.push_back(conv->conversionWrapper(i, 1, true) - zero);
+	}
+
+	if (fileName.isEmpty()) {
+		QSignalBlocker blocker(recordBtn);
+		recordBtn->setChecked(false);
+		return;
+	}
+
+	trigger_settings.setContinuousAcquisition(true);
+	try {
+		m_m2k_analogin->getTrigger()->setAnalogStreamingFlag(true);
+	} catch (libm2k::m2k_exception &e) {
+		HANDLE_EXCEPTION(e)
+		qDebug(CAT_OSCILLOSCOPE) << e.what();
+	}
+
+	recorderStopReason.clear();
+	if (!recorder->start(iio, nb_channels, fileName, active_sample_rate,
+			scale, offset)) {
+		recordBtn->setChecked(false);
+		return;
+	}
+
+	recorderTimer->start();
+	updateRecorderStatus();
+}
+
+void Oscilloscope::stopRecording(const QString &reason)
+{
+	if (!recorder || !recorder->isRecording()) {
+		return;
+	}
+
+	recorderStopReason = reason;
+	recordBtn->setChecked(false);
+}
+
+void Oscilloscope::onIioRestarted()
+{
+	stopRecording(tr("acquisition restarted"));
+}
+
+/* A recording is fed to a scope sink of its own, registered under the
+ * name of the time sink, so it goes through the same plotting path as
+ * the live data */
+void Oscilloscope::btnPlayback_toggled(bool checked)
+{
+	if (!checked) {
+		stopPlayback();
+		return;
+	}
+
+	if (ui->runSingleWidget->runButtonChecked()) {
+		ui->runSingleWidget->toggle(false);
+	}
+
+	QString fileName = QFileDialog::getOpenFileName(this,
+		tr("Play recording"), "", tr("Scopy recordings (*.bin);;All Files(*)"),
+		nullptr, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
+
+	recording_source::sptr source;
+	if (!fileName.isEmpty()) {
+		source = recording_source::make(fileName);
+	}
+
+	if (!source || !source->is_valid() ||
+			source->get_header().nb_channels != nb_channels) {
+		QSignalBlocker blocker(playbackBtn);
+		playbackBtn->setChecked(false);
+		return;
+	}
+
+	const double sample_rate = source->get_header().sample_rate;
+	int nb_samples = qt_time_block->nsamps();
+	if (nb_samples <= 0) {
+		nb_samples = active_plot_sample_count;
+	}
+
+	playback_source = source;
+	playback_source->set_speed(playbackSpeedBox->currentData().toDouble());
+
+	playback_sink = scope_sink_f::make(nb_samples, sample_rate,
+			qt_time_block->name(), nb_channels, (QObject *)&plot);
+	playback_sink->set_trigger_mode(TRIG_MODE_FREE, 0);
+	playback_sink->set_update_time(1.0 /
+			getScopyPreferences()->getTarget_fps());
+
+	plot.setDataStartingPoint(0);
+	plot.resetXaxisOnNextReceivedData();
+
+	playback_top_block = gr::make_top_block("Osc playback");
+	for (unsigned int i = 0; i < nb_channels; i++) {
+		playback_top_block->connect(playback_source, i, playback_sink, i);
+	}
+	playback_top_block->start();
+
+	recorderTimer->start();
+	updateRecorderStatus();
+}
+
+void Oscilloscope::stopPlayback()
+{
+	if (!playback_top_block) {
+		return;
+	}
+
+	playback_top_block->stop();
+	playback_top_block->wait();
+	playback_top_block.reset();
+	playback_sink.reset();
+	playback_source.reset();
+
+	plot.setSampleRate(active_sample_rate, 1, "");
+	plot.setDataStartingPoint(active_trig_sample_count);
+	plot.resetXaxisOnNextReceivedData();
+
+	if (!recorder->isRecording()) {
+		recorderTimer->stop();
+	}
+	updateRecorderStatus();
+}
+
+void Oscilloscope::updateRecorderStatus()
+{
+	if (playback_source) {
+		const recording_header &header = playback_source->get_header();
+		const uint64_t pos = playback_source->position();
+
+		recorderStatusLabel->setText(tr("Played %1 / %2 s")
+			.arg(pos / header.sample_rate, 0, 'f', 1)
+			.arg(header.nb_samples / header.sample_rate, 0, 'f', 1));
+
+		if (pos >= header.nb_samples) {
+			playbackBtn->setChecked(false);
+		}
+		return;
+	}
+
+	if (recorder->failed()) {
+		recorderStatusLabel->setText(tr("Write error"));
+		return;
+	}
+
+	if (recorder->isRecording() || recorder->samplesWritten()) {
+		QString status = tr("%1 s, %2 overruns")
+			.arg(recorder->samplesWritten() / recorder->sampleRate(),
+			     0, 'f', 1)
+			.arg(recorder->overruns());
+
+		if (!recorderStopReason.isEmpty()) {
+			status += tr(", stopped: %1").arg(recorderStopReason);
+		}
+		recorderStatusLabel->setText(status);
+	} else {
+		recorderStatusLabel->clear();
+	}
+}
+
+void Oscilloscope::history_settings_init()
+{
+	history = new AcquisitionHistory(nb_channels, OSC_HISTORY_DEFAULT_SIZE,
+					 OSC_HISTORY_MAX_BYTES);
+	updateHistoryInfo();
+
+	QGridLayout *layout = addSettingsSection(tr("HISTORY"));
+	QWidget *widget = layout->parentWidget();
+
+	historyEnableBox = new QCheckBox(tr("Keep captures"), widget);
+	layout->addWidget(historyEnableBox, 1, 0);
+
+	historySizeBox = new QSpinBox(widget);
+	historySizeBox->setRange(1, OSC_HISTORY_MAX_SIZE);
+	historySizeBox->setValue(OSC_HISTORY_DEFAULT_SIZE);
+	historySizeBox->setSuffix(tr(" segments"));
+	layout->addWidget(historySizeBox, 1, 1);
+
+	layout->addWidget(new QLabel(tr("Segment"), widget), 2, 0);
+	historyIndexBox = new QSpinBox(widget);
+	historyIndexBox->setRange(1, 1);
+	historyIndexBox->setEnabled(false);
+	layout->addWidget(historyIndexBox, 2, 1);
+
+	historyOverlayBox = new QCheckBox(tr("Overlay segments"), widget);
+	layout->addWidget(historyOverlayBox, 3, 0, 1, 2);
+
+	QPushButton *exportBtn = new QPushButton(tr("Export history"), widget);
+	QPushButton *measureBtn = new QPushButton(tr("Measure all"), widget);
+	exportBtn->setProperty("blue_button", true);
+	measureBtn->setProperty("blue_button", true);
+	layout->addWidget(exportBtn, 4, 0);
+	layout->addWidget(measureBtn, 4, 1);
+
+	connect(historyEnableBox, &QCheckBox::toggled, [=](bool en) {
+		historyRecording = en;
+		if (!en) {
+			{
+				std::unique_lock<std::mutex> lock(historyMutex);
+				history->clear();
+			}
+			historyOverlayBox->setChecked(false);
+			historyIndexBox->setEnabled(false);
+		}
+	});
+	connect(historySizeBox, QOverload<int>::of(&QSpinBox::valueChanged),
+		[=](int size) {
+		plot.clearSegmentOverlay();
+		{
+			std::unique_lock<std::mutex> lock(historyMutex);
+			history->setCapacity(size);
+		}
+		updateHistoryOverlay();
+	});
+	connect(historyIndexBox, SIGNAL(valueChanged(int)),
+		SLOT(onHistoryIndexChanged(int)));
+	connect(historyOverlayBox, SIGNAL(toggled(bool)),
+		SLOT(updateHistoryOverlay()));
+	connect(exportBtn, SIGNAL(clicked()), SLOT(btnHistoryExport_clicked()));
+	connect(measureBtn, SIGNAL(clicked()), SLOT(btnHistoryMeasure_clicked()));
+}
+
+void Oscilloscope::timeFrameReceived(const std::vector<const float *> &frames,
+				     int nitems)
+{
+	if (!historyRecording) {
+		return;
+	}
+
+	/* Never wait for the GUI thread; it only holds the lock for long
+	 * while exporting, and the captures of that time are dropped */
+	std::unique_lock<std::mutex> lock(historyMutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		return;
+	}
+
+	AcquisitionSegment info = historyInfo;
+	info.timestamp = QDateTime::currentMSecsSinceEpoch();
+	info.triggered = historyInfo.triggered && !trigger_is_forced;
+	info.nb_samples = nitems;
+
+	/* The capture length changed: the GUI thread reallocates the
+	 * history, as the overlay plots straight from it */
+	if (!history->push(frames, info)) {
+		historyLength = nitems;
+	}
+
+	const bool schedule = !historyUpdateQueued;
+	historyUpdateQueued = true;
+	lock.unlock();
+
+	if (schedule) {
+		QMetaObject::invokeMethod(this, "onHistoryUpdated",
+					  Qt::QueuedConnection);
+	}
+}
+
+void Oscilloscope::onHistoryUpdated()
+{
+	std::unique_lock<std::mutex> lock(historyMutex);
+	historyUpdateQueued = false;
+
+	const bool resize = historyLength &&
+			historyLength != history->samplesPerSegment();
+	const unsigned int prev_size = history->size();
+
+	if (resize) {
+		lock.unlock();
+		plot.clearSegmentOverlay();
+		lock.lock();
+		history->setSamplesPerSegment(historyLength);
+	}
+
+	const bool grown = prev_size != history->size();
+	lock.unlock();
+
+	// The ring was reallocated or has new segments to draw
+	if (historyOverlayBox->isChecked() && (resize || grown)) {
+		updateHistoryOverlay();
+	}
+}
+
+/* Trigger state stamped on the following captures */
+void Oscilloscope::updateHistoryInfo()
+{
+	std::unique_lock<std::mutex> lock(historyMutex);
+
+	historyInfo.triggered = trigger_settings.triggerIsArmed();
+	historyInfo.trigger_source = trigger_settings.currentChannel();
+	historyInfo.trigger_level = trigger_settings.level();
+	historyInfo.sample_rate = active_sample_rate;
+}
+
+void Oscilloscope::onHistoryIndexChanged(int index)
+{
+	std::unique_lock<std::mutex> lock(historyMutex);
+
+	if (m_running || index < 1 || (unsigned int)index > history->size()) {
+		return;
+	}
+
+	plot.showSegment(history->segmentData(index - 1),
+			 history->samplesPerSegment());
 }
 
-void Oscilloscope::toolDetached(bool detached)
+void Oscilloscope::updateHistoryOverlay()
 {
-	if (detached) {
-		this->setMinimumSize(910, 490);
-		this->setSizePolicy(QSizePolicy::Preferred,
-				    QSizePolicy::Preferred);
-	} else {
-		this->setMinimumWidth(0);
-		this->setSizePolicy(QSizePolicy::MinimumExpanding,
-				    QSizePolicy::MinimumExpanding);
+	std::unique_lock<std::mutex> lock(historyMutex);
+
+	if (!historyOverlayBox->isChecked() || !history->size()) {
+		lock.unlock();
+		plot.clearSegmentOverlay();
+		return;
 	}
-}
 
-void Oscilloscope::pause(bool paused)
-{
-	if (ui->runSingleWidget->runButtonChecked()){
-		toggle_blockchain_flow(!paused);
-		trigger_settings.setAdcRunningState(!paused);
+	int chIdx = std::max(0, std::min(current_ch_widget, (int)nb_channels - 1));
+	std::vector<const double *> data;
+
+	for (unsigned int i = 0; i < history->size(); i++) {
+		data.push_back(history->data(i, chIdx));
 	}
+
+	const size_t nb_samples = history->samplesPerSegment();
+	lock.unlock();
+
+	/* The segments stay where they are until the GUI thread
+	 * reallocates the history, which clears the overlay first */
+	plot.setSegmentOverlay(data, nb_samples, chIdx);
 }
 
-void Oscilloscope::export_settings_init()
+void Oscilloscope::btnHistoryExport_clicked()
 {
+	if (!history->size()) {
+		return;
+	}
 
-	exportSettings = new ExportSettings();
-	exportSettings->enableExportButton(false);
-	gsettings_ui->export_2->addWidget(exportSettings);
+	QString selectedFilter;
+	QString fileName = QFileDialog::getSaveFileName(this,
+	    tr("Export history"), "",
+	    tr("Comma-separated values files (*.csv)"), &selectedFilter,
+	    (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
 
-	for (int i = 0; i < nb_channels; ++i){
-		exportSettings->addChannel(i, QString("Channel") +
-					   QString::number(i + 1));
+	if (fileName.isEmpty()) {
+		return;
 	}
 
-	connect(exportSettings->getExportButton(), SIGNAL(clicked()), this,
-		SLOT(btnExport_clicked()));
-	connect(this, &Oscilloscope::activateExportButton,
-		[=](){
-		exportSettings->enableExportButton(true);
-	});
-}
-
-void Oscilloscope::btnExport_clicked(){
+	if (fileName.split(".").size() <= 1) {
+		fileName += ".csv";
+	}
 
-	exportConfig = exportSettings->getExportConfig();
-	pause(true);
-	QStringList filter;
-	filter += QString(tr("Comma-separated values files (*.csv)"));
-	filter += QString(tr("Tab-delimited values files (*.txt)"));
-	filter += QString(tr("All Files(*)"));
+	std::unique_lock<std::mutex> lock(historyMutex);
+	history->exportToFile(fileName, "Oscilloscope");
+}
 
-	QString selectedFilter = filter[0];
+void Oscilloscope::btnHistoryMeasure_clicked()
+{
+	if (!history->size()) {
+		return;
+	}
 
+	QString selectedFilter;
 	QString fileName = QFileDialog::getSaveFileName(this,
-	    tr("Export"), "", filter.join(";;"),
-	    &selectedFilter, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
+	    tr("Save segment measurements"), "",
+	    tr("Comma-separated values files (*.csv)"), &selectedFilter,
+	    (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
+
+	if (fileName.isEmpty()) {
+		return;
+	}
 
 	if (fileName.split(".").size() <= 1) {
-		// file name w/o extension. Let's append it
-		QString ext = selectedFilter.split(".")[1].split(")")[0];
-		fileName += "." + ext;
+		fileName += ".csv";
 	}
-	bool atleastOneChannelEnabled = false;
 
-	auto keys = exportConfig.keys();
-	for (auto x : qAsConst(keys))
-		if (exportConfig[x]){
-			atleastOneChannelEnabled = true;
-			break;
-		}
-	if (!atleastOneChannelEnabled){
+	std::unique_lock<std::mutex> lock(historyMutex);
+	if (!history->size()) {
 		return;
 	}
 
-	if (!fileName.isEmpty()){
-		FileManager fm("Oscilloscope");
-		fm.open(fileName, FileManager::EXPORT);
+	// One pass over every segment, with a measurement object per
+	// channel configured like the one of the plot
+	const size_t nb_samples = history->samplesPerSegment();
+	QVector<QVector<double>> columns;
+	QStringList names;
+	QVector<double> time_data;
 
-		int channels_number = nb_channels + nb_math_channels;
-		QVector<double> time_data;
+	const qint64 t0 = history->segment(0).timestamp;
+	for (unsigned int s = 0; s < history->size(); s++) {
+		time_data.push_back((history->segment(s).timestamp - t0) / 1000.0);
+	}
 
-		for (int i = 0; i < plot.Curve(0)->data()->size(); ++i) {
-			time_data.push_back(plot.Curve(0)->sample(i).x());
-		}
+	QList<Measure *> *plot_measures = plot.getMeasurements();
 
-		fm.save(time_data, "Time(S)");
+	for (unsigned int ch = 0; ch < nb_channels; ch++) {
+		Measure measure(ch);
+		for (Measure *m : qAsConst(*plot_measures)) {
+			if (m->channel() == (int)ch) {
+				measure.setAdcBitCount(m->adcBitCount());
+				measure.setCrossLevel(m->crossLevel());
+				measure.setHysteresisSpan(m->hysteresisSpan());
+				break;
+			}
+		}
 
-		for (int i = 0; i < channels_number; ++i){
-			if (exportConfig[i]){
-				QVector<double> data;
-				int samples = plot.Curve(i)->data()->size();
-				for (int j = 0; j < samples; ++j)
-					data.push_back(plot.Curve(i)->data()->sample(j).y());
-				QString chNo = (i > 1) ? QString::number(i - 1) : QString::number(i + 1);
+		int first_column = columns.size();
+		for (unsigned int s = 0; s < history->size(); s++) {
+			measure.setSampleRate(history->segment(s).sample_rate);
+			measure.setDataSource(const_cast<double *>(history->data(s, ch)),
+					      nb_samples);
+			measure.measure();
+
+			auto results = measure.measurments();
+			if (s == 0) {
+				for (const auto &result : qAsConst(results)) {
+					names.push_back(QString("CH%1 %2").arg(ch + 1)
+							.arg(result->name()));
+					columns.push_back(QVector<double>());
+				}
+			}
 
-				fm.save(data, ((i > 1) ? "M" : "CH") + chNo + "(V)");
+			for (int m = 0; m < results.size(); m++) {
+				columns[first_column + m].push_back(results[m]->value());
 			}
 		}
+	}
 
-		fm.setSampleRate(active_sample_rate);
-		fm.performWrite();
+	FileManager fm("Oscilloscope");
+	fm.open(fileName, FileManager::EXPORT);
+	fm.save(time_data, "Time(S)");
+	for (int i = 0; i < columns.size(); i++) {
+		fm.save(columns[i], names[i]);
 	}
-	pause(false);
+	fm.setSampleRate(history->segment(0).sample_rate);
+	fm.performWrite();
 }
 
 void Oscilloscope::create_add_channel_panel()
@@ -2466,8 +3460,9 @@ void Oscilloscope::add_math_channel(const std::string& function)
 		return;
 	}
 
-	auto rail = gr::analog::rail_ff::make(MIN_MATH_RANGE, MAX_MATH_RANGE);
-	auto math = gr::scopy::iio_math::make(function, nb_channels);
+	/* Throws if the function is invalid, before anything changes */
+	math_expression(function, nb_channels);
+
 	unsigned int curve_id = nb_channels + nb_math_channels + nb_ref_channels;
 	unsigned int curve_number = find_curve_number();
 
@@ -2481,14 +3476,10 @@ void Oscilloscope::add_math_channel(const std::string& function)
 			noZoomXAxisWidth * getSampleRate() / m_m2k_analogin->getOversamplingRatio(),
 			getSampleRate() / m_m2k_analogin->getOversamplingRatio(), name, 1, (QObject *)&plot);
 
-	double targetFps = getScopyPreferences()->getTarget_fps();
-	math_sink->set_update_time(1.0/targetFps);
-	/* Add the math block and the math scope sink into a container, so that
-	 * we can disconnect them when removing the math channel later */
-	auto math_pair = QPair<gr::basic_block_sptr, gr::basic_block_sptr>(
-				math, math_sink);
-	math_sinks.insert(qname, math_pair);
-	math_rails.insert(qname, rail);
+	math_sink->set_persistence(persistenceEnableBox->isChecked());
+	math_sinks.insert(qname, math_sink);
+	setTimeSinksUpdateTime();
+	math_functions.insert(qname, function);
 
 	/* Lock the flowgraph if we are already started */
 	bool started = isIioManagerStarted();
@@ -2497,11 +3488,7 @@ void Oscilloscope::add_math_channel(const std::string& function)
 
 	math_sink->set_trigger_mode(TRIG_MODE_TAG, 0, "buffer_start");
 
-	for (unsigned int i = 0; i < nb_channels; i++) {
-		iio->connect(math_probe_atten.at(i), 0, math, i);
-	}
-	iio->connect(math, 0, rail, 0);
-	iio->connect(rail, 0, math_sink, 0);
+	rebuildMathEngine();
 
 	if (started)
 		iio->unlock();
@@ -2664,16 +3651,10 @@ void Oscilloscope::onChannelWidgetDeleteClicked()
 		gsettings_ui->cmb_y_channel->blockSignals(false);
 		setup_xy_channels();
 
-		/* Disconnect the blocks from the running flowgraph */
-		auto pair = math_sinks.take(qname);
-		auto rail = math_rails.take(qname);
-
-		for (unsigned int i = 0; i < nb_channels; i++) {
-			iio->disconnect(math_probe_atten.at(i), 0, pair.first, i);
-		}
-
-		iio->disconnect(pair.first, 0, rail, 0);
-		iio->disconnect(rail, 0, pair.second, 0);
+		/* Disconnect the sink from the running flowgraph */
+		math_sinks.remove(qname);
+		math_functions.remove(qname);
+		rebuildMathEngine();
 
 		if (xy_is_visible) {
 			setup_xy_channels();
@@ -2822,7 +3803,8 @@ void Oscilloscope::toggle_blockchain_flow(bool en)
 
 			// connect analog
 			for (int i = 0; i < nb_channels; ++i) {
-				iio->disconnect(block, i, qt_time_block, i);
+				iio->disconnect(block, i, sw_trigger_block, i);
+				iio->disconnect(sw_trigger_block, i, qt_time_block, i);
 				iio->connect(block, i, mixed_sink, i);
 			}
 
@@ -2843,6 +3825,10 @@ void Oscilloscope::toggle_blockchain_flow(bool en)
 		for (unsigned int i = 0; i < nb_channels; i++)
 			iio->start(ids[i]);
 
+		if (fft_is_visible) {
+			startFftFlow();
+		}
+
 		scaleHistogramPlot();
 
 	} else {
@@ -2850,6 +3836,8 @@ void Oscilloscope::toggle_blockchain_flow(bool en)
 		for (unsigned int i = 0; i < nb_channels; i++)
 			iio->stop(ids[i]);
 
+		stopFftFlow();
+
 		if (autosetRequested) {
 			iio->stop(autoset_id[0]);			
 		}
@@ -2862,7 +3850,8 @@ void Oscilloscope::toggle_blockchain_flow(bool en)
 			// disconnect analog
 			for (int i = 0; i < nb_channels; ++i) {
 				iio->disconnect(block, i, mixed_sink, i);
-				iio->connect(block, i, qt_time_block, i);
+				iio->connect(block, i, sw_trigger_block, i);
+				iio->connect(sw_trigger_block, i, qt_time_block, i);
 			}
 
 			// disconnect digital
@@ -2889,6 +3878,10 @@ void Oscilloscope::runStopToggled(bool checked)
 	Q_EMIT activateExportButton();
 
 	if (checked) {
+		maskTest->rearm();
+		if (playbackBtn->isChecked()) {
+			playbackBtn->setChecked(false);
+		}
 		periodicFlowRestart(true);
 		if (symmBufferMode->isEnhancedMemDepth()) {
 			onCmbMemoryDepthChanged(ch_ui->cmbMemoryDepth->currentText());
@@ -2936,6 +3929,19 @@ void Oscilloscope::runStopToggled(bool checked)
 	plot.startStop(checked);
 	hist_plot.startStop(checked);
 
+	// Stored captures can only be browsed while stopped
+	unsigned int historySize;
+	{
+		std::unique_lock<std::mutex> lock(historyMutex);
+		historySize = history->size();
+	}
+	historyIndexBox->setEnabled(!checked && historySize);
+	if (!checked && historySize) {
+		QSignalBlocker blocker(historyIndexBox);
+		historyIndexBox->setRange(1, historySize);
+		historyIndexBox->setValue(historySize);
+	}
+
 	triggerUpdater->setEnabled(checked);
 }
 
@@ -2987,44 +3993,88 @@ void Oscilloscope::autosetFFT()
 	iio->connect(log,0,autosetFFTSink,0);
 }
 
+void Oscilloscope::buildFftFlow()
+{
+	if (fft_top_block) {
+		fft_top_block->disconnect_all();
+	}
+
+	fft_top_block = gr::make_top_block("Osc FFT");
+	fft_conv_block = gnuradio::get_initial_sptr(
+				new adc_sample_conv(nb_channels, m_m2k_analogin));
+
+	fft_s2f_blocks.clear();
+	fft_dc_cancel.clear();
+	fft_blocks.clear();
+	ctm_blocks.clear();
+
+	for (unsigned int i = 0; i < nb_channels; i++) {
+		fft_s2f_blocks.push_back(blocks::short_to_float::make());
+		fft_dc_cancel.push_back(cancel_dc_offset_block::make(
+					active_sample_count, chnAcCoupled.at(i)));
+		fft_blocks.push_back(gnuradio::get_initial_sptr(
+					     new fft_block(false, fft_plot_size)));
+		ctm_blocks.push_back(blocks::complex_to_mag_squared::make(1));
+
+		/** GNU Radio flow: iio(i) -> s2f -> conv -> dc -> fft -> ctm -> qt_fft_block */
+		fft_top_block->connect(fft_s2f_blocks.at(i), 0, fft_conv_block, i);
+		fft_top_block->connect(fft_conv_block, i, fft_dc_cancel.at(i), 0);
+		fft_top_block->connect(fft_dc_cancel.at(i), 0, fft_blocks.at(i), 0);
+		fft_top_block->connect(fft_blocks.at(i), 0, ctm_blocks.at(i), 0);
+		fft_top_block->connect(ctm_blocks.at(i), 0, qt_fft_block, i);
+	}
+}
+
+void Oscilloscope::startFftFlow()
+{
+	if (!fft_top_block || !fft_sources.empty()) {
+		return;
+	}
+
+	/* The time base decides the buffer size, the FFT view doesn't
+	 * request one of its own */
+	for (unsigned int i = 0; i < nb_channels; i++) {
+		auto source = iio->attach(i, 0);
+
+		fft_top_block->connect(source, 0, fft_s2f_blocks.at(i), 0);
+		fft_sources.push_back(source);
+	}
+
+	qt_fft_block->reset();
+	fft_top_block->start();
+}
+
+void Oscilloscope::stopFftFlow()
+{
+	if (fft_sources.empty()) {
+		return;
+	}
+
+	fft_top_block->stop();
+	fft_top_block->wait();
+
+	for (unsigned int i = 0; i < fft_sources.size(); i++) {
+		fft_top_block->disconnect(fft_sources.at(i), 0,
+					  fft_s2f_blocks.at(i), 0);
+		iio->detach(fft_sources.at(i));
+	}
+
+	fft_sources.clear();
+}
+
 void Oscilloscope::onFFT_view_toggled(bool visible)
 {
-	/* Lock the flowgraph if we are already started */
-	bool started = isIioManagerStarted();
-	if (started)
-		iio->lock();
+	/* Showing or hiding the FFT only attaches or detaches its own
+	 * flowgraph; the time domain acquisition keeps running */
+	stopFftFlow();
 
 	if (visible) {
 		qt_fft_block->set_nsamps(fft_plot_size);
-
-		if (fft_is_visible && (fft_channels.size() > 0)) {
-			for (unsigned int i = 0; i < nb_channels; i++) {
-				/** GNU Radio flow: iio(i) ->  fft -> ctm -> qt_fft_block */
-				iio->disconnect(fft_channels.at(i).first, fft_channels.at(i).second,
-						fft_blocks.at(i), 0);
-				iio->disconnect(fft_blocks.at(i), 0, ctm_blocks.at(i), 0);
-				iio->disconnect(ctm_blocks.at(i), 0, qt_fft_block, i);
-			}
-		}
 		setFFT_params();
+		buildFftFlow();
 
-		for (unsigned int i = 0; i < nb_channels; i++) {
-			fft_blocks.push_back(gnuradio::get_initial_sptr(
-						     new fft_block(false, fft_plot_size)));
-			ctm_blocks.push_back(blocks::complex_to_mag_squared::make(1));
-
-			if (chnAcCoupled.at(i)) {
-				fft_channels.push_back(QPair<gr::basic_block_sptr, int>(
-							       dc_cancel.at(i), 0));
-			} else {
-				fft_channels.push_back(QPair<gr::basic_block_sptr, int>(
-							       adc_samp_conv_block, i));
-			}
-
-			iio->connect(fft_channels.at(i).first, fft_channels.at(i).second,
-					fft_blocks.at(i), 0);
-			iio->connect(fft_blocks.at(i), 0, ctm_blocks.at(i), 0);
-			iio->connect(ctm_blocks.at(i), 0, qt_fft_block, i);
+		if (isIioManagerStarted()) {
+			startFftFlow();
 		}
 
 		if(prefPanel->getCurrent_docking_enabled()) {
@@ -3041,23 +4091,13 @@ void Oscilloscope::onFFT_view_toggled(bool visible)
 				ui->container_fft_plot->hide();
 		}
 
-		if (fft_is_visible && (fft_channels.size() > 0)) {
-			for (unsigned int i = 0; i < nb_channels; i++) {
-				iio->disconnect(fft_channels.at(i).first, fft_channels.at(i).second,
-						fft_blocks.at(i), 0);
-				iio->disconnect(fft_blocks.at(i), 0, ctm_blocks.at(i), 0);
-				iio->disconnect(ctm_blocks.at(i), 0, qt_fft_block, i);
-			}
-			fft_channels.clear();
-			fft_blocks.clear();
-			ctm_blocks.clear();
+		if (fft_top_block) {
+			fft_top_block->disconnect_all();
+			fft_top_block.reset();
 		}
 	}
 
 	fft_is_visible = visible;
-
-	if (started)
-		iio->unlock();
 }
 
 void Oscilloscope::onHistogram_view_toggled(bool visible)
@@ -3151,20 +4191,7 @@ void Oscilloscope::onXY_view_toggled(bool visible)
 		index_y = gsettings_ui->cmb_y_channel->currentIndex();
 
 		if(xy_channels.size() == 0) {
-			for(unsigned int i = 0; i < nb_channels; i++) {
-				if (chnAcCoupled.at(i)) {
-					xy_channels.push_back(QPair<gr::basic_block_sptr, int>(
-								      dc_cancel.at(i), 0));
-				} else {
-					xy_channels.push_back(QPair<gr::basic_block_sptr, int>(
-								      adc_samp_conv_block, i));
-				}
-			}
-			for(const auto &p : qAsConst(math_sinks)) {
-				auto math = p.first;
-				xy_channels.push_back(QPair<gr::basic_block_sptr, int>(
-							      math, 0));
-			}
+			fillXyChannels();
 		}
 
 		iio->connect(xy_channels.at(index_x).first, xy_channels.at(index_x).second,
@@ -3539,6 +4566,7 @@ void Oscilloscope::onCmbMemoryDepthChanged(QString value)
 	timePosition->setValue(params.timePos);
 	active_time_pos = params.timePos;
 	active_sample_rate = params.sampleRate;
+	updateHistoryInfo();
 	active_plot_sample_count = params.entireBufferSize;
 	active_sample_count = params.maxBufferSize;
 	active_trig_sample_count = -(long long)params.triggerBufferSize;
@@ -3554,6 +4582,8 @@ void Oscilloscope::onCmbMemoryDepthChanged(QString value)
 	plot.setXAxisNumPoints(bufferSize);
 	plot.setHorizOffset(params.timePos);
 	plot.setDataStartingPoint(active_trig_sample_count);
+	setMaskTimeBase();
+	updateSoftwareTrigger();
 	plot.resetXaxisOnNextReceivedData();
 	plot.cancelZoom();
 
@@ -3616,20 +4646,35 @@ void Oscilloscope::setSinksDisplayOneBuffer(bool val)
 
 	auto it = math_sinks.constBegin();
 	while (it != math_sinks.constEnd()) {
-		scope_sink_f::sptr math_sink = dynamic_pointer_cast<
-				scope_sink_f>(it.value().second);
-		math_sink->set_displayOneBuffer(val);
+		it.value()->set_displayOneBuffer(val);
 		++it;
 	}
 	qt_fft_block->set_displayOneBuffer(val);
 }
 
+/* Headless, every buffer acquired is sent to the plot, so the scripts
+ * can count and read each of them; the plot is not drawn anyway */
+void Oscilloscope::setTimeSinksUpdateTime()
+{
+	const double update_time = plot.isHeadless() ? 0.0 :
+			1.0 / getScopyPreferences()->getTarget_fps();
+
+	qt_time_block->set_update_time(update_time);
+
+	auto it = math_sinks.constBegin();
+	while (it != math_sinks.constEnd()) {
+		it.value()->set_update_time(update_time);
+		++it;
+	}
+}
+
 void adiscope::Oscilloscope::onHorizScaleValueChanged(double value)
 {
 	cancelZoom();
 	symmBufferMode->setTimeBase(value);
 	SymmetricBufferMode::capture_parameters params = symmBufferMode->captureParameters();
 	active_sample_rate = params.sampleRate;
+	updateHistoryInfo();
 	active_sample_count = params.entireBufferSize;
 	active_plot_sample_count = active_sample_count;
 	active_trig_sample_count = -(long long)params.triggerBufferSize;
@@ -3647,6 +4692,8 @@ void adiscope::Oscilloscope::onHorizScaleValueChanged(double value)
 	plot.setHorizUnitsPerDiv(value);
 	plot.replot();
 	plot.setDataStartingPoint(active_trig_sample_count);
+	setMaskTimeBase();
+	updateSoftwareTrigger();
 	plot.resetXaxisOnNextReceivedData();
 	plot.setXAxisNumPoints(0);
 
@@ -3818,6 +4865,7 @@ void adiscope::Oscilloscope::onTimePositionChanged(double value)
 
 	SymmetricBufferMode::capture_parameters params = symmBufferMode->captureParameters();
 	active_sample_rate = params.sampleRate;
+	updateHistoryInfo();
 	active_sample_count = params.entireBufferSize;
 	active_plot_sample_count = active_sample_count;
 	active_trig_sample_count = -(long long)params.triggerBufferSize;
@@ -3832,6 +4880,8 @@ void adiscope::Oscilloscope::onTimePositionChanged(double value)
 	plot.realignReferenceWaveforms(timeBase->value(), timePosition->value());
 	plot.replot();
 	plot.setDataStartingPoint(active_trig_sample_count);
+	setMaskTimeBase();
+	updateSoftwareTrigger();
 	plot.resetXaxisOnNextReceivedData();
 
 
@@ -4143,8 +5193,6 @@ void Oscilloscope::openEditMathPanel(bool on)
 void Oscilloscope::editMathChannelFunction(int id, const std::string& new_function)
 {
 	ChannelWidget *chn_widget = channelWidgetAtId(id);
-	int current_x = index_x;
-	int current_y = index_y;
 
 	triggerRightMenuToggle(
 				static_cast<CustomPushButton* >(ui->btnAddMath), false);
@@ -4161,53 +5209,14 @@ void Oscilloscope::editMathChannelFunction(int id, const std::string& new_functi
 	QString qname = chn_widget->deleteButton()->property("curve_name").toString();
 	std::string name = qname.toStdString();
 
-	auto rail = gr::analog::rail_ff::make(MIN_MATH_RANGE, MAX_MATH_RANGE);
-	auto math = gr::scopy::iio_math::make(new_function, nb_channels);
+	math_expression(new_function, nb_channels);
 
 	bool started = isIioManagerStarted();
 	if (started)
 		iio->lock();
 	locked = true;
-	if(xy_is_visible) {
-		gsettings_ui->cmb_x_channel->blockSignals(true);
-		gsettings_ui->cmb_y_channel->blockSignals(true);
-		if(index_x == id)
-			gsettings_ui->cmb_x_channel->setCurrentIndex(id-1);
-		if(index_y == id)
-			gsettings_ui->cmb_y_channel->setCurrentIndex(id-1);
-		gsettings_ui->cmb_x_channel->blockSignals(false);
-		gsettings_ui->cmb_y_channel->blockSignals(false);
-		setup_xy_channels();
-	}
-	auto pair = math_sinks.value(qname);
-	auto rail_old = math_rails.value(qname);
-	for (unsigned int i = 0; i < nb_channels; ++i) {
-		iio->disconnect(math_probe_atten.at(i), 0, pair.first, i);
-	}
-	iio->disconnect(pair.first, 0, rail_old, 0);
-	iio->disconnect(rail_old, 0, pair.second, 0);
-
-	auto math_pair = QPair<gr::basic_block_sptr, gr::basic_block_sptr>(
-				math, pair.second);
-
-	math_sinks.insert(qname, math_pair);
-	math_rails.insert(qname, rail);
-
-	for (unsigned int i = 0; i < nb_channels; ++i) {
-		iio->connect(math_probe_atten.at(i), 0, math, i);
-	}
-	iio->connect(math, 0, rail, 0);
-	iio->connect(rail, 0, pair.second, 0);
-
-	if(xy_is_visible) {
-		gsettings_ui->cmb_x_channel->blockSignals(true);
-		gsettings_ui->cmb_y_channel->blockSignals(true);
-		gsettings_ui->cmb_x_channel->setCurrentIndex(current_x);
-		gsettings_ui->cmb_y_channel->setCurrentIndex(current_y);
-		gsettings_ui->cmb_x_channel->blockSignals(false);
-		gsettings_ui->cmb_y_channel->blockSignals(false);
-		setup_xy_channels();
-	}
+	math_functions.insert(qname, new_function);
+	rebuildMathEngine();
 	locked = false;
 	if (started)
 		iio->unlock();
@@ -4841,6 +5850,11 @@ void Oscilloscope::periodicFlowRestart(bool force)
 {
 	static uint64_t restartFlowCounter = 0;
 	const uint64_t NO_FLOW_BUFFERS = 1024;
+
+	/* The recording would lose the samples of the restart */
+	if (recorder && recorder->isRecording()) {
+		return;
+	}
 	if(force) {
 		restartFlowCounter = NO_FLOW_BUFFERS;
 	}
@@ -4965,28 +5979,31 @@ void Oscilloscope::onFilledScreen(bool full, unsigned int nb_samples)
 
 void Oscilloscope::resetStreamingFlag(bool enable)
 {
-	bool started = isIioManagerStarted();
-	if (started)
-		iio->lock();
+	/* The recording keeps the hardware streaming, untouched */
+	if (!recorder || !recorder->isRecording()) {
+		bool started = isIioManagerStarted();
+		if (started)
+			iio->lock();
 
-	try {
-		m_m2k_analogin->getTrigger()->setAnalogStreamingFlag(false);
-	} catch (libm2k::m2k_exception &e) {
-		HANDLE_EXCEPTION(e)
-		qDebug(CAT_OSCILLOSCOPE) << e.what();
-	}
-	cleanBuffersAllSinks();
+		try {
+			m_m2k_analogin->getTrigger()->setAnalogStreamingFlag(false);
+		} catch (libm2k::m2k_exception &e) {
+			HANDLE_EXCEPTION(e)
+			qDebug(CAT_OSCILLOSCOPE) << e.what();
+		}
+		cleanBuffersAllSinks();
 
-	if (started)
-		iio->unlock();
+		if (started)
+			iio->unlock();
 
-	try {
-		if (enable && !d_displayOneBuffer) {
-			m_m2k_analogin->getTrigger()->setAnalogStreamingFlag(true);
+		try {
+			if (enable && !d_displayOneBuffer) {
+				m_m2k_analogin->getTrigger()->setAnalogStreamingFlag(true);
+			}
+		} catch (libm2k::m2k_exception &e) {
+			HANDLE_EXCEPTION(e)
+			qDebug(CAT_OSCILLOSCOPE) << e.what();
 		}
-	} catch (libm2k::m2k_exception &e) {
-		HANDLE_EXCEPTION(e)
-		qDebug(CAT_OSCILLOSCOPE) << e.what();
 	}
 
 	/* Single capture done */
@@ -5010,9 +6027,7 @@ void Oscilloscope::cleanBuffersAllSinks()
 
 	auto it = math_sinks.constBegin();
 	while (it != math_sinks.constEnd()) {
-		scope_sink_f::sptr math_sink = dynamic_pointer_cast<
-				scope_sink_f>(it.value().second);
-		math_sink->clean_buffers();
+		it.value()->clean_buffers();
 		++it;
 	}
 	qt_fft_block->clean_buffers();
@@ -5046,6 +6061,10 @@ void Oscilloscope::onPlotNewData()
 	updateBufferPreviewer();
 
 	trigger_input = true; //used to read trigger status from Js
+
+	if (maskEnableBox->isChecked()) {
+		updateMaskStatus();
+	}
 }
 
 void Oscilloscope::onTriggerModeChanged(int mode)
@@ -5223,9 +6242,7 @@ void Oscilloscope::setAllSinksSampleCount(unsigned long sample_count)
 
 	auto it = math_sinks.constBegin();
 	while (it != math_sinks.constEnd()) {
-		scope_sink_f::sptr math_sink = dynamic_pointer_cast<
-				scope_sink_f>(it.value().second);
-		math_sink->set_nsamps(sample_count);
+		it.value()->set_nsamps(sample_count);
 		++it;
 	}
 	this->qt_fft_block->set_nsamps(fft_plot_size);
@@ -5282,6 +6299,78 @@ void adiscope::Oscilloscope::on_xyLineThickness_currentIndexChanged(int idx)
 	 xy_plot.setLineWidth(0,idx);
 }
 
+void Oscilloscope::fillXyChannels()
+{
+	for(unsigned int i = 0; i < nb_channels; i++) {
+		if (chnAcCoupled.at(i)) {
+			xy_channels.push_back(QPair<gr::basic_block_sptr, int>(
+						      dc_cancel.at(i), 0));
+		} else {
+			xy_channels.push_back(QPair<gr::basic_block_sptr, int>(
+						      adc_samp_conv_block, i));
+		}
+	}
+	for(unsigned int i = 0; i < math_engine_sinks.size(); i++) {
+		xy_channels.push_back(QPair<gr::basic_block_sptr, int>(
+					      math_engine, i));
+	}
+}
+
+/* All the math channels are computed by a single block that reads each
+ * channel once. It is replaced whenever a math channel is added, edited
+ * or removed; the flowgraph must be locked. */
+void Oscilloscope::rebuildMathEngine()
+{
+	/* The XY plot may be fed by the engine being replaced */
+	const bool xy_connected = xy_is_visible && !xy_channels.empty();
+
+	if (xy_connected) {
+		iio->disconnect(xy_channels.at(index_x).first,
+				xy_channels.at(index_x).second, ftc, 0);
+		iio->disconnect(xy_channels.at(index_y).first,
+				xy_channels.at(index_y).second, ftc, 1);
+		xy_channels.clear();
+	}
+
+	if (math_engine) {
+		for (unsigned int i = 0; i < nb_channels; i++) {
+			iio->disconnect(math_probe_atten.at(i), 0, math_engine, i);
+		}
+		for (unsigned int i = 0; i < math_engine_sinks.size(); i++) {
+			iio->disconnect(math_engine, i, math_engine_sinks[i], 0);
+		}
+		math_engine.reset();
+		math_engine_sinks.clear();
+	}
+
+	if (!math_sinks.isEmpty()) {
+		std::vector<std::string> functions;
+
+		for (auto it = math_sinks.constBegin(); it != math_sinks.constEnd(); ++it) {
+			functions.push_back(math_functions.value(it.key()));
+			math_engine_sinks.push_back(it.value());
+		}
+
+		math_engine = math_engine_block::make(nb_channels, functions,
+						      MIN_MATH_RANGE, MAX_MATH_RANGE);
+
+		for (unsigned int i = 0; i < nb_channels; i++) {
+			iio->connect(math_probe_atten.at(i), 0, math_engine, i);
+		}
+		for (unsigned int i = 0; i < math_engine_sinks.size(); i++) {
+			iio->connect(math_engine, i, math_engine_sinks[i], 0);
+		}
+	}
+
+	if (xy_connected) {
+		fillXyChannels();
+		iio->connect(xy_channels.at(index_x).first,
+			     xy_channels.at(index_x).second, ftc, 0);
+		iio->connect(xy_channels.at(index_y).first,
+			     xy_channels.at(index_y).second, ftc, 1);
+	}
+}
+
 void Oscilloscope::setup_xy_channels()
 {
 	int x = gsettings_ui->cmb_x_channel->currentIndex();
@@ -5350,6 +6439,11 @@ void Oscilloscope::setSampleRate(double sample_rate)
 	if (!m_m2k_analogin) {
 		return;
 	}
+
+	if (recorder && recorder->isRecording() &&
+			sample_rate != recorder->sampleRate()) {
+		stopRecording(tr("sample rate changed"));
+	}
 	runInHwThreadPool( {
 	try {
 		auto maxSampleRate = m_m2k_analogin->getMaximumSamplerate();
@@ -27,7 +27,6 @@
 #include <gnuradio/blocks/short_to_float.h>
 #include <iio/device_source.h>
 #include <gnuradio/blocks/complex_to_mag_squared.h>
-#include <gnuradio/analog/rail_ff.h>
 #include <gnuradio/blocks/keep_one_in_n.h>
 #include <gnuradio/blocks/vector_sink.h>
 #include <gnuradio/blocks/multiply_const.h>
@@ -46,9 +45,17 @@
 #include <QQueue>
 #include <QThreadPool>
 
+#include <atomic>
+#include <mutex>
+
 /* Local includes */
 #include "apiObject.hpp"
 #include "oscilloscope_plot.hpp"
+#include "acquisition_history.hpp"
+#include "mask_test.hpp"
+#include "stream_recorder.hpp"
+#include "software_trigger_block.h"
+#include "math_engine_block.h"
 #include "iio_manager.hpp"
 #include "filter.hpp"
 #include "fft_block.hpp"
@@ -86,6 +93,12 @@
 #define TIMEBASE_THRESHOLD 0.1
 
 class QJSEngine;
+class QCheckBox;
+class QSpinBox;
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QTimer;
 class SymmetricBufferMode;
 
 namespace Ui {
@@ -148,6 +161,22 @@ namespace adiscope {
 
 	private Q_SLOTS:
 		void btnExport_clicked();
+		void btnHistoryExport_clicked();
+		void btnHistoryMeasure_clicked();
+		void onHistoryIndexChanged(int);
+		void updateHistoryOverlay();
+		void onHistoryUpdated();
+		void updateHistoryInfo();
+		void btnMaskFromTrace_clicked();
+		void btnMaskLoad_clicked();
+		void onMaskTestFailed();
+		void updateMaskStatus();
+		void btnRecord_toggled(bool);
+		void btnPlayback_toggled(bool);
+		void updateRecorderStatus();
+		void onIioRestarted();
+		void updateSoftwareTrigger();
+		void updateSoftwareTriggerRate();
 
 		void on_actionClose_triggered();
 		void on_boxCursors_toggled(bool on);
@@ -236,6 +265,7 @@ namespace adiscope {
 
 		void onCmbMemoryDepthChanged(QString);
 		void setSinksDisplayOneBuffer(bool);
+		void setTimeSinksUpdateTime();
 		void cleanBuffersAllSinks();
 		void resetStreamingFlag(bool);
 		void onFilledScreen(bool, unsigned int);
@@ -311,6 +341,63 @@ namespace adiscope {
 		QWidget *statisticsPanel;
 		AnalogBufferPreviewer *buffer_previewer;
 		ExportSettings *exportSettings;
+
+		AcquisitionHistory *history;
+		QCheckBox *historyEnableBox;
+		QCheckBox *historyOverlayBox;
+		QSpinBox *historySizeBox;
+		QSpinBox *historyIndexBox;
+
+		/* Every capture of the time sink, also the ones that are
+		 * not plotted, is copied by the flowgraph thread straight
+		 * into the history, stamped with historyInfo as it is when
+		 * the capture arrives. Only the GUI thread reallocates the
+		 * history, to historyLength. All of them are guarded by
+		 * historyMutex. */
+		std::mutex historyMutex;
+		AcquisitionSegment historyInfo;
+		size_t historyLength = 0;
+		bool historyUpdateQueued = false;
+		std::atomic<bool> historyRecording = {false};
+
+		QComboBox *acquisitionModeBox;
+		QSpinBox *acquisitionFactorBox;
+
+		QCheckBox *persistenceEnableBox;
+		QComboBox *persistenceDecayBox;
+
+		MaskTest *maskTest;
+		QCheckBox *maskEnableBox;
+		QCheckBox *maskStopBox;
+		QDoubleSpinBox *maskToleranceBox;
+		QLabel *maskStatusLabel;
+
+		StreamRecorder *recorder;
+		QTimer *recorderTimer;
+		QPushButton *recordBtn;
+		QPushButton *playbackBtn;
+		QComboBox *playbackSpeedBox;
+		QLabel *recorderStatusLabel;
+		QString recorderStopReason;
+		gr::top_block_sptr playback_top_block;
+		recording_source::sptr playback_source;
+		scope_sink_f::sptr playback_sink;
+
+		QComboBox *swTriggerTypeBox;
+		QComboBox *swTriggerSourceBox;
+		QComboBox *swTriggerPolarityBox;
+		QDoubleSpinBox *swTriggerLevelABox;
+		QDoubleSpinBox *swTriggerLevelBBox;
+		QDoubleSpinBox *swTriggerHystBox;
+		QDoubleSpinBox *swTriggerMinBox;
+		QDoubleSpinBox *swTriggerMaxBox;
+		QSpinBox *swTriggerCountBox;
+		QDoubleSpinBox *swTriggerHoldoffBox;
+		QLabel *swTriggerRateLabel;
+		QTimer *swTriggerTimer;
+		uint64_t sw_trigger_last_count;
+		bool sw_trigger_en;
+		bool sw_trigger_hw_en;
 		CustomPlotPositionButton *cursorsPositionButton;
 
 		QGridLayout* gridPlot;
@@ -339,12 +426,14 @@ namespace adiscope {
 		adiscope::scope_sink_f::sptr qt_fft_block;
 		adiscope::xy_sink_c::sptr qt_xy_block;
 		adiscope::histogram_sink_f::sptr qt_hist_block;
+		software_trigger_block::sptr sw_trigger_block;
 		boost::shared_ptr<iio_manager> iio;
 		gr::basic_block_sptr adc_samp_conv_block;
 
-		QMap<QString, QPair<gr::basic_block_sptr,
-		gr::basic_block_sptr>> math_sinks;
-		QMap<QString, boost::shared_ptr<gr::analog::rail_ff>> math_rails;
+		QMap<QString, scope_sink_f::sptr> math_sinks;
+		QMap<QString, std::string> math_functions;
+		math_engine_block::sptr math_engine;
+		std::vector<scope_sink_f::sptr> math_engine_sinks;
 		std::vector<boost::shared_ptr<gr::blocks::multiply_const_ff>> math_probe_atten;
 
 		iio_manager::port_id *ids;
@@ -373,7 +462,7 @@ namespace adiscope {
 		boost::shared_ptr<gr::blocks::keep_one_in_n> keep_one;
 		boost::shared_ptr<gr::blocks::vector_sink_f> autosetFFTSink;
 
-		bool trigger_is_forced;
+		std::atomic<bool> trigger_is_forced;
 		bool new_data_is_triggered;
 		bool trigger_input;
 		CapturePlot::TriggerState trigger_state;
@@ -447,6 +536,20 @@ namespace adiscope {
 
 		void updateBufferPreviewer();
 		void export_settings_init();
+		QGridLayout *addSettingsSection(const QString &title);
+		void history_settings_init();
+		void acquisition_settings_init();
+		void persistence_settings_init();
+		void mask_settings_init();
+		void recorder_settings_init();
+		void sw_trigger_settings_init();
+		void rebuildMathEngine();
+		void fillXyChannels();
+		void stopPlayback();
+		void stopRecording(const QString &reason);
+		void setMaskTimeBase();
+		void timeFrameReceived(const std::vector<const float *> &frames,
+				       int nitems);
 		void pause(bool paused);
 		void cursor_panel_init();
 		void setFFT_params(bool force=false);
@@ -457,13 +560,24 @@ namespace adiscope {
 
 		std::vector<boost::shared_ptr<cancel_dc_offset_block>> dc_cancel;
 		std::vector<QPair<gr::basic_block_sptr, int> > xy_channels;
-		std::vector<QPair<gr::basic_block_sptr, int> > fft_channels;
 		int index_x, index_y;
 		bool locked;
 		boost::shared_ptr<gr::blocks::float_to_complex> ftc;
+
+		/* The FFT view runs in its own flowgraph, fed by consumers
+		 * attached to the iio_manager */
+		gr::top_block_sptr fft_top_block;
+		gr::basic_block_sptr fft_conv_block;
+		std::vector<broadcaster_source::sptr> fft_sources;
+		std::vector<gr::basic_block_sptr> fft_s2f_blocks;
+		std::vector<boost::shared_ptr<cancel_dc_offset_block>> fft_dc_cancel;
 		std::vector<gr::basic_block_sptr> fft_blocks;
 		std::vector<gr::basic_block_sptr> ctm_blocks;
 
+		void buildFftFlow();
+		void startFftFlow();
+		void stopFftFlow();
+
 		void cancelZoom();
 
 		void configureAcCoupling(int, bool);
@@ -28,6 +28,9 @@
 #include "ui_channel_settings.h"
 #include "ui_osc_general_settings.h"
 
+#include <QEventLoop>
+#include <QTimer>
+
 namespace adiscope
 {
 /*
@@ -393,6 +396,83 @@ void Oscilloscope_API::show()
 	Q_EMIT osc->showTool();
 }
 
+void Oscilloscope_API::beginLoad()
+{
+	/* Nested locks taken by the setters won't restart the flowgraph,
+	 * it is restarted once, when the whole state is loaded */
+	if (osc->iio)
+		osc->iio->lock();
+}
+
+void Oscilloscope_API::endLoad()
+{
+	if (osc->iio)
+		osc->iio->unlock();
+}
+
+bool Oscilloscope_API::isHeadless() const
+{
+	return osc->plot.isHeadless();
+}
+
+void Oscilloscope_API::setHeadless(bool en)
+{
+	osc->plot.setHeadless(en);
+	osc->setTimeSinksUpdateTime();
+}
+
+bool Oscilloscope_API::waitForCaptures(int frames, int timeout_ms,
+				       bool triggered_only)
+{
+	/* Block the script, but not the event loop, until the plot received
+	 * the requested number of buffers */
+	QEventLoop loop;
+	QTimer timeout;
+	int captured = 0;
+
+	timeout.setSingleShot(true);
+	QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+	auto conn = QObject::connect(&osc->plot,
+			QOverload<>::of(&TimeDomainDisplayPlot::newData), [&]() {
+		if (triggered_only && !osc->new_data_is_triggered)
+			return;
+		if (++captured >= frames)
+			loop.quit();
+	});
+
+	timeout.start(timeout_ms);
+	loop.exec();
+	QObject::disconnect(conn);
+
+	return captured >= frames;
+}
+
+bool Oscilloscope_API::capture(int frames, int timeout_ms)
+{
+	const bool was_running = running();
+
+	if (frames <= 0)
+		return false;
+
+	if (!was_running)
+		run(true);
+
+	const bool done = waitForCaptures(frames, timeout_ms, false);
+
+	if (!was_running)
+		run(false);
+
+	return done;
+}
+
+bool Oscilloscope_API::waitForTrigger(int timeout_ms)
+{
+	if (!running())
+		return false;
+
+	return waitForCaptures(1, timeout_ms, true);
+}
+
 bool Oscilloscope_API::running() const
 {
 	return osc->ui->runSingleWidget->runButtonChecked() || osc->ui->runSingleWidget->singleButtonChecked();
@@ -916,6 +996,27 @@ QList<double> Channel_API::data() const
 	return list;
 }
 
+QByteArray Channel_API::dataBuffer() const
+{
+	/* Float32 samples, read from scripts through a Float32Array view
+	 * without converting each sample to a JS value */
+	int index = osc->channels_api.indexOf(const_cast<Channel_API*>(this));
+	if (index < 0)
+		return QByteArray();
+
+	const double *samples = osc->plot.channelData(index);
+	const size_t num_of_samples = osc->plot.Curve(index)->data()->size();
+	if (!samples)
+		return QByteArray();
+
+	QByteArray buffer(num_of_samples * sizeof(float), Qt::Uninitialized);
+	float *out = reinterpret_cast<float *>(buffer.data());
+	for (size_t i = 0; i < num_of_samples; i++)
+		out[i] = static_cast<float>(samples[i]);
+
+	return buffer;
+}
+
 #define DECLARE_MEASURE(m, t) \
 	double Channel_API::measured_ ## m () const\
 	{\
@@ -128,6 +128,8 @@ class Oscilloscope_API : public ApiObject
 
 	Q_PROPERTY(QString notes READ getNotes WRITE setNotes)
 
+	Q_PROPERTY(bool headless READ isHeadless WRITE setHeadless STORED false)
+
 public:
 	explicit Oscilloscope_API(Oscilloscope *osc) :
 		ApiObject(), osc(osc) {}
@@ -268,9 +270,20 @@ public:
 	QString getNotes();
 	void setNotes(QString);
 
+	bool isHeadless() const;
+	void setHeadless(bool en);
+
 	Q_INVOKABLE void show();
+	Q_INVOKABLE bool capture(int frames, int timeout_ms = 10000);
+	Q_INVOKABLE bool waitForTrigger(int timeout_ms = 10000);
+
+	protected:
+		void beginLoad() override;
+		void endLoad() override;
 
 	private:
+		bool waitForCaptures(int frames, int timeout_ms, bool triggered_only);
+
 		Oscilloscope *osc;
 	};
 
@@ -353,6 +366,7 @@ public:
 	Q_PROPERTY(double pos_duty READ measured_pos_duty)
 	Q_PROPERTY(double neg_duty READ measured_neg_duty)
 	Q_PROPERTY(QList<double> data READ data STORED false)
+	Q_PROPERTY(QByteArray data_buffer READ dataBuffer STORED false)
 
 	Q_PROPERTY(QVariantList digFilter READ getDigFilters /*WRITE setDigFilter1 */)
 
@@ -412,6 +426,7 @@ public:
 	double measured_pos_duty() const;
 	double measured_neg_duty() const;
 	QList<double> data() const;
+	QByteArray dataBuffer() const;
 	QVariantList getDigFilters() const;
 
 	Q_INVOKABLE void setColor(int, int, int, int a = 255);
@@ -1909,6 +1909,74 @@ void CapturePlot::onNewDataReceived()
 	}
 }
 
+bool CapturePlot::showSegment(const std::vector<const double *> &data,
+			      size_t nb_samples)
+{
+	for (unsigned int i = 0; i < data.size(); i++) {
+		if (i >= d_ydata.size() || !data[i] ||
+				Curve(i)->data()->size() != nb_samples)
+			return false;
+	}
+
+	for (unsigned int i = 0; i < data.size(); i++)
+		memcpy(d_ydata[i], data[i], nb_samples * sizeof(double));
+
+	onNewDataReceived();
+	replot();
+
+	return true;
+}
+
+void CapturePlot::setSegmentOverlay(const std::vector<const double *> &data,
+				    size_t nb_samples, unsigned int chnIdx)
+{
+	clearSegmentOverlay();
+
+	QwtPlotCurve *curve = Curve(chnIdx);
+	if (!curve || curve->data()->size() != nb_samples)
+		return;
+
+	/* The overlay keeps its own time axis, the one of the plot is
+	 * reallocated whenever the capture length changes */
+	d_segmentOverlayX.resize(nb_samples);
+	for (size_t i = 0; i < nb_samples; i++)
+		d_segmentOverlayX[i] = curve->sample(i).x();
+
+	QColor color = curve->pen().color();
+	color.setAlpha(60);
+
+	for (const double *y : data) {
+		if (!y)
+			continue;
+
+		QwtPlotCurve *segment = new QwtPlotCurve();
+		segment->setAxes(curve->xAxis(), curve->yAxis());
+		segment->setPen(QPen(color, 1));
+		segment->setItemAttribute(QwtPlotItem::Legend, false);
+		segment->setZ(curve->z() - 1);
+		segment->setRawSamples(d_segmentOverlayX.data(), y, nb_samples);
+		segment->attach(this);
+
+		d_segmentOverlay.push_back(segment);
+	}
+
+	replot();
+}
+
+void CapturePlot::clearSegmentOverlay()
+{
+	if (d_segmentOverlay.isEmpty())
+		return;
+
+	for (QwtPlotCurve *segment : qAsConst(d_segmentOverlay)) {
+		segment->detach();
+		delete segment;
+	}
+	d_segmentOverlay.clear();
+
+	replot();
+}
+
 QList<std::shared_ptr<MeasurementData>> CapturePlot::measurements(int chnIdx)
 {
 	Measure *measure = measureOfChannel(chnIdx);
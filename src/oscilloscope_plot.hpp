@@ -131,6 +131,14 @@ namespace adiscope {
 
 		CursorReadouts * getCursorReadouts() const;
 
+		/* Display a stored capture in place of the last one */
+		bool showSegment(const std::vector<const double *> &data,
+				 size_t nb_samples);
+		/* Draw stored captures of one channel behind its curve */
+		void setSegmentOverlay(const std::vector<const double *> &data,
+				       size_t nb_samples, unsigned int chnIdx);
+		void clearSegmentOverlay();
+
 	Q_SIGNALS:
 		void timeTriggerValueChanged(double);
 		void channelOffsetChanged(unsigned int, double);
@@ -259,6 +267,9 @@ namespace adiscope {
 
 	        QList<Measure *> d_measureObjs;
 
+		QList<QwtPlotCurve *> d_segmentOverlay;
+		QVector<double> d_segmentOverlayX;
+
 		double value_v1, value_v2, value_h1, value_h2;
 		double value_gateLeft, value_gateRight;
 		double d_minOffsetValue, d_maxOffsetValue;
@@ -23,6 +23,8 @@
 
 #include <QDebug>
 #include <QDockWidget>
+#include <QtConcurrentMap>
+#include <QElapsedTimer>
 #include "ui_pattern_generator.h"
 #include "digitalchannel_manager.hpp"
 #include "gui/dynamicWidget.hpp"
@@ -83,6 +85,10 @@ PatternGenerator::PatternGenerator(struct iio_context *ctx, Filter *filt,
 	, m_outputMode(0)
 	, m_isRunning(false)
 	, m_singleTimer(new QTimer(this))
+	, m_pushedSampleRate(0)
+	, m_pushedBufferSize(0)
+	, m_pushedChannelMask(0)
+	, m_liveUpdateLatency(0.0)
 {
 	setupUi();
 
@@ -455,9 +461,7 @@ void PatternGenerator::patternSelected(const QString &pattern, int ch, const QSt
 		patternUi->setVisible(true);
 
 		connect(patternUi, &PatternUI::patternParamsChanged,
-			this, &PatternGenerator::regenerate);
-		connect(patternUi, &PatternUI::patternParamsChanged,
-			this, &PatternGenerator::generateBuffer);
+			this, &PatternGenerator::patternParamsChanged);
 
 		bool didSet = false;
 		for (auto &ep : m_enabledPatterns) {
@@ -647,45 +651,61 @@ uint64_t PatternGenerator::computeBufferSize(uint64_t sampleRate) const
 	return bufferSize > MAX_BUFFER_SIZE ? MAX_BUFFER_SIZE : bufferSize;
 }
 
-uint16_t PatternGenerator::remapBuffer(uint8_t *mapping, uint32_t val)
+void PatternGenerator::buildRemapTable(const QVector<int> &channels,
+				       uint16_t table[2][256])
 {
-	short ret=0;
-	int i=0;
+	/* One table per input byte: entry v holds the output bits set by
+	 * the channels of that byte when their input value is v */
+	for (int byte = 0; byte < 2; ++byte) {
+		for (int v = 0; v < 256; ++v) {
+			uint16_t out = 0;
 
-	while (val) {
-		if (val&0x01) {
-			ret = ret | (1<<mapping[i]);
-		}
+			for (int bit = 0; bit < 8; ++bit) {
+				const int i = byte * 8 + bit;
 
-		i++;
-		val>>=1;
-	}
+				if (i < channels.size() && (v & (1 << bit))) {
+					out |= (1 << channels[i]);
+				}
+			}
 
-	return ret;
+			table[byte][v] = out;
+		}
+	}
 }
 
-void PatternGenerator::commitBuffer(const QPair<QVector<int>, PatternUI *> &pattern,
+void PatternGenerator::commitBuffer(const QVector<int> &channels,
+				    const short *samples,
 				    uint16_t *buffer,
 				    uint32_t bufferSize)
 {
-	uint8_t channelMapping[16];
-	memset(channelMapping, 0x00, 16 * sizeof(uint8_t));
-	short *bufferPtr = pattern.second->get_pattern()->get_buffer();
+	uint16_t remapTable[2][256];
 
 	uint16_t chgMask = 0;
 
-	auto bufferChannelMask = (1 << pattern.first.size()) - 1;
-	for (int i = 0; i < pattern.first.size(); ++i) {
-		channelMapping[i] = pattern.first[i];
-		chgMask = chgMask | (1 << pattern.first[i]);
+	for (int i = 0; i < channels.size(); ++i) {
+		chgMask = chgMask | (1 << channels[i]);
 	}
 
-	for (int i = 0; i < bufferSize; ++i) {
-		auto val = (bufferPtr[i] & bufferChannelMask);
-		buffer[i] = (buffer[i] & ~(chgMask)) | remapBuffer(channelMapping, val);
+	buildRemapTable(channels, remapTable);
+
+	for (uint32_t i = 0; i < bufferSize; ++i) {
+		const uint16_t val = samples[i];
+		buffer[i] = (buffer[i] & ~(chgMask)) |
+				remapTable[0][val & 0xff] |
+				remapTable[1][val >> 8];
 	}
 }
 
+QString PatternGenerator::patternCacheKey(const QPair<QVector<int>, PatternUI *> &pattern,
+					  uint64_t sampleRate, uint64_t bufferSize) const
+{
+	return QString("%1/%2/%3/%4")
+			.arg(Pattern_API::toString(pattern.second->get_pattern()))
+			.arg(sampleRate)
+			.arg(bufferSize)
+			.arg(pattern.first.size());
+}
+
 void PatternGenerator::checkEnabledChannels()
 {
 	bool foundOneEnabled = false;
@@ -703,12 +723,72 @@ void PatternGenerator::checkEnabledChannels()
 
 void PatternGenerator::regenerate()
 {
-	if (m_isRunning) {
+	if (!m_isRunning) {
+		return;
+	}
+
+	if (!liveUpdate()) {
 		startStop(false);
 		startStop(true);
 	}
 }
 
+uint16_t PatternGenerator::enabledChannelsMask() const
+{
+	uint16_t mask = 0;
+	for (int i = 0; i < DIGITAL_NR_CHANNELS; ++i) {
+		const bool enabled = !!m_plotCurves[i]->plot();
+		mask = mask | enabled << i;
+	}
+
+	return mask;
+}
+
+bool PatternGenerator::liveUpdate()
+{
+	/* Single shot output or a new sample rate, buffer size or set of
+	 * channels require the device to be reconfigured */
+	if (m_ui->runSingleWidget->singleButtonChecked() ||
+			m_sampleRate != m_pushedSampleRate ||
+			m_bufferSize != m_pushedBufferSize ||
+			enabledChannelsMask() != m_pushedChannelMask) {
+		return false;
+	}
+
+	/* The cyclic output keeps running the previous buffer while the
+	 * new one is generated, only the push itself interrupts it */
+	QElapsedTimer timer;
+	timer.start();
+
+	try {
+		m_m2kDigital->push(m_buffer, m_bufferSize);
+	} catch (libm2k::m2k_exception &e) {
+		HANDLE_EXCEPTION(e);
+		qDebug() << e.what();
+		return false;
+	}
+
+	m_liveUpdateLatency = timer.nsecsElapsed() / 1e6;
+	qDebug() << "Live pattern update took" << m_liveUpdateLatency << "ms";
+
+	m_plot.replot();
+
+	return true;
+}
+
+void PatternGenerator::patternParamsChanged()
+{
+	/* Some parameters (e.g. imported data) are not part of the
+	 * cache key, so always drop the output of the edited pattern */
+	PatternUI *patternUi = qobject_cast<PatternUI *>(sender());
+	if (patternUi) {
+		m_patternCache.remove(patternUi);
+	}
+
+	generateBuffer();
+	regenerate();
+}
+
 void PatternGenerator::startStop(bool start)
 {
 	qDebug() << "Started status: " << start;
@@ -721,14 +801,25 @@ void PatternGenerator::startStop(bool start)
 
 		const bool isSingle = m_ui->runSingleWidget->singleButtonChecked();
 
-		generateBuffer();
+		/* Every pattern or group change already rebuilt the buffer,
+		 * but scripts, imports and random patterns give a new
+		 * output on every run */
+		bool stale = !m_buffer;
+		for (const auto &pattern : qAsConst(m_enabledPatterns)) {
+			if (!pattern.second->get_pattern()->is_deterministic()) {
+				stale |= m_patternCache.remove(pattern.second) > 0;
+			}
+		}
+
+		if (stale) {
+			generateBuffer();
+		}
 
 		m_plot.replot();
 
-		uint16_t lockMask = 0;
+		const uint16_t lockMask = enabledChannelsMask();
 		for (int i = 0; i < DIGITAL_NR_CHANNELS; ++i) {
-			bool enabled = !!m_plotCurves[i]->plot();
-			lockMask = lockMask | enabled << i;
+			bool enabled = lockMask & (1 << i);
 			if (enabled) {
 				m_m2kDigital->setDirection(i, DIO_OUTPUT);
 			}
@@ -744,6 +835,10 @@ void PatternGenerator::startStop(bool start)
 			m_m2kDigital->setCyclic(!isSingle);
 			m_m2kDigital->push(m_buffer, m_bufferSize);
 
+			m_pushedSampleRate = m_sampleRate;
+			m_pushedBufferSize = m_bufferSize;
+			m_pushedChannelMask = lockMask;
+
 			// timeout = buffer duration for the given samplerate + 200 milliseconds usb transfer (push)
 			const double timeout = 0.2 + static_cast<double>(m_bufferSize) / static_cast<double>(m_sampleRate);
 			// * 1000.0 (timeout is in seconds, start expects milliseconds)
@@ -782,12 +877,14 @@ void PatternGenerator::generateBuffer()
 	const uint64_t sr = computeSampleRate();
 
 	qDebug() << "Sample rate is: " << sr;
+	const uint64_t previousSampleRate = m_sampleRate;
 	m_sampleRate = sr;
 
 	const uint64_t bufferSize = computeBufferSize(sr);
 	m_plot.setMaxBufferSizeErrorLabel(bufferSize == MAX_BUFFER_SIZE);
 
 	qDebug() << "Buffer size is: " << bufferSize;
+	const uint64_t previousBufferSize = m_bufferSize;
 	m_bufferSize = bufferSize;
 
 	m_plot.setSampleRatelabelValue(m_sampleRate);
@@ -796,13 +893,6 @@ void PatternGenerator::generateBuffer()
 				     static_cast<double>(m_sampleRate) /
 				     m_plot.xAxisNumDiv());
 
-	if (m_buffer) {
-		delete[] m_buffer;
-	}
-
-	m_buffer = new uint16_t[bufferSize];
-	memset(m_buffer, 0x0000, bufferSize * sizeof(uint16_t));
-
 	for (int i = 0; i < m_plotCurves.size(); ++i) {
 		QwtPlotCurve *curve = m_plot.getDigitalPlotCurve(i);
 		GenericLogicPlotCurve *logic_curve = dynamic_cast<GenericLogicPlotCurve *>(curve);
@@ -818,14 +908,106 @@ void PatternGenerator::generateBuffer()
 	m_plot.cancelZoom();
 	m_plot.zoomBaseUpdate(true);
 
-	for (QPair<QVector<int>, PatternUI *> &pattern : m_enabledPatterns) {
-		pattern.second->get_pattern()->generate_pattern(sr, bufferSize, pattern.first.size());
-		commitBuffer(pattern, m_buffer, bufferSize);
-		pattern.second->get_pattern()->delete_buffer();
+	/* Find the groups whose cached output is missing or stale */
+	struct GenerateJob {
+		Pattern *pattern;
+		uint16_t nbChannels;
+		std::vector<short> samples;
+	};
+
+	QVector<QVector<int>> groups;
+	QVector<QString> keys;
+	QVector<GenerateJob> jobs;
+	QVector<PatternUI *> staleUis;
+	for (const QPair<QVector<int>, PatternUI *> &pattern : qAsConst(m_enabledPatterns)) {
+		const QString key = patternCacheKey(pattern, sr, bufferSize);
+		groups.push_back(pattern.first);
+		keys.push_back(key);
+
+		auto it = m_patternCache.constFind(pattern.second);
+		if (it == m_patternCache.constEnd() || it->key != key) {
+			jobs.push_back({pattern.second->get_pattern(),
+					static_cast<uint16_t>(pattern.first.size()), {}});
+			staleUis.push_back(pattern.second);
+		}
+	}
+
+	auto generate = [bufferSize, sr](GenerateJob *job) {
+		job->pattern->generate_pattern(sr, bufferSize, job->nbChannels);
+		const short *generated = job->pattern->get_buffer();
+		job->samples.assign(generated, generated + bufferSize);
+		job->pattern->delete_buffer();
+	};
+
+	/* Patterns are independent of each other, generate them on the
+	 * global thread pool. The ones that are not thread safe (scripts,
+	 * random) are generated here, on the GUI thread, in the meantime. */
+	QVector<GenerateJob *> pooledJobs, localJobs;
+	for (GenerateJob &job : jobs) {
+		if (job.pattern->is_thread_safe()) {
+			pooledJobs.push_back(&job);
+		} else {
+			localJobs.push_back(&job);
+		}
+	}
+
+	QFuture<void> pooled = QtConcurrent::map(pooledJobs, generate);
+	for (GenerateJob *job : qAsConst(localJobs)) {
+		generate(job);
+	}
+	pooled.waitForFinished();
+
+	for (int i = 0; i < jobs.size(); ++i) {
+		PatternCacheEntry &entry = m_patternCache[staleUis[i]];
+		entry.samples.swap(jobs[i].samples);
+	}
+
+	/* Forget the output of patterns that are no longer enabled */
+	auto it = m_patternCache.begin();
+	while (it != m_patternCache.end()) {
+		bool enabled = false;
+		for (const auto &pattern : qAsConst(m_enabledPatterns)) {
+			if (pattern.second == it.key()) {
+				enabled = true;
+				break;
+			}
+		}
+		it = enabled ? it + 1 : m_patternCache.erase(it);
+	}
+
+	/* If the layout did not change only the regenerated groups need to
+	 * be committed on top of the current output */
+	const bool incremental = m_buffer && groups == m_committedGroups &&
+			bufferSize == previousBufferSize && sr == previousSampleRate;
+
+	uint16_t *buffer = new uint16_t[bufferSize];
+	if (incremental) {
+		memcpy(buffer, m_buffer, bufferSize * sizeof(uint16_t));
+	} else {
+		memset(buffer, 0x0000, bufferSize * sizeof(uint16_t));
+	}
+
+	for (int i = 0; i < m_enabledPatterns.size(); ++i) {
+		const QPair<QVector<int>, PatternUI *> &pattern = m_enabledPatterns[i];
+		PatternCacheEntry &entry = m_patternCache[pattern.second];
+
+		if (!incremental || staleUis.contains(pattern.second)) {
+			commitBuffer(pattern.first, entry.samples.data(), buffer, bufferSize);
+		}
+
+		entry.key = keys[i];
 		updateAnnotationCurveChannelsForPattern(pattern);
 		pattern.second->get_pattern()->setNrOfChannels(pattern.first.size());
 	}
 
+	/* Swap in the complete buffer in one step */
+	std::swap(m_buffer, buffer);
+	delete[] buffer;
+	m_committedGroups = groups;
+
+	/* The plot curves and decoders read the buffer through the store */
+	m_captureStore.assign(m_buffer, bufferSize);
+
 	Q_EMIT dataAvailable(0, bufferSize);
 }
 
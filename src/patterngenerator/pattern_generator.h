@@ -38,6 +38,9 @@
 #include <QQueue>
 #include <QTimer>
 #include <QMap>
+#include <QVector>
+
+#include <vector>
 
 using namespace libm2k;
 using namespace libm2k::digital;
@@ -84,6 +87,7 @@ private Q_SLOTS:
 	void patternSelected(const QString& pattern, int ch = -1, const QString &json = {});
 	void on_btnOutputMode_toggled(bool);
 	void regenerate();
+	void patternParamsChanged();
 	void readPreferences();
 
 private:
@@ -101,11 +105,17 @@ private:
 	void loadTriggerMenu();
 	uint64_t computeSampleRate() const;
 	uint64_t computeBufferSize(uint64_t sampleRate) const;
-	uint16_t remapBuffer(uint8_t *mapping, uint32_t val);
-	void commitBuffer(const QPair<QVector<int>, PatternUI *> &pattern,
+	void buildRemapTable(const QVector<int> &channels,
+			     uint16_t table[2][256]);
+	void commitBuffer(const QVector<int> &channels,
+			  const short *samples,
 			  uint16_t *buffer,
 			  uint32_t bufferSize);
+	QString patternCacheKey(const QPair<QVector<int>, PatternUI *> &pattern,
+				uint64_t sampleRate, uint64_t bufferSize) const;
 	void checkEnabledChannels();
+	uint16_t enabledChannelsMask() const;
+	bool liveUpdate();
 	void removeAnnotationCurveOfPattern(PatternUI *pattern);
 	void updateAnnotationCurveChannelsForPattern(const QPair<QVector<int>, PatternUI *> &pattern);
 
@@ -140,7 +150,22 @@ private:
 
 	QTimer *m_singleTimer;
 
+	/* Device configuration of the buffer currently being output */
+	uint64_t m_pushedSampleRate;
+	uint64_t m_pushedBufferSize;
+	uint16_t m_pushedChannelMask;
+	double m_liveUpdateLatency;
+
 	QMap<PatternUI*, QPair<GenericLogicPlotCurve*, QMetaObject::Connection>> m_annotationCurvePatternUiMap;
+
+	/* Generated output of each enabled pattern, reused until its
+	 * parameters, the sample rate or the buffer size change */
+	struct PatternCacheEntry {
+		QString key;
+		std::vector<short> samples;
+	};
+	QMap<PatternUI *, PatternCacheEntry> m_patternCache;
+	QVector<QVector<int>> m_committedGroups;
 };
 
 } // namespace logic
@@ -144,6 +144,12 @@ QString logic::PatternGenerator_API::getNotes()
 {
 	return m_pattern->m_ui->instrumentNotes->getNotes();
 }
+
+double logic::PatternGenerator_API::getLiveUpdateLatency() const
+{
+	return m_pattern->m_liveUpdateLatency;
+}
+
 void logic::PatternGenerator_API::setNotes(QString str)
 {
 	m_pattern->m_ui->instrumentNotes->setNotes(str);
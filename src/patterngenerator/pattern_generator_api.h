@@ -48,6 +48,9 @@ class PatternGenerator_API : public ApiObject
 
 	Q_PROPERTY(QString notes READ getNotes WRITE setNotes)
 
+	/* duration of the last live buffer switch, in milliseconds */
+	Q_PROPERTY(double liveUpdateLatency READ getLiveUpdateLatency STORED false)
+
 
 public:
 	explicit PatternGenerator_API(logic::PatternGenerator *pattern)
@@ -85,6 +88,8 @@ public:
 	void setEnabledPatterns(const QVector<QPair<QVector<int>, QString>> &enabledPatterns);
 
 	QString getNotes();
+
+	double getLiveUpdateLatency() const;
 	void setNotes(QString);
 
 private:
@@ -37,6 +37,8 @@
 #include "gui/dynamicWidget.hpp"
 
 #include <math.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace std;
 using namespace adiscope;
@@ -104,6 +106,16 @@ bool Pattern::is_periodic()
 	return periodic;
 }
 
+bool Pattern::is_thread_safe()
+{
+	return true;
+}
+
+bool Pattern::is_deterministic()
+{
+	return true;
+}
+
 void Pattern::set_periodic(bool periodic_)
 {
 	periodic=periodic_;
@@ -829,6 +841,17 @@ void RandomPattern::set_frequency(const uint32_t& value)
 	frequency = value;
 }
 
+/* rand() shares its state between threads */
+bool RandomPattern::is_thread_safe()
+{
+	return false;
+}
+
+bool RandomPattern::is_deterministic()
+{
+	return false;
+}
+
 uint8_t RandomPattern::generate_pattern(uint32_t sample_rate,
 					uint32_t number_of_samples, uint16_t number_of_channels)
 {
@@ -2537,6 +2560,17 @@ bool JSPattern::is_periodic()
 	return 0;
 }
 
+/* The script engine and the script's widgets belong to the GUI thread */
+bool JSPattern::is_thread_safe()
+{
+	return false;
+}
+
+bool JSPattern::is_deterministic()
+{
+	return false;
+}
+
 uint8_t JSPattern::pre_generate()
 {
 	QString fileName(obj["filepath"].toString() +
@@ -2607,24 +2641,92 @@ void JSPattern::JSErrorDialog(QString errorMessage)
 	qDebug()<<"JSErrorDialog: "<<errorMessage;
 }
 
-void JSPattern::commitBuffer(QJSValue jsBufferValue, QJSValue jsBufferSize)
+bool JSPattern::commitTypedBuffer(QJSValue jsBufferValue, int size)
 {
-	if (!jsBufferValue.isArray()) {
-		qDebug()<<"Not an array";
-		return;
+	/* Typed arrays expose their storage through "buffer"; a bare
+	 * ArrayBuffer is taken as 16 bit samples */
+	QJSValue arrayBuffer = jsBufferValue;
+	int byteOffset = 0;
+	int bytesPerElement = sizeof(short);
+
+	if (jsBufferValue.hasProperty("BYTES_PER_ELEMENT")) {
+		const QString type = jsBufferValue.property("constructor")
+				.property("name").toString();
+
+		if (type.startsWith("Float")) {
+			return false;
+		}
+
+		arrayBuffer = jsBufferValue.property("buffer");
+		byteOffset = jsBufferValue.property("byteOffset").toInt();
+		bytesPerElement = jsBufferValue.property("BYTES_PER_ELEMENT").toInt();
 	}
 
+	const QVariant data = arrayBuffer.toVariant();
+	if (data.type() != QVariant::ByteArray) {
+		return false;
+	}
+
+	const QByteArray bytes = data.toByteArray();
+	const char *src = bytes.constData() + byteOffset;
+	const int available = std::max(0, (bytes.size() - byteOffset) / bytesPerElement);
+	const int count = std::min(size, available);
+
+	delete_buffer();
+	buffer = new short[size];
+
+	switch (bytesPerElement) {
+	case 1:
+		for (int i = 0; i < count; i++) {
+			buffer[i] = reinterpret_cast<const uint8_t *>(src)[i];
+		}
+		break;
+	case 2:
+		memcpy(buffer, src, count * sizeof(short));
+		break;
+	case 4:
+		for (int i = 0; i < count; i++) {
+			int32_t val;
+			memcpy(&val, src + i * sizeof(val), sizeof(val));
+			buffer[i] = val;
+		}
+		break;
+	default:
+		delete_buffer();
+		return false;
+	}
+
+	memset(buffer + count, 0, (size - count) * sizeof(short));
+
+	return true;
+}
+
+void JSPattern::commitBuffer(QJSValue jsBufferValue, QJSValue jsBufferSize)
+{
 	if (!jsBufferSize.isNumber()) {
 		qDebug()<<"Not a valid size";
 		return;
 	}
 
+	const int size = jsBufferSize.toInt();
+
+	if (size > 0 && commitTypedBuffer(jsBufferValue, size)) {
+		return;
+	}
+
+	if (!jsBufferValue.isArray() &&
+			!jsBufferValue.hasProperty("BYTES_PER_ELEMENT")) {
+		qDebug()<<"Not an array";
+		return;
+	}
+
 	delete_buffer();
-	buffer = new short[jsBufferSize.toInt()];
+	buffer = new short[size];
 
-	for (auto i=0; i<jsBufferSize.toInt(); i++) {
-		if (!jsBufferValue.property(i).isError()) {
-			auto val = jsBufferValue.property(i).toInt();
+	for (auto i=0; i<size; i++) {
+		QJSValue element = jsBufferValue.property(i);
+		if (!element.isError()) {
+			auto val = element.toInt();
 			buffer[i] = val;
 		} else {
 			buffer[i] = 0;
@@ -3475,6 +3577,12 @@ ImportPattern::~ImportPattern()
 
 }
 
+/* The imported data can change between runs */
+bool ImportPattern::is_deterministic()
+{
+	return false;
+}
+
 uint8_t ImportPattern::generate_pattern(uint32_t sample_rate,
 				       uint32_t number_of_samples, uint16_t number_of_channels)
 {
@@ -147,6 +147,10 @@ public:
 	virtual void init();
 	virtual uint8_t pre_generate();
 	virtual bool is_periodic();
+	/* False when generate_pattern() must run on the GUI thread */
+	virtual bool is_thread_safe();
+	/* False when two runs with the same parameters can differ */
+	virtual bool is_deterministic();
 	virtual uint32_t get_min_sampling_freq();
 	virtual uint32_t get_required_nr_of_samples(uint32_t sample_rate,
 	                uint32_t number_of_channels);
@@ -259,6 +263,8 @@ public:
 	                                    uint32_t number_of_channels);
 	uint8_t generate_pattern(uint32_t sample_rate, uint32_t number_of_samples,
 	                         uint16_t number_of_channels);
+	bool is_thread_safe();
+	bool is_deterministic();
 
 	uint32_t get_frequency() const;
 	void set_frequency(const uint32_t& value);
@@ -642,7 +648,10 @@ public:
 	/*Q_INVOKABLE*/ void JSErrorDialog(QString errorMessage);
 	/*Q_INVOKABLE*/ void commitBuffer(QJSValue jsBufferValue,
 	                                  QJSValue jsBufferSize);
+	bool commitTypedBuffer(QJSValue jsBufferValue, int size);
 	bool is_periodic();
+	bool is_thread_safe();
+	bool is_deterministic();
 	uint32_t get_min_sampling_freq();
 	uint32_t get_required_nr_of_samples();
 	void init();
@@ -872,6 +881,7 @@ public:
 	virtual ~ImportPattern();
 	uint8_t generate_pattern(uint32_t sample_rate, uint32_t number_of_samples,
 				 uint16_t number_of_channels);
+	bool is_deterministic();
 	float get_frequency() const;
 	void set_frequency(float value);
 	uint32_t get_min_sampling_freq();
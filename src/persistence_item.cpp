@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "persistence_item.hpp"
+
+#include <qwt_plot.h>
+#include <qwt_scale_map.h>
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace adiscope;
+
+PersistenceItem::PersistenceItem(const QwtText &title, int width, int height) :
+	QwtPlotItem(title),
+	m_width(width),
+	m_height(height),
+	m_hits(width * height, 0.0f),
+	m_max(0.0f),
+	m_decay(0.9),
+	m_color(Qt::yellow),
+	m_lut(256),
+	m_image(width, height, QImage::Format_ARGB32_Premultiplied),
+	m_dirty(true)
+{
+	setItemAttribute(QwtPlotItem::AutoScale, false);
+	setItemAttribute(QwtPlotItem::Legend, false);
+	setZ(10);
+
+	buildLut();
+}
+
+PersistenceItem::~PersistenceItem()
+{
+}
+
+int PersistenceItem::rtti() const
+{
+	return QwtPlotItem::Rtti_PlotUserItem + 1;
+}
+
+void PersistenceItem::setColor(const QColor &color)
+{
+	if (m_color == color) {
+		return;
+	}
+
+	m_color = color;
+	buildLut();
+	m_dirty = true;
+	itemChanged();
+}
+
+QColor PersistenceItem::color() const
+{
+	return m_color;
+}
+
+void PersistenceItem::setDecay(double decay)
+{
+	m_decay = std::max(0.0, std::min(decay, 1.0));
+}
+
+double PersistenceItem::decay() const
+{
+	return m_decay;
+}
+
+void PersistenceItem::clear()
+{
+	std::fill(m_hits.begin(), m_hits.end(), 0.0f);
+	m_max = 0.0f;
+	m_dirty = true;
+}
+
+/* The color map goes from transparent through the channel color, and
+ * saturates towards white for the most frequently hit pixels. */
+void PersistenceItem::buildLut()
+{
+	m_lut[0] = qPremultiply(qRgba(0, 0, 0, 0));
+
+	for (int i = 1; i < 256; i++) {
+		const double t = i / 255.0;
+		const double w = std::max(0.0, (t - 0.75) / 0.25);
+		const int r = m_color.red() + (255 - m_color.red()) * w;
+		const int g = m_color.green() + (255 - m_color.green()) * w;
+		const int b = m_color.blue() + (255 - m_color.blue()) * w;
+		const int a = 48 + 207 * std::min(1.0, t / 0.75);
+
+		m_lut[i] = qPremultiply(qRgba(r, g, b, a));
+	}
+}
+
+void PersistenceItem::hitSpan(int col, double row0, double row1)
+{
+	double lo = std::min(row0, row1);
+	double hi = std::max(row0, row1);
+
+	if (!(hi >= 0.0 && lo < m_height)) {
+		return;
+	}
+
+	const int first = static_cast<int>(std::max(lo, 0.0));
+	const int last = static_cast<int>(std::min(hi, m_height - 1.0));
+	float *hits = m_hits.data() + col;
+
+	for (int row = first; row <= last; row++) {
+		float &v = hits[row * m_width];
+
+		v += 1.0f;
+		if (v > m_max) {
+			m_max = v;
+		}
+	}
+}
+
+void PersistenceItem::addFrame(const double *x, const double *y,
+			       size_t nb_points, bool connect)
+{
+	if (!plot() || !nb_points) {
+		return;
+	}
+
+	const QwtInterval xi = plot()->axisInterval(xAxis()).normalized();
+	const QwtInterval yi = plot()->axisInterval(yAxis()).normalized();
+
+	/* Accumulated hits are only meaningful for the area they were
+	 * rasterized for */
+	if (xi != m_xInterval || yi != m_yInterval) {
+		m_xInterval = xi;
+		m_yInterval = yi;
+		clear();
+	} else if (m_decay < 1.0) {
+		const float decay = m_decay;
+
+		for (float &v : m_hits) {
+			v *= decay;
+		}
+		m_max *= decay;
+	}
+
+	if (xi.width() <= 0.0 || yi.width() <= 0.0) {
+		return;
+	}
+
+	const double sx = m_width / xi.width();
+	const double sy = m_height / yi.width();
+	const double x0 = xi.minValue();
+	const double y0 = yi.maxValue();
+
+	auto column = [=](double v) {
+		return std::max(-1.0, std::min((v - x0) * sx, double(m_width)));
+	};
+	auto row = [=](double v) {
+		return (y0 - v) * sy;
+	};
+
+	if (!connect) {
+		for (size_t i = 0; i < nb_points; i++) {
+			const int col = std::floor(column(x[i]));
+
+			if (col >= 0 && col < m_width) {
+				const double r = row(y[i]);
+				hitSpan(col, r, r);
+			}
+		}
+
+		m_dirty = true;
+		return;
+	}
+
+	double pc = column(x[0]);
+	double pr = row(y[0]);
+
+	for (size_t i = 1; i < nb_points; i++) {
+		double c = column(x[i]);
+		double r = row(y[i]);
+		double c0 = pc, r0 = pr, c1 = c, r1 = r;
+
+		pc = c;
+		pr = r;
+
+		if (c1 < c0) {
+			std::swap(c0, c1);
+			std::swap(r0, r1);
+		}
+
+		const int first = std::floor(c0);
+		const int last = std::floor(c1);
+
+		if (first == last) {
+			if (first >= 0 && first < m_width) {
+				hitSpan(first, r0, r1);
+			}
+			continue;
+		}
+
+		/* Fill each column crossed by the segment with the range
+		 * of rows the segment covers within that column */
+		const double slope = (r1 - r0) / (c1 - c0);
+		const int end = std::min(last, m_width - 1);
+
+		for (int col = std::max(first, 0); col <= end; col++) {
+			const double ra = r0 + slope * (std::max(double(col), c0) - c0);
+			const double rb = r0 + slope * (std::min(col + 1.0, c1) - c0);
+
+			hitSpan(col, ra, rb);
+		}
+	}
+
+	if (nb_points == 1) {
+		const int col = std::floor(pc);
+
+		if (col >= 0 && col < m_width) {
+			hitSpan(col, pr, pr);
+		}
+	}
+
+	m_dirty = true;
+}
+
+void PersistenceItem::draw(QPainter *painter, const QwtScaleMap &xMap,
+			   const QwtScaleMap &yMap, const QRectF &) const
+{
+	if (m_max <= 0.0f || !m_xInterval.isValid() || !m_yInterval.isValid()) {
+		return;
+	}
+
+	if (m_dirty) {
+		/* Logarithmic grading keeps rarely hit pixels visible next
+		 * to the ones hit on every frame */
+		const float scale = 255.0f / std::log1p(m_max);
+		const QRgb *lut = m_lut.constData();
+		const float *hits = m_hits.constData();
+
+		for (int row = 0; row < m_height; row++) {
+			QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(row));
+
+			for (int col = 0; col < m_width; col++) {
+				const float v = *hits++;
+				int idx = 0;
+
+				if (v > 0.0f) {
+					idx = std::min(255, std::max(1,
+						int(std::log1p(v) * scale)));
+				}
+				line[col] = lut[idx];
+			}
+		}
+
+		m_dirty = false;
+	}
+
+	const double left = xMap.transform(m_xInterval.minValue());
+	const double right = xMap.transform(m_xInterval.maxValue());
+	const double top = yMap.transform(m_yInterval.maxValue());
+	const double bottom = yMap.transform(m_yInterval.minValue());
+
+	painter->drawImage(QRectF(left, top, right - left, bottom - top),
+			   m_image);
+}
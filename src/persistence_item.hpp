@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERSISTENCE_ITEM_HPP
+#define PERSISTENCE_ITEM_HPP
+
+#include <qwt_interval.h>
+#include <qwt_plot_item.h>
+
+#include <QColor>
+#include <QImage>
+#include <QVector>
+
+namespace adiscope {
+/* Intensity graded persistence layer. Every frame is rasterized into a
+ * hit count buffer covering the visible area of the item's axes; older
+ * frames fade by a constant factor per frame. The buffer is colored
+ * through a lookup table and drawn as one image, so the cost of a
+ * replot does not depend on the number of accumulated frames. */
+class PersistenceItem : public QwtPlotItem
+{
+public:
+	explicit PersistenceItem(const QwtText &title = QwtText(),
+				 int width = 640, int height = 320);
+	virtual ~PersistenceItem();
+
+	virtual int rtti() const;
+
+	void setColor(const QColor &color);
+	QColor color() const;
+
+	/* Weight kept by the accumulated hits on each new frame:
+	 * 1.0 means infinite persistence, 0.0 keeps only the last frame */
+	void setDecay(double decay);
+	double decay() const;
+
+	void clear();
+
+	/* Accumulate one frame. When connect is set the vertical span
+	 * between consecutive points is filled as well, otherwise only
+	 * the points themselves are counted (XY/constellation mode). */
+	void addFrame(const double *x, const double *y, size_t nb_points,
+		      bool connect);
+
+	virtual void draw(QPainter *painter, const QwtScaleMap &xMap,
+			  const QwtScaleMap &yMap,
+			  const QRectF &canvasRect) const;
+
+private:
+	int m_width;
+	int m_height;
+	QVector<float> m_hits;
+	float m_max;
+	double m_decay;
+	QColor m_color;
+	QVector<QRgb> m_lut;
+	QwtInterval m_xInterval;
+	QwtInterval m_yInterval;
+
+	mutable QImage m_image;
+	mutable bool m_dirty;
+
+	void buildLut();
+	void hitSpan(int col, double row0, double row1);
+};
+}
+
+#endif /* PERSISTENCE_ITEM_HPP */
@@ -71,6 +71,7 @@ Preferences::Preferences(QWidget *parent) :
 	m_debug_messages_active(false),
 	m_attemptTempLutCalib(false),
 	m_skipCalIfCalibrated(true),
+	m_useCalibCache(false),
 	automatical_version_checking_enabled(false),
 	first_application_run(true),
 	check_updates_url("http://swdownloads.analog.com/cse/sw_versions.json"),
@@ -173,6 +174,11 @@ Preferences::Preferences(QWidget *parent) :
 		Q_EMIT notify();
 	});
 
+	connect(ui->calibCacheCheckbox, &QCheckBox::stateChanged, [=](int state) {
+		m_useCalibCache = (!state ? false : true);
+		Q_EMIT notify();
+	});
+
 	connect(ui->enableLoggingCheckBox, &QCheckBox::stateChanged, [=](int state) {
 		m_logging_enabled = !!state;
 		Q_EMIT notify();
@@ -438,6 +444,7 @@ void Preferences::initializePreferences()
 	ui->debugInstrumentCheckbox->setChecked(debugger_enabled);
 	ui->tempLutCalibCheckbox->setChecked(m_attemptTempLutCalib);
 	ui->skipCalCheckbox->setChecked(m_skipCalIfCalibrated);
+	ui->calibCacheCheckbox->setChecked(m_useCalibCache);
 	ui->showPlotFps->setChecked(m_show_plot_fps);
 	ui->useOpenGl->setChecked(m_use_open_gl);
 	ui->cmbPlotTargetFps->setCurrentText(QString::number(m_target_fps));
@@ -748,6 +755,15 @@ void Preferences::setSkipCalIfCalibrated(bool val)
 {
 	m_skipCalIfCalibrated = val;
 }
+
+bool Preferences::getUseCalibCache() const
+{
+	return m_useCalibCache;
+}
+void Preferences::setUseCalibCache(bool val)
+{
+	m_useCalibCache = val;
+}
 bool Preferences::getAutomatical_version_checking_enabled() const
 {
 	return automatical_version_checking_enabled;
@@ -1000,6 +1016,15 @@ void Preferences_API::setSkipCalIfCalibrated(bool val)
 	preferencePanel->m_skipCalIfCalibrated = val;
 }
 
+bool Preferences_API::getUseCalibCache() const
+{
+	return preferencePanel->m_useCalibCache;
+}
+void Preferences_API::setUseCalibCache(bool val)
+{
+	preferencePanel->m_useCalibCache = val;
+}
+
 QString Preferences_API::getCurrentStylesheet() const
 {
 	if (!preferencePanel->m_colorEditor) {
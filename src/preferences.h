@@ -126,6 +126,9 @@ public:
 	bool getSkipCalIfCalibrated() const;
 	void setSkipCalIfCalibrated(bool val);
 
+	bool getUseCalibCache() const;
+	void setUseCalibCache(bool val);
+
 	bool getAutomatical_version_checking_enabled() const;
 	void setAutomatical_version_checking_enabled(bool value);
 
@@ -206,6 +209,7 @@ private:
 	bool m_debug_messages_active;
 	bool m_attemptTempLutCalib;
 	bool m_skipCalIfCalibrated;
+	bool m_useCalibCache;
 	bool m_logging_enabled;
 	bool m_show_plot_fps;
 	bool m_use_open_gl;
@@ -246,6 +250,7 @@ class Preferences_API : public ApiObject
 	Q_PROPERTY(bool debug_messages_active READ getDebugMessagesActive WRITE setDebugMessagesActive)
 	Q_PROPERTY(bool attemptTempLutCalib READ getAttemptTempLutCalib WRITE setAttemptTempLutCalib)
 	Q_PROPERTY(bool skipCalIfCalibrated READ getSkipCalIfCalibrated WRITE setSkipCalIfCalibrated)
+	Q_PROPERTY(bool useCalibCache READ getUseCalibCache WRITE setUseCalibCache)
 	Q_PROPERTY(bool automatical_version_checking_enabled READ getAutomaticalVersionCheckingEnabled WRITE setAutomaticalVersionCheckingEnabled)
 	Q_PROPERTY(QString check_updates_url READ getCheckUpdatesUrl WRITE setCheckUpdatesUrl)
 	Q_PROPERTY(bool first_application_run READ getFirstApplicationRun WRITE setFirstApplicationRun)
@@ -329,6 +334,9 @@ public:
 	bool getSkipCalIfCalibrated() const;
 	void setSkipCalIfCalibrated(bool val);
 
+	bool getUseCalibCache() const;
+	void setUseCalibCache(bool val);
+
 	bool getAutomaticalVersionCheckingEnabled() const;
 	void setAutomaticalVersionCheckingEnabled(const bool& enabled);
 
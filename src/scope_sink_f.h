@@ -50,14 +50,33 @@
 #include <gnuradio/sync_block.h>
 #include <qapplication.h>
 
+#include <functional>
+
 namespace adiscope {
 
+    class MaskTest;
+
+    enum acquisition_mode {
+      ACQ_MODE_NORMAL,
+      ACQ_MODE_AVERAGE,		// exponential average of the triggered frames,
+				// weight 1/N once N frames were seen (the
+				// plain mean of the frames until then)
+      ACQ_MODE_PEAK_DETECT,	// min/max envelope of every N samples
+      ACQ_MODE_HIGH_RES,	// boxcar average of every N samples
+    };
+
     class scope_sink_f : virtual public gr::sync_block
     {
     public:
       // adiscope::scope_sink_f::sptr
       typedef boost::shared_ptr<scope_sink_f> sptr;
 
+      // Called from the flowgraph thread with every complete frame, one
+      // pointer per input, including the frames dropped by the update
+      // time. The data is only valid during the call.
+      typedef std::function<void(const std::vector<const float *> &frames,
+				 int nitems)> frame_callback;
+
       static sptr make(int size, double samp_rate,
 		       const std::string &name,
 		       int nconnections=1,
@@ -71,6 +90,14 @@ namespace adiscope {
 
       virtual void set_trigger_mode(trigger_mode mode, int channel,
 				    const std::string &tag_key="") = 0;
+      virtual void set_acquisition_mode(acquisition_mode mode,
+					unsigned int factor) = 0;
+      virtual void set_mask_test(MaskTest *mask) = 0;
+      virtual void set_frame_callback(frame_callback callback) = 0;
+
+      // When enabled, the frames dropped by the update time are still
+      // sent to the plot to be accumulated into its persistence layer
+      virtual void set_persistence(bool en) = 0;
 
       virtual int nsamps() const = 0;
       virtual std::string name() const = 0;
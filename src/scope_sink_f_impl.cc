@@ -48,11 +48,13 @@
 #include <gnuradio/buffer.h>
 #include <gnuradio/prefs.h>
 #include <string.h>
+#include <algorithm>
 #include <volk/volk.h>
 #include <gnuradio/fft/fft.h>
 #include <qwt_symbol.h>
 
 #include "scope_sink_f_impl.h"
+#include "mask_test.hpp"
 
 using namespace gr;
 
@@ -76,22 +78,18 @@ namespace adiscope {
                    io_signature::make(nconnections, nconnections, sizeof(float)),
                    io_signature::make(0, 0, 0)),
 	d_size(size), d_buffer_size(2*size), d_samp_rate(samp_rate), d_name(name),
-	d_nconnections(nconnections), d_index(0), d_start(0), d_end(size)
+	d_nconnections(nconnections), d_index(0), d_start(0), d_end(size),
+	d_acq_mode(ACQ_MODE_NORMAL), d_acq_factor(1), d_avg_count(0),
+	d_mask_test(nullptr), d_persistence(false)
     {
+      d_buffers.resize(d_nconnections);
+      d_fbuffers.resize(d_nconnections);
+      d_avg_buffers.resize(d_nconnections);
+      d_frames.resize(d_nconnections);
+      _alloc_buffers();
 
-
-      for(int n = 0; n < d_nconnections; n++) {
-	d_buffers.push_back((double*)volk_malloc(d_buffer_size*sizeof(double),
-                                                 volk_get_alignment()));
-	memset(d_buffers[n], 0, d_buffer_size*sizeof(double));
-
-	d_fbuffers.push_back((float*)volk_malloc(d_buffer_size*sizeof(float),
-                                                  volk_get_alignment()));
-	memset(d_fbuffers[n], 0, d_buffer_size*sizeof(float));
-
-        d_displayOneBuffer = true;
-        d_cleanBuffers = true;
-      }
+      d_displayOneBuffer = true;
+      d_cleanBuffers = true;
 
       // Set alignment properties for VOLK
       const int alignment_multiple =
@@ -115,10 +113,37 @@ namespace adiscope {
     }
 
     scope_sink_f_impl::~scope_sink_f_impl()
+    {
+      _free_buffers();
+    }
+
+    void
+    scope_sink_f_impl::_alloc_buffers()
+    {
+      for(int n = 0; n < d_nconnections; n++) {
+	d_buffers[n] = (double*)volk_malloc(d_buffer_size*sizeof(double),
+					    volk_get_alignment());
+	memset(d_buffers[n], 0, d_buffer_size*sizeof(double));
+
+	d_fbuffers[n] = (float*)volk_malloc(d_buffer_size*sizeof(float),
+					    volk_get_alignment());
+	memset(d_fbuffers[n], 0, d_buffer_size*sizeof(float));
+
+	d_avg_buffers[n] = (float*)volk_malloc(d_size*sizeof(float),
+					       volk_get_alignment());
+	memset(d_avg_buffers[n], 0, d_size*sizeof(float));
+      }
+
+      d_avg_count = 0;
+    }
+
+    void
+    scope_sink_f_impl::_free_buffers()
     {
       for(int n = 0; n < d_nconnections; n++) {
 	volk_free(d_buffers[n]);
 	volk_free(d_fbuffers[n]);
+	volk_free(d_avg_buffers[n]);
       }
     }
 
@@ -167,6 +192,82 @@ namespace adiscope {
       _reset();
     }
 
+    void
+    scope_sink_f_impl::set_acquisition_mode(acquisition_mode mode,
+					    unsigned int factor)
+    {
+      gr::thread::scoped_lock lock(d_setlock);
+      d_acq_mode = mode;
+      d_acq_factor = std::max(factor, 1u);
+      d_avg_count = 0;
+    }
+
+    void
+    scope_sink_f_impl::set_mask_test(MaskTest *mask)
+    {
+      gr::thread::scoped_lock lock(d_setlock);
+      d_mask_test = mask;
+      if (mask)
+	d_mask_frames.assign(mask->channelCount(), nullptr);
+    }
+
+    void
+    scope_sink_f_impl::set_frame_callback(frame_callback callback)
+    {
+      gr::thread::scoped_lock lock(d_setlock);
+      d_frame_callback = callback;
+    }
+
+    void
+    scope_sink_f_impl::set_persistence(bool en)
+    {
+      gr::thread::scoped_lock lock(d_setlock);
+      d_persistence = en;
+    }
+
+    const float *
+    scope_sink_f_impl::_process_frame(int n, float *frame, int nitems,
+				      float avg_weight)
+    {
+      const int factor = d_acq_factor;
+
+      switch (d_acq_mode) {
+      case ACQ_MODE_AVERAGE: {
+	// avg = avg * (1 - w) + frame * w, with w = 1 / min(frames, N)
+	float *avg = d_avg_buffers[n];
+	if (avg_weight >= 1.0f) {
+	  memcpy(avg, frame, nitems*sizeof(float));
+	} else {
+	  volk_32f_s32f_multiply_32f(frame, frame, avg_weight, nitems);
+	  volk_32f_s32f_multiply_32f(avg, avg, 1.0f - avg_weight, nitems);
+	  volk_32f_x2_add_32f(avg, avg, frame, nitems);
+	}
+	return avg;
+      }
+      case ACQ_MODE_PEAK_DETECT:
+	// Each block is drawn as min, max, min, ... so that the line
+	// covers the whole envelope even when the plot skips samples
+	for (int i = 0; i < nitems; i += factor) {
+	  const int len = std::min(factor, nitems - i);
+	  auto mm = std::minmax_element(&frame[i], &frame[i + len]);
+	  const float lo = *mm.first, hi = *mm.second;
+	  for (int j = 0; j < len; j++)
+	    frame[i + j] = (j & 1) ? hi : lo;
+	}
+	return frame;
+      case ACQ_MODE_HIGH_RES:
+	for (int i = 0; i < nitems; i += factor) {
+	  const int len = std::min(factor, nitems - i);
+	  float sum;
+	  volk_32f_accumulator_s32f(&sum, &frame[i], len);
+	  std::fill_n(&frame[i], len, sum / len);
+	}
+	return frame;
+      default:
+	return frame;
+      }
+    }
+
     void
     scope_sink_f_impl::set_nsamps(const int newsize)
     {
@@ -179,17 +280,8 @@ namespace adiscope {
         d_buffer_size = 2*d_size;
 
 	// Resize buffers and replace data
-	for(int n = 0; n < d_nconnections; n++) {
-	  volk_free(d_buffers[n]);
-	  d_buffers[n] = (double*)volk_malloc(d_buffer_size*sizeof(double),
-                                              volk_get_alignment());
-	  memset(d_buffers[n], 0, d_buffer_size*sizeof(double));
-
-	  volk_free(d_fbuffers[n]);
-	  d_fbuffers[n] = (float*)volk_malloc(d_buffer_size*sizeof(float),
-                                               volk_get_alignment());
-	  memset(d_fbuffers[n], 0, d_buffer_size*sizeof(float));
-	}
+	_free_buffers();
+	_alloc_buffers();
 
         _reset();
       }
@@ -298,17 +390,8 @@ namespace adiscope {
             d_buffer_size = 2*d_size;
 
             // Resize buffers and replace data
-            for(int n = 0; n < d_nconnections; n++) {
-                    volk_free(d_buffers[n]);
-                    d_buffers[n] = (double*)volk_malloc(d_buffer_size*sizeof(double),
-                                                        volk_get_alignment());
-                    memset(d_buffers[n], 0, d_buffer_size*sizeof(double));
-
-                    volk_free(d_fbuffers[n]);
-                    d_fbuffers[n] = (float*)volk_malloc(d_buffer_size*sizeof(float),
-                                                        volk_get_alignment());
-                    memset(d_fbuffers[n], 0, d_buffer_size*sizeof(float));
-            }
+            _free_buffers();
+            _alloc_buffers();
 
             _reset();
             d_cleanBuffers = true;
@@ -362,6 +445,10 @@ namespace adiscope {
       // If we've have a full d_size of items in the buffers, plot.
       if((d_end != 0 && !d_displayOneBuffer) ||
                       ((d_triggered) && (d_index == d_end) && d_end != 0 && d_displayOneBuffer)) {
+              // Weight of the new frame when averaging
+              const unsigned int nframes = std::min(d_avg_count + 1, d_acq_factor);
+              const float avg_weight = 1.0f / nframes;
+
               // Copy data to be plotted to start of buffers.
               for(n = 0; n < d_nconnections; n++) {
                       if (!d_displayOneBuffer) {
@@ -373,14 +460,39 @@ namespace adiscope {
                               volk_32f_convert_64f(d_buffers[n], &d_fbuffers[n][d_start], nItemsToSend);
                       } else {
                               //memmove(d_buffers[n], &d_buffers[n][d_start], d_size*sizeof(double));
-                              volk_32f_convert_64f(d_buffers[n], &d_fbuffers[n][d_start], d_size);
+                              const float *frame = _process_frame(n,
+                                              &d_fbuffers[n][d_start], d_size, avg_weight);
+                              volk_32f_convert_64f(d_buffers[n], frame, d_size);
                               nItemsToSend = d_size;
+                              d_frames[n] = frame;
+                              if (d_mask_test && n < (int)d_mask_frames.size())
+                                      d_mask_frames[n] = frame;
                       }
               }
 
+              if (d_frame_callback && d_displayOneBuffer) {
+                      d_frame_callback(d_frames, d_size);
+              }
+
+              // Test every frame, not only the ones that get plotted.
+              // When halted on a failure, the failing frame is forced
+              // on the plot and the following ones are dropped.
+              bool force_plot = false, skip_plot = false;
+              if (d_mask_test && d_displayOneBuffer) {
+                      if (d_mask_test->halted()) {
+                              skip_plot = true;
+                      } else if (d_mask_test->test(d_mask_frames.data(), d_size)) {
+                              force_plot = d_mask_test->halted();
+                      }
+              }
+
+              if (d_displayOneBuffer && d_acq_mode == ACQ_MODE_AVERAGE) {
+                      d_avg_count = nframes;
+              }
+
               // Plot if we are able to update
-              if((gr::high_res_timer_now() - d_last_time > d_update_time)
-                              || !d_cleanBuffers) {
+              if(!skip_plot && ((gr::high_res_timer_now() - d_last_time > d_update_time)
+                              || !d_cleanBuffers || force_plot)) {
                       d_last_time = gr::high_res_timer_now();
                       if (d_qApplication) {
                               d_qApplication->postEvent(this->plot,
@@ -390,6 +502,17 @@ namespace adiscope {
                                                                                         d_name));
                       }
               }
+              else if (!skip_plot && d_persistence && d_displayOneBuffer) {
+                      if (d_qApplication) {
+                              IdentifiableTimeUpdateEvent *event =
+                                      new IdentifiableTimeUpdateEvent(d_buffers,
+                                                                      nItemsToSend,
+                                                                      d_tags,
+                                                                      d_name);
+                              event->setPersistenceOnly(true);
+                              d_qApplication->postEvent(this->plot, event);
+                      }
+              }
 
               // We've plotting, so reset the state
               if (d_displayOneBuffer) {
@@ -79,7 +79,26 @@ namespace adiscope {
       bool d_displayOneBuffer;
       bool d_cleanBuffers;
 
+      // Acquisition mode, applied on complete triggered frames
+      acquisition_mode d_acq_mode;
+      unsigned int d_acq_factor;
+      unsigned int d_avg_count;
+      std::vector<float*> d_avg_buffers;
+
+      // Every complete frame is tested against the mask, if any
+      MaskTest *d_mask_test;
+      std::vector<const float*> d_mask_frames;
+
+      frame_callback d_frame_callback;
+      std::vector<const float*> d_frames;
+
+      bool d_persistence;
+
       void _reset();
+      void _alloc_buffers();
+      void _free_buffers();
+      const float *_process_frame(int n, float *frame, int nitems,
+				  float avg_weight);
       void _npoints_resize();
       void _adjust_tags(int adj);
       void _test_trigger_tags(int nitems);
@@ -100,6 +119,10 @@ namespace adiscope {
       void set_samp_rate(const double samp_rate);
       void set_trigger_mode(trigger_mode mode, int channel,
 			    const std::string &tag_key="");
+      void set_acquisition_mode(acquisition_mode mode, unsigned int factor);
+      void set_mask_test(MaskTest *mask);
+      void set_frame_callback(frame_callback callback);
+      void set_persistence(bool en);
 
       void set_displayOneBuffer(bool);
 
@@ -24,6 +24,9 @@
 #include <qwt_plot_layout.h>
 #include <qwt_scale_engine.h>
 
+/* Minimum time between two repaints while samples are streamed */
+#define SISMOGRAPH_REPLOT_MS 40
+
 using namespace adiscope;
 
 Sismograph::Sismograph(QWidget *parent) : QwtPlot(parent),
@@ -58,6 +61,10 @@ Sismograph::Sismograph(QWidget *parent) : QwtPlot(parent),
 
 	curve.attach(this);
 	curve.setXAxis(QwtAxis::XTop);
+
+	replotTimer.setSingleShot(true);
+	replotTimer.setInterval(SISMOGRAPH_REPLOT_MS);
+	connect(&replotTimer, SIGNAL(timeout()), this, SLOT(replot()));
 }
 
 Sismograph::~Sismograph()
@@ -65,17 +72,39 @@ Sismograph::~Sismograph()
 	delete scaler;
 }
 
-void Sismograph::plot(double sample)
+void Sismograph::addSample(double sample)
 {
 	if (xdata.size() == numSamples + 1)
 		xdata.pop();
 
 	xdata.push(sample);
 	scaler->setValue(sample);
+}
 
+void Sismograph::updateCurve()
+{
 	curve.setRawSamples(xdata.data(), ydata.data() + (ydata.size() -
 				xdata.size()), xdata.size());
-	replot();
+
+	if (!replotTimer.isActive())
+		replotTimer.start();
+}
+
+void Sismograph::plot(double sample)
+{
+	addSample(sample);
+	updateCurve();
+}
+
+void Sismograph::plot(const QVector<double>& samples)
+{
+	if (samples.isEmpty())
+		return;
+
+	for (double sample : samples)
+		addSample(sample);
+
+	updateCurve();
 }
 
 int Sismograph::getNumSamples() const
@@ -21,6 +21,7 @@
 #ifndef SISMOGRAPH_HPP
 #define SISMOGRAPH_HPP
 
+#include <QTimer>
 #include <QVector>
 #include <QWidget>
 
@@ -57,6 +58,7 @@ namespace adiscope {
 
 	public Q_SLOTS:
 		void plot(double sample);
+		void plot(const QVector<double>& samples);
 		void reset();
 		void setColor(const QColor& color);
 		void updateScale(const QwtScaleDiv);
@@ -70,6 +72,14 @@ namespace adiscope {
 
 		QVector<double> ydata;
 		CustomFifo<double> xdata;
+
+		/* The whole trace scrolls with each sample, so new samples
+		 * only schedule a repaint, done at most once per
+		 * SISMOGRAPH_REPLOT_MS */
+		QTimer replotTimer;
+
+		void addSample(double sample);
+		void updateCurve();
 	};
 }
 
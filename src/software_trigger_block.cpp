@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "software_trigger_block.h"
+
+#include <gnuradio/io_signature.h>
+
+#include <algorithm>
+#include <cstring>
+
+/* Samples checked at once for a possible comparator change */
+#define SW_TRIGGER_SCAN_BLOCK	64
+
+using namespace adiscope;
+
+software_trigger_block::sptr software_trigger_block::make(
+		unsigned int nb_channels)
+{
+	return gnuradio::get_initial_sptr(
+			new software_trigger_block(nb_channels));
+}
+
+software_trigger_block::software_trigger_block(unsigned int nb_channels) :
+	gr::sync_block("software_trigger_block",
+			gr::io_signature::make(nb_channels, nb_channels,
+				sizeof(float)),
+			gr::io_signature::make(nb_channels, nb_channels,
+				sizeof(float))),
+	depth(0),
+	history(nb_channels),
+	triggers(0),
+	tag_key(pmt::intern("sw_trigger"))
+{
+	cfg.type = TRIGGER_OFF;
+	cfg.channel = 0;
+	cfg.rising = true;
+	cfg.level_a = 0;
+	cfg.level_b = 0;
+	cfg.hysteresis = 0;
+	cfg.min_samples = 0;
+	cfg.max_samples = 0;
+	cfg.count = 1;
+	cfg.holdoff = 0;
+
+	reset_state();
+	set_tag_propagation_policy(TPP_ONE_TO_ONE);
+}
+
+software_trigger_block::~software_trigger_block()
+{
+}
+
+void software_trigger_block::set_config(const config &_cfg)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	cfg = _cfg;
+	reset_state();
+}
+
+software_trigger_block::config software_trigger_block::get_config()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	return cfg;
+}
+
+void software_trigger_block::set_pretrigger(size_t samples)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (samples == depth)
+		return;
+
+	/* The tags already scheduled belong to the old delay */
+	depth = samples;
+	for (auto &h : history)
+		h.assign(depth, 0.0f);
+	pending.clear();
+	reset_state();
+}
+
+size_t software_trigger_block::pretrigger()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	return depth;
+}
+
+uint64_t software_trigger_block::trigger_count() const
+{
+	return triggers;
+}
+
+void software_trigger_block::reset_state()
+{
+	a_high = false;
+	b_high = false;
+	primed = false;
+	armed = false;
+	reached = false;
+	timeout_fired = false;
+	start = 0;
+	last_edge = 0;
+	last_trigger = 0;
+	triggered_once = false;
+	edges = 0;
+}
+
+void software_trigger_block::fire(uint64_t pos)
+{
+	if (triggered_once && pos - last_trigger < cfg.holdoff)
+		return;
+
+	triggered_once = true;
+	last_trigger = pos;
+	triggers++;
+
+	/* The output is delayed by depth, so output sample pos is the
+	 * first pretrigger sample of this trigger */
+	pending.push_back(pos);
+}
+
+/* True when no comparator used by the current trigger can change state
+ * on these samples, so the whole block can be skipped. */
+bool software_trigger_block::can_skip(const float *in, int n) const
+{
+	if (!primed)
+		return false;
+
+	float min = in[0], max = in[0];
+
+	for (int i = 1; i < n; i++) {
+		min = in[i] < min ? in[i] : min;
+		max = in[i] > max ? in[i] : max;
+	}
+
+	float h = cfg.hysteresis / 2;
+
+	if (a_high ? min < cfg.level_a - h : max > cfg.level_a + h)
+		return false;
+
+	bool uses_b = cfg.type == TRIGGER_RUNT ||
+		cfg.type == TRIGGER_WINDOW ||
+		cfg.type == TRIGGER_SLEW_RATE;
+
+	if (uses_b && (b_high ? min < cfg.level_b - h :
+				max > cfg.level_b + h))
+		return false;
+
+	return true;
+}
+
+void software_trigger_block::process(float x, uint64_t pos)
+{
+	float h = cfg.hysteresis / 2;
+
+	if (!primed) {
+		a_high = x > cfg.level_a;
+		b_high = x > cfg.level_b;
+		last_edge = pos;
+		primed = true;
+		return;
+	}
+
+	bool was_inside = a_high && !b_high;
+	bool rise_a = false, fall_a = false;
+	bool rise_b = false, fall_b = false;
+
+	if (!a_high && x > cfg.level_a + h) {
+		a_high = true;
+		rise_a = true;
+	} else if (a_high && x < cfg.level_a - h) {
+		a_high = false;
+		fall_a = true;
+	}
+
+	if (!b_high && x > cfg.level_b + h) {
+		b_high = true;
+		rise_b = true;
+	} else if (b_high && x < cfg.level_b - h) {
+		b_high = false;
+		fall_b = true;
+	}
+
+	if (rise_a || fall_a) {
+		last_edge = pos;
+		timeout_fired = false;
+	}
+
+	auto in_range = [this](uint64_t d) {
+		return d >= cfg.min_samples &&
+			(!cfg.max_samples || d <= cfg.max_samples);
+	};
+
+	switch (cfg.type) {
+	case TRIGGER_EDGE:
+		if (cfg.rising ? rise_a : fall_a)
+			fire(pos);
+		break;
+
+	case TRIGGER_PULSE_WIDTH:
+		/* Positive pulses go from a rising to a falling edge */
+		if ((cfg.rising ? fall_a : rise_a) && armed) {
+			armed = false;
+			if (in_range(pos - start))
+				fire(pos);
+		}
+		if (cfg.rising ? rise_a : fall_a) {
+			armed = true;
+			start = pos;
+		}
+		break;
+
+	case TRIGGER_RUNT:
+		/* A pulse that crosses the first level but returns
+		 * without reaching the second one */
+		if (cfg.rising) {
+			if (rise_a) {
+				armed = true;
+				reached = false;
+			}
+			if (rise_b)
+				reached = true;
+			if (fall_a) {
+				if (armed && !reached)
+					fire(pos);
+				armed = false;
+			}
+		} else {
+			if (fall_b) {
+				armed = true;
+				reached = false;
+			}
+			if (fall_a)
+				reached = true;
+			if (rise_b) {
+				if (armed && !reached)
+					fire(pos);
+				armed = false;
+			}
+		}
+		break;
+
+	case TRIGGER_WINDOW: {
+		bool inside = a_high && !b_high;
+
+		if (cfg.rising ? (!was_inside && inside) :
+				(was_inside && !inside))
+			fire(pos);
+		break;
+	}
+
+	case TRIGGER_TIMEOUT:
+		if (a_high == cfg.rising && !timeout_fired &&
+				pos - last_edge >= cfg.min_samples) {
+			timeout_fired = true;
+			fire(pos);
+		}
+		break;
+
+	case TRIGGER_SLEW_RATE:
+		/* Transition time between the two levels */
+		if (cfg.rising ? rise_a : fall_b) {
+			armed = true;
+			start = pos;
+		}
+		if ((cfg.rising ? rise_b : fall_a) && armed) {
+			armed = false;
+			if (in_range(pos - start))
+				fire(pos);
+		}
+		if (cfg.rising ? fall_a : rise_b)
+			armed = false;
+		break;
+
+	case TRIGGER_NTH_EDGE:
+		if ((cfg.rising ? rise_a : fall_a) &&
+				++edges >= std::max(cfg.count, 1u)) {
+			edges = 0;
+			fire(pos);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void software_trigger_block::scan(const float *in, int n, uint64_t offset)
+{
+	for (int i = 0; i < n; i += SW_TRIGGER_SCAN_BLOCK) {
+		int len = std::min(n - i, SW_TRIGGER_SCAN_BLOCK);
+
+		if (!can_skip(&in[i], len)) {
+			for (int j = 0; j < len; j++)
+				process(in[i + j], offset + i + j);
+			continue;
+		}
+
+		/* Nothing crosses a level, but a timeout may expire */
+		if (cfg.type == TRIGGER_TIMEOUT && !timeout_fired &&
+				a_high == cfg.rising) {
+			uint64_t due = last_edge + cfg.min_samples;
+
+			if (due < offset + i + len) {
+				timeout_fired = true;
+				fire(std::max(due, offset + i));
+			}
+		}
+	}
+}
+
+void software_trigger_block::delay(int noutput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	size_t n = noutput_items;
+
+	for (unsigned int c = 0; c < input_items.size(); c++) {
+		const float *in = (const float *) input_items[c];
+		float *out = (float *) output_items[c];
+		float *hist = history[c].data();
+
+		if (!depth) {
+			memcpy(out, in, n * sizeof(float));
+		} else if (n >= depth) {
+			memcpy(out, hist, depth * sizeof(float));
+			memcpy(&out[depth], in, (n - depth) * sizeof(float));
+			memcpy(hist, &in[n - depth], depth * sizeof(float));
+		} else {
+			memcpy(out, hist, n * sizeof(float));
+			memmove(hist, &hist[n], (depth - n) * sizeof(float));
+			memcpy(&hist[depth - n], in, n * sizeof(float));
+		}
+	}
+}
+
+int software_trigger_block::work(int noutput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (cfg.type != TRIGGER_OFF && cfg.channel < input_items.size())
+		scan((const float *) input_items[cfg.channel], noutput_items,
+				nitems_read(cfg.channel));
+
+	delay(noutput_items, input_items, output_items);
+
+	/* Tag the triggers whose first pretrigger sample is output now */
+	uint64_t end = nitems_written(0) + noutput_items;
+	auto it = pending.begin();
+
+	for (; it != pending.end() && *it < end; ++it)
+		for (unsigned int c = 0; c < output_items.size(); c++)
+			add_item_tag(c, *it, tag_key, pmt::PMT_T,
+					alias_pmt());
+	pending.erase(pending.begin(), it);
+
+	return noutput_items;
+}
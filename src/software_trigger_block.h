@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOFTWARE_TRIGGER_BLOCK_H
+#define SOFTWARE_TRIGGER_BLOCK_H
+
+#include <gnuradio/sync_block.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace adiscope {
+	/* Advanced trigger evaluated on the sample stream. The samples are
+	 * passed through delayed by the pretrigger depth and a "sw_trigger"
+	 * tag is placed on every output at the first pretrigger sample of
+	 * each trigger, so a scope_sink_f in TRIG_MODE_TAG starts its frame
+	 * there and shows the trigger sample pretrigger samples into it.
+	 * The tags of the input are not delayed, so the pretrigger must
+	 * be 0 while the trigger is off for the block to pass through.
+	 *
+	 * Level A is the main threshold. Level B is the second threshold
+	 * used by the runt, window and slew rate triggers and must be
+	 * above level A. Both comparators have a hysteresis and keep their
+	 * state across calls to work(). Times are given in samples; a max
+	 * of 0 means unbounded. */
+	class software_trigger_block : public gr::sync_block
+	{
+	public:
+		typedef boost::shared_ptr<software_trigger_block> sptr;
+
+		enum trigger_type {
+			TRIGGER_OFF,
+			TRIGGER_EDGE,
+			TRIGGER_PULSE_WIDTH,
+			TRIGGER_RUNT,
+			TRIGGER_WINDOW,
+			TRIGGER_TIMEOUT,
+			TRIGGER_SLEW_RATE,
+			TRIGGER_NTH_EDGE,
+		};
+
+		struct config {
+			trigger_type type;
+			unsigned int channel;
+			bool rising;		// slope, pulse polarity or window entry
+			float level_a;
+			float level_b;
+			float hysteresis;
+			uint64_t min_samples;	// also the timeout
+			uint64_t max_samples;
+			unsigned int count;	// Nth edge
+			uint64_t holdoff;
+		};
+
+		static sptr make(unsigned int nb_channels);
+		~software_trigger_block();
+
+		void set_config(const config &cfg);
+		config get_config();
+
+		void set_pretrigger(size_t samples);
+		size_t pretrigger();
+
+		uint64_t trigger_count() const;
+
+		int work(int noutput_items,
+				gr_vector_const_void_star &input_items,
+				gr_vector_void_star &output_items);
+
+	private:
+		software_trigger_block(unsigned int nb_channels);
+
+		void reset_state();
+		void delay(int noutput_items,
+				gr_vector_const_void_star &input_items,
+				gr_vector_void_star &output_items);
+		void scan(const float *in, int n, uint64_t offset);
+		bool can_skip(const float *in, int n) const;
+		void process(float x, uint64_t pos);
+		void fire(uint64_t pos);
+
+		std::mutex mutex;
+		config cfg;
+		size_t depth;
+		std::vector<std::vector<float>> history;
+		std::vector<uint64_t> pending;
+		std::atomic<uint64_t> triggers;
+		pmt::pmt_t tag_key;
+
+		/* Comparator and state machine state */
+		bool a_high, b_high;
+		bool primed;
+		bool armed, reached;
+		bool timeout_fired;
+		uint64_t start;
+		uint64_t last_edge;
+		uint64_t last_trigger;
+		bool triggered_once;
+		unsigned int edges;
+	};
+}
+
+#endif /* SOFTWARE_TRIGGER_BLOCK_H */
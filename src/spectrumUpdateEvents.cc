@@ -204,7 +204,8 @@ SpectrumFrequencyRangeEvent::GetStopFrequency() const
 TimeUpdateEvent::TimeUpdateEvent(const std::vector<double*> &timeDomainPoints,
 				 const uint64_t numTimeDomainDataPoints,
 				 const std::vector< std::vector<gr::tag_t> > &tags)
-  : QEvent(QEvent::Type(SpectrumUpdateEventType))
+  : QEvent(QEvent::Type(SpectrumUpdateEventType)),
+    _persistenceOnly(false)
 {
   if(numTimeDomainDataPoints < 1) {
     _numTimeDomainDataPoints = 1;
@@ -250,6 +251,18 @@ TimeUpdateEvent::getTags() const
   return _tags;
 }
 
+void
+TimeUpdateEvent::setPersistenceOnly(bool en)
+{
+  _persistenceOnly = en;
+}
+
+bool
+TimeUpdateEvent::persistenceOnly() const
+{
+  return _persistenceOnly;
+}
+
 /***************************************************************************/
 
 
@@ -348,7 +361,8 @@ SetFreqEvent::getBandwidth() const
 ConstUpdateEvent::ConstUpdateEvent(const std::vector<double*> &realDataPoints,
 				   const std::vector<double*> &imagDataPoints,
 				   const uint64_t numDataPoints)
-  : QEvent(QEvent::Type(SpectrumUpdateEventType))
+  : QEvent(QEvent::Type(SpectrumUpdateEventType)),
+    _persistenceOnly(false)
 {
   if(numDataPoints < 1) {
     _numDataPoints = 1;
@@ -396,6 +410,18 @@ ConstUpdateEvent::getNumDataPoints() const
   return _numDataPoints;
 }
 
+void
+ConstUpdateEvent::setPersistenceOnly(bool en)
+{
+  _persistenceOnly = en;
+}
+
+bool
+ConstUpdateEvent::persistenceOnly() const
+{
+  return _persistenceOnly;
+}
+
 
 /***************************************************************************/
 
@@ -132,6 +132,11 @@ public:
 
   const std::vector< std::vector<gr::tag_t> > getTags() const;
 
+  // Frame dropped by the sink's update time, only to be accumulated
+  // into the persistence layer of the plot
+  void setPersistenceOnly(bool en);
+  bool persistenceOnly() const;
+
   static QEvent::Type Type()
       { return QEvent::Type(SpectrumUpdateEventType); }
 
@@ -142,6 +147,7 @@ private:
   std::vector<double*> _dataTimeDomainPoints;
   uint64_t _numTimeDomainDataPoints;
   std::vector< std::vector<gr::tag_t> > _tags;
+  bool _persistenceOnly;
 };
 
 
@@ -227,6 +233,11 @@ public:
   uint64_t getNumDataPoints() const;
   bool getRepeatDataFlag() const;
 
+  // Frame dropped by the sink's update time, only to be accumulated
+  // into the persistence layer of the plot
+  void setPersistenceOnly(bool en);
+  bool persistenceOnly() const;
+
   static QEvent::Type Type()
   { return QEvent::Type(SpectrumUpdateEventType); }
 
@@ -237,6 +248,7 @@ private:
   std::vector<double*> _realDataPoints;
   std::vector<double*> _imagDataPoints;
   uint64_t _numDataPoints;
+  bool _persistenceOnly;
 };
 
 
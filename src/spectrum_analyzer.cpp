@@ -51,6 +51,9 @@
 #include "spectrum_analyzer_api.hpp"
 #include "stream_to_vector_overlap.h"
 #include "tool_launcher.hpp"
+#include "waterfall_display.hpp"
+#include "mask_test.hpp"
+#include "gui/smallOnOffSwitch.hpp"
 
 #ifdef SPECTRAL_MSR
 #include "gui/measure.h"
@@ -75,8 +78,10 @@
 #include "scopyExceptionHandler.h"
 
 #define TIMER_TIMEOUT_MS 100
+#define MAX_ZOOM_DECIMATION 256
 
 static const int MAX_REF_CHANNELS = 4;
+static const int MAX_QUEUED_WATERFALL_FRAMES = 1024;
 
 using namespace adiscope;
 using namespace std;
@@ -143,6 +148,9 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 	crt_peak(0),
 	max_peak_count(10),
 	fft_size(32768),
+	zoom_decimation(1),
+	zoom_sample_rate(0.0),
+	zoom_center(0.0),
 	hCursorsEnabled(true),
 	vCursorsEnabled(true),
 	searchVisiblePeaks(true),
@@ -153,8 +161,8 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 	256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536, 131072, 262144
 	}), nb_ref_channels(0),
 	selected_ch_settings(-1),
-	fft_ids(nullptr),
-	m_nb_overlapping_avg(1)
+	m_nb_overlapping_avg(1),
+	m_waterfall_enabled(false)
 {
 	initInstrumentStrings();
 	// Get the list of names of the available channels
@@ -267,6 +275,10 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 
 	vLayout->addWidget(fft_plot->getPlotwithElements());
 
+	waterfall = new WaterfallDisplay(this);
+	waterfall->setVisible(false);
+	vLayout->addWidget(waterfall);
+
 	ui->widgetPlotContainer->layout()->removeWidget(ui->markerTable);
 	vLayout->addWidget(ui->markerTable);
 
@@ -360,6 +372,7 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 		fft_plot->bottomHandlesArea()->repaint();
 
 		setSampleRate(2 * stop);
+		updateZoom(start, stop);
 
 		/* Re-populate the RBW list with the new available values */
 		ui->cmb_rbw->blockSignals(true);
@@ -368,7 +381,8 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 
 		for (; i < bin_sizes.size(); i++) {
 			ui->cmb_rbw->addItem(freq_formatter.format(
-						     sample_rate / bin_sizes[i], "Hz", 2));
+						     sample_rate / (zoom_decimation * bin_sizes[i]),
+						     "Hz", 2));
 		}
 
 		ui->cmb_rbw->blockSignals(false);
@@ -382,7 +396,9 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 
 	connect(ui->cmb_rbw, QOverload<int>::of(&QComboBox::currentIndexChanged),
 		[=](int index){
-		startStopRange->setMinimumSpanValue(10 * sample_rate / bin_sizes[index]);
+		startStopRange->setMinimumSpanValue(10 * sample_rate /
+			(bin_sizes[index] * (iio ?
+				maxZoomDecimation(bin_sizes[index]) : 1)));
 	});
 
 	connect(ui->cmbGainMode, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -564,6 +580,57 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 		startStopRange->setMinimumValue(use_log_freq);
 	});
 
+	QHBoxLayout *waterfallLayout = new QHBoxLayout();
+	waterfallBtn = new SmallOnOffSwitch(this);
+	waterfallLayout->addWidget(new QLabel(tr("Waterfall"), this));
+	waterfallLayout->addWidget(waterfallBtn);
+	waterfallLayout->addStretch();
+	if (auto layout = qobject_cast<QBoxLayout *>(
+				ui->logBtn->parentWidget()->layout())) {
+		layout->insertLayout(layout->indexOf(ui->logBtn) + 1,
+				     waterfallLayout);
+	}
+
+	connect(waterfallBtn, &QPushButton::toggled, [=](bool on) {
+		m_waterfall_enabled = on;
+		waterfall->clear();
+		waterfall->setVisible(on);
+	});
+
+	/* Mask test against the trace of the selected channel */
+	maskTest = new MaskTest(m_adc_nb_channels);
+	maskTest->setFailCallback([=]() {
+		QMetaObject::invokeMethod(this, "onMaskTestFailed",
+					  Qt::QueuedConnection);
+	});
+	fft_plot->setMaskTest(maskTest);
+
+	QHBoxLayout *maskLayout = new QHBoxLayout();
+	maskBtn = new SmallOnOffSwitch(this);
+	maskToleranceBox = new QDoubleSpinBox(this);
+	maskToleranceBox->setRange(0.0, 100.0);
+	maskToleranceBox->setValue(6.0);
+	maskToleranceBox->setSuffix(tr(" dB"));
+	maskStopBox = new QCheckBox(tr("Stop on fail"), this);
+	maskStatusLabel = new QLabel(this);
+	maskLayout->addWidget(new QLabel(tr("Mask"), this));
+	maskLayout->addWidget(maskBtn);
+	maskLayout->addWidget(maskToleranceBox);
+	maskLayout->addWidget(maskStopBox);
+	maskLayout->addWidget(maskStatusLabel);
+	maskLayout->addStretch();
+	if (auto layout = qobject_cast<QBoxLayout *>(
+				ui->logBtn->parentWidget()->layout())) {
+		layout->insertLayout(layout->indexOf(ui->logBtn) + 2,
+				     maskLayout);
+	}
+
+	connect(maskBtn, SIGNAL(toggled(bool)), SLOT(setMaskFromTrace(bool)));
+	connect(maskStopBox, &QCheckBox::toggled, [=](bool en) {
+		maskTest->setStopOnFail(en);
+	});
+	connect(fft_plot, SIGNAL(newData()), SLOT(updateMaskStatus()));
+
 	ui->btnHistory->setEnabled(true);
 	ui->btnHistory->setChecked(true);
 	ui->btnHistory->setVisible(false);
@@ -726,6 +793,9 @@ SpectrumAnalyzer::~SpectrumAnalyzer()
 
 	delete sample_timer;
 
+	fft_plot->setMaskTest(nullptr);
+	delete maskTest;
+
 	delete api;
 	for (auto it = ch_api.begin(); it != ch_api.end(); ++it) {
 		delete *it;
@@ -741,21 +811,7 @@ SpectrumAnalyzer::~SpectrumAnalyzer()
 #endif
 
 	if (iio) {
-		bool started = isIioManagerStarted();
-
-		if (started) {
-			iio->lock();
-		}
-
-		for (unsigned int i = 0; i < m_adc_nb_channels; i++) {
-			iio->disconnect(fft_ids[i]);
-		}
-
-		if (started) {
-			iio->unlock();
-		}
-
-		delete[] fft_ids;
+		stop_blockchain_flow();
 	}
 
 	delete ui;
@@ -1009,6 +1065,140 @@ void SpectrumAnalyzer::on_btnMarkers_toggled(bool checked)
 		static_cast<CustomPushButton *>(QObject::sender()), checked);
 }
 
+void SpectrumAnalyzer::queueWaterfallFrame(
+		const std::vector<const float *> &frames, int nitems)
+{
+	if (!m_waterfall_enabled)
+		return;
+
+	/* Only the first half of the FFT is displayed */
+	QVector<QVector<float>> frame;
+	for (const float *data : frames) {
+		frame.push_back(QVector<float>(nitems / 2));
+		std::copy_n(data, nitems / 2, frame.back().data());
+	}
+
+	std::unique_lock<std::mutex> lock(m_waterfall_mutex);
+
+	const bool schedule = m_waterfall_frames.isEmpty();
+	m_waterfall_frames.enqueue(frame);
+
+	/* Don't pile up frames while the GUI thread is busy */
+	while (m_waterfall_frames.size() > MAX_QUEUED_WATERFALL_FRAMES)
+		m_waterfall_frames.dequeue();
+
+	lock.unlock();
+
+	if (schedule)
+		QMetaObject::invokeMethod(this, "updateWaterfall",
+					  Qt::QueuedConnection);
+}
+
+void SpectrumAnalyzer::updateWaterfall()
+{
+	QQueue<QVector<QVector<float>>> frames;
+	{
+		std::unique_lock<std::mutex> lock(m_waterfall_mutex);
+		frames.swap(m_waterfall_frames);
+	}
+
+	if (!waterfall->isVisible())
+		return;
+
+	int64_t nb_points = fft_plot->getNumPoints();
+	if (nb_points <= 0)
+		return;
+
+	/* Follow the visible part of the plot, both in frequency and
+	 * magnitude, so the waterfall lines up with the trace above it */
+	QwtInterval x = fft_plot->axisInterval(QwtAxis::XBottom);
+	QwtInterval y = fft_plot->axisInterval(
+				fft_plot->Curve(crt_channel_id)->yAxis());
+
+	int64_t first = qBound<int64_t>(0,
+			fft_plot->posAtFrequency(x.minValue()), nb_points - 1);
+	int64_t last = qBound<int64_t>(first + 1,
+			fft_plot->posAtFrequency(x.maxValue()) + 1, nb_points);
+
+	waterfall->setRange(y.minValue(), y.maxValue());
+
+	QVector<double> magnitude(nb_points);
+
+	for (const auto &frame : qAsConst(frames)) {
+		if (crt_channel_id >= frame.size() ||
+				frame[crt_channel_id].size() != nb_points)
+			continue;
+
+		fft_plot->computeMagnitude(crt_channel_id,
+				frame[crt_channel_id].constData(),
+				magnitude.data(), nb_points);
+		waterfall->addRow(magnitude.constData() + first, last - first);
+	}
+}
+
+/* Turning the mask on takes the current trace of the selected channel
+ * as reference, widened by the tolerance on both sides. */
+void SpectrumAnalyzer::setMaskFromTrace(bool on)
+{
+	maskTest->setEnabled(false);
+	fft_plot->clearMaskRegions();
+
+	for (unsigned int i = 0; i < m_adc_nb_channels; i++) {
+		maskTest->clearRegions(i);
+	}
+
+	maskTest->resetCounters();
+	maskToleranceBox->setEnabled(!on);
+
+	if (on && crt_channel_id >= 0 &&
+			crt_channel_id < (int)m_adc_nb_channels) {
+		const double *y = fft_plot->getMagnitudeData(crt_channel_id);
+		const QwtSeriesData<QPointF> *data =
+				fft_plot->Curve(crt_channel_id)->data();
+		const size_t nb_points = data->size();
+
+		/* The first point is only used to draw the start of the
+		 * sweep, it is not a bin */
+		if (y && nb_points > 1) {
+			std::vector<double> x(nb_points - 1);
+			for (size_t i = 1; i < nb_points; i++) {
+				x[i - 1] = data->sample(i).x();
+			}
+
+			maskTest->setReference(crt_channel_id, x.data(), y + 1,
+					       nb_points - 1, 0.0,
+					       maskToleranceBox->value());
+			fft_plot->setMaskRegions(crt_channel_id,
+						 maskTest->regions(crt_channel_id));
+			maskTest->setEnabled(true);
+		}
+	}
+
+	fft_plot->replot();
+	updateMaskStatus();
+}
+
+void SpectrumAnalyzer::onMaskTestFailed()
+{
+	updateMaskStatus();
+
+	if (maskTest->halted() && runButton()->isChecked()) {
+		runButton()->setChecked(false);
+	}
+}
+
+void SpectrumAnalyzer::updateMaskStatus()
+{
+	if (!maskTest->enabled()) {
+		maskStatusLabel->clear();
+		return;
+	}
+
+	maskStatusLabel->setText(tr("Failed %1 / %2")
+				 .arg(maskTest->failedFrames())
+				 .arg(maskTest->testedFrames()));
+}
+
 #ifdef SPECTRAL_MSR
 void SpectrumAnalyzer::on_btnMeasure_toggled(bool checked) {
     triggerRightMenuToggle(static_cast<CustomPushButton *>(QObject::sender()),
@@ -1800,6 +1990,7 @@ void SpectrumAnalyzer::stop()
 void SpectrumAnalyzer::runStopToggled(bool checked)
 {
 	if (checked) {
+		maskTest->rearm();
 		if (iio) {
 			writeAllSettingsToHardware();
 		}
@@ -1830,12 +2021,10 @@ void SpectrumAnalyzer::build_gnuradio_block_chain()
 
 	double targetFps = getScopyPreferences()->getTarget_fps();
 	fft_sink->set_update_time(1.0/targetFps);
-
-	bool started = isIioManagerStarted();
-
-	if (started) {
-		iio->lock();
-	}
+	fft_sink->set_frame_callback([=](const std::vector<const float *> &frames,
+					 int nitems) {
+		queueWaterfallFrame(frames, nitems);
+	});
 
 	bool canConvRawToVolts = m_m2k_analogin ? true : false;
 
@@ -1846,25 +2035,25 @@ void SpectrumAnalyzer::build_gnuradio_block_chain()
 		}
 	}
 
-	fft_ids = new iio_manager::port_id[m_adc_nb_channels];
+	/* The FFT chain runs in a flowgraph of its own, fed by consumers
+	 * attached to the iio_manager when the tool starts. Reconfiguring
+	 * it never stops the flowgraph shared with the other tools. */
+	top_block = gr::make_top_block("spectrum_analyzer");
 
 	for (int i = 0; i < m_adc_nb_channels; i++) {
-		auto fft = gnuradio::get_initial_sptr(
-		                   new fft_block(false, fft_size));
+		auto s2f = gr::blocks::short_to_float::make();
+		auto fft = makeFftBlock(fft_size);
 		auto ctm = gr::blocks::complex_to_mag_squared::make(1);
 
-		// iio(i)->fft->ctm->fft_sink
-		fft_ids[i] = iio->connect(fft, i, 0, true, fft_size);
-		iio->connect(fft, 0, ctm, 0);
-		iio->connect(ctm, 0, fft_sink, i);
+		// iio(i)->s2f->fft->ctm->fft_sink
+		top_block->connect(s2f, 0, fft, 0);
+		top_block->connect(fft, 0, ctm, 0);
+		top_block->connect(ctm, 0, fft_sink, i);
 
+		channels[i]->s2f_block = s2f;
 		channels[i]->fft_block = fft;
 		channels[i]->ctm_block = ctm;
 	}
-
-	if (started) {
-		iio->unlock();
-	}
 }
 
 void SpectrumAnalyzer::build_gnuradio_block_chain_no_ctx()
@@ -1875,6 +2064,10 @@ void SpectrumAnalyzer::build_gnuradio_block_chain_no_ctx()
 
 	double targetFps = getScopyPreferences()->getTarget_fps();
 	fft_sink->set_update_time(1.0/targetFps);
+	fft_sink->set_frame_callback([=](const std::vector<const float *> &frames,
+					 int nitems) {
+		queueWaterfallFrame(frames, nitems);
+	});
 
 	top_block = gr::make_top_block("spectrum_analyzer");
 
@@ -1905,23 +2098,35 @@ void SpectrumAnalyzer::build_gnuradio_block_chain_no_ctx()
 void SpectrumAnalyzer::start_blockchain_flow()
 {
 	if (iio) {
+		const size_t buffer_size = std::min<size_t>(fft_size *
+				m_nb_overlapping_avg * zoom_decimation,
+				IIO_MAX_ATTACH_BUFFER_SIZE);
+
 		for (int i = 0; i < m_adc_nb_channels; i++) {
-			iio->start(fft_ids[i]);
+			auto source = iio->attach(i, buffer_size);
+
+			top_block->connect(source, 0, channels[i]->s2f_block, 0);
+			fft_sources.push_back(source);
 		}
-	} else {
-		fft_sink->reset();
-		top_block->start();
 	}
+
+	fft_sink->reset();
+	top_block->start();
 }
 
 void SpectrumAnalyzer::stop_blockchain_flow()
 {
+	top_block->stop();
+	top_block->wait();
+
 	if (iio) {
-		for (int i = 0; i < m_adc_nb_channels; i++) {
-			iio->stop(fft_ids[i]);
+		for (int i = 0; i < fft_sources.size(); i++) {
+			top_block->disconnect(fft_sources[i], 0,
+					      channels[i]->s2f_block, 0);
+			iio->detach(fft_sources[i]);
 		}
-	} else {
-		top_block->stop();
+
+		fft_sources.clear();
 	}
 }
 
@@ -2497,46 +2702,40 @@ void SpectrumAnalyzer::setSampleRate(double sr)
 
 void SpectrumAnalyzer::setFftSize(uint size)
 {
-	// TO DO: This is cumbersome. We shouldn't have to rebuild the entire
-	//        block chain every time we need to change the FFT size. A
-	//        spectrum_sink block similar to scope_sink_f would be better
-
 	bool started = isIioManagerStarted();
 
 	if (started) {
-		iio->lock();
+		stop_blockchain_flow();
 	}
 
 	fft_size = size;
 	fft_sink->set_nsamps(size);
 
+	if (zoom_decimation > maxZoomDecimation(size)) {
+		setZoom(maxZoomDecimation(size), zoom_center);
+	}
+
 	if (fft_plot->magnitudeType() == FftDisplayPlot::VROOTHZ) {
 		fft_plot->setNbOverlappingAverages(m_nb_overlapping_avg);
 	}
 
 	for (int i = 0; i < channels.size(); i++) {
-		auto fft = gnuradio::get_initial_sptr(
-		                   new fft_block(false, size));
+		auto fft = makeFftBlock(size);
 
-		iio->disconnect(fft_ids[i]);
-
-		fft_ids[i] = iio->connect(fft, i, 0, true, fft_size * m_nb_overlapping_avg);
-
-		iio->connect(fft, 0, channels[i]->ctm_block, 0);
-		iio->connect(channels[i]->ctm_block, 0, fft_sink, i);
-
-		if (started) {
-			iio->start(fft_ids[i]);
-		}
+		top_block->disconnect(channels[i]->s2f_block, 0,
+				      channels[i]->fft_block, 0);
+		top_block->disconnect(channels[i]->fft_block, 0,
+				      channels[i]->ctm_block, 0);
+		top_block->connect(channels[i]->s2f_block, 0, fft, 0);
+		top_block->connect(fft, 0, channels[i]->ctm_block, 0);
 
 		channels[i]->fft_block = fft;
 		channels[i]->setFftWindow(channels[i]->fftWindow(), size);
-
-		iio->set_buffer_size(fft_ids[i], size * m_nb_overlapping_avg);
 	}
 
+	/* Attaching again requests the new buffer size */
 	if (started) {
-		iio->unlock();
+		start_blockchain_flow();
 	}
 
 	sample_timer->stop();
@@ -2545,6 +2744,70 @@ void SpectrumAnalyzer::setFftSize(uint size)
 	sample_timer->start(TIMER_TIMEOUT_MS);
 }
 
+boost::shared_ptr<adiscope::fft_block> SpectrumAnalyzer::makeFftBlock(uint size)
+{
+	if (zoom_decimation > 1) {
+		return gnuradio::get_initial_sptr(new fft_block(size,
+				sample_rate, zoom_center, zoom_decimation));
+	}
+
+	return gnuradio::get_initial_sptr(new fft_block(false, size));
+}
+
+void SpectrumAnalyzer::updateZoom(double start, double stop)
+{
+	/* Spans that only cover a fraction of the Nyquist band are
+	 * mixed down and decimated before the FFT, so that all the bins
+	 * of the FFT fall inside the span. */
+	unsigned int decimation = 1;
+
+	if (iio && stop > start) {
+		decimation = (unsigned int)(sample_rate / (2.0 * (stop - start)));
+		decimation = qBound(1u, decimation, maxZoomDecimation(fft_size));
+	}
+
+	if (setZoom(decimation, (start + stop) / 2.0)) {
+		if (iio && top_block) {
+			setFftSize(fft_size);
+		}
+	} else if (decimation > 1) {
+		for (auto ch : qAsConst(channels)) {
+			ch->fft_block->set_center_frequency(zoom_center);
+		}
+	}
+}
+
+/* Returns true if the FFT blocks have to be rebuilt */
+bool SpectrumAnalyzer::setZoom(unsigned int decimation, double center)
+{
+	double span = sample_rate / (2.0 * decimation);
+	center = qBound(span / 2.0, center, sample_rate / 2.0 - span / 2.0);
+
+	bool rebuild = decimation != zoom_decimation ||
+			(decimation > 1 && sample_rate != zoom_sample_rate);
+
+	zoom_decimation = decimation;
+	zoom_sample_rate = sample_rate;
+	zoom_center = center;
+
+	if (decimation > 1) {
+		fft_plot->presetFrequencyRange(center - span / 2.0,
+					       center + span / 2.0);
+	} else {
+		fft_plot->presetSampleRate(sample_rate);
+	}
+
+	return rebuild;
+}
+
+/* The samples of a whole decimated FFT are read in one buffer, which
+ * has to fit in the buffer of an attached consumer, or the slow zoom
+ * filter would fall behind and build its frames from gaps */
+unsigned int SpectrumAnalyzer::maxZoomDecimation(uint size) const
+{
+	return qBound<size_t>(1, IIO_MAX_ATTACH_BUFFER_SIZE / size,
+			      MAX_ZOOM_DECIMATION);
+}
 
 void SpectrumAnalyzer::refreshCurrentSampleLabel()
 {
@@ -2553,7 +2816,7 @@ void SpectrumAnalyzer::refreshCurrentSampleLabel()
 		return;
 	}
 
-	double time_acquisition = fft_size / sample_rate;
+	double time_acquisition = fft_size * zoom_decimation / sample_rate;
 
 	auto time_now = std::chrono::system_clock::now();
 	std::chrono::duration<double> elapsed_done = time_now - m_time_start;
@@ -2827,10 +3090,7 @@ void SpectrumAnalyzer::on_cmb_units_currentIndexChanged(const QString& unit)
 	FftDisplayPlot::MagnitudeType magType = (*it).second;
 	unsigned int stackedWidgetCurrentIdx = 0;
 
-	bool started = isIioManagerStarted();
-	if (started) {
-		iio->lock();
-	}
+	top_block->lock();
 	for (unsigned int i = 0; i < m_adc_nb_channels; i++) {
 		auto ov_factor = SpectrumChannel::win_overlap_factor(channels[i]->fftWindow());
 		if (magType == FftDisplayPlot::VROOTHZ) {
@@ -2839,10 +3099,7 @@ void SpectrumAnalyzer::on_cmb_units_currentIndexChanged(const QString& unit)
 			channels[i]->fft_block->set_overlap_factor(0.0);
 		}
 	}
-
-	if (started) {
-		iio->unlock();
-	}
+	top_block->unlock();
 
 	switch (magType) {
 	case FftDisplayPlot::VPEAK:
@@ -24,6 +24,7 @@
 #include <gnuradio/top_block.h>
 #include <gnuradio/fft/window.h>
 #include <gnuradio/blocks/complex_to_mag_squared.h>
+#include <gnuradio/blocks/short_to_float.h>
 
 #include "apiObject.hpp"
 #include "iio_manager.hpp"
@@ -43,6 +44,9 @@
 #include <QWidget>
 #include <QQueue>
 
+#include <atomic>
+#include <mutex>
+
 /* libm2k includes */
 #include <libm2k/analog/genericanalogin.hpp>
 #include <libm2k/analog/m2kanalogin.hpp>
@@ -69,6 +73,9 @@ class MeasurementsPanel;
 namespace adiscope {
 class SpectrumChannel;
 class Filter;
+class WaterfallDisplay;
+class MaskTest;
+class SmallOnOffSwitch;
 class ChannelWidget;
 class DbClickButtons;
 
@@ -79,6 +86,9 @@ class MeasurementGui;
 }
 
 class QPushButton;
+class QCheckBox;
+class QDoubleSpinBox;
+class QLabel;
 class QButtonGroup;
 class QGridLayout;
 
@@ -157,6 +167,10 @@ private Q_SLOTS:
 	void onChannelAdded(int);
 	void onNewDataReceived();
 #endif
+	void updateWaterfall();
+	void setMaskFromTrace(bool on);
+	void onMaskTestFailed();
+	void updateMaskStatus();
 
 	void on_boxCursors_toggled(bool on);
 	void on_btnCursors_toggled(bool);
@@ -210,6 +224,10 @@ private:
 	int channelIdOfOpenedSettings() const;
 	void setSampleRate(double sr);
 	void setFftSize(uint size);
+	void updateZoom(double start, double stop);
+	bool setZoom(unsigned int decimation, double center);
+	unsigned int maxZoomDecimation(uint size) const;
+	boost::shared_ptr<adiscope::fft_block> makeFftBlock(uint size);
 	void setMarkerEnabled(int ch_idx, int mrk_idx, bool en);
 	void updateWidgetsRelatedToMarker(int mrk_idx);
 	void setCurrentMarkerLabelData(int chIdx, int mkIdx);
@@ -266,6 +284,22 @@ private:
 	QButtonGroup *settings_group;
 	QButtonGroup *channels_group;
 	FftDisplayPlot *fft_plot;
+	WaterfallDisplay *waterfall;
+	SmallOnOffSwitch *waterfallBtn;
+
+	/* Every FFT frame becomes a waterfall row, not only the plotted
+	 * ones. The frames are queued by the flowgraph thread. */
+	std::atomic<bool> m_waterfall_enabled;
+	std::mutex m_waterfall_mutex;
+	QQueue<QVector<QVector<float>>> m_waterfall_frames;
+	void queueWaterfallFrame(const std::vector<const float *> &frames,
+				 int nitems);
+
+	MaskTest *maskTest;
+	SmallOnOffSwitch *maskBtn;
+	QDoubleSpinBox *maskToleranceBox;
+	QCheckBox *maskStopBox;
+	QLabel *maskStatusLabel;
 
 	ScaleSpinButton *top_scale;
 	ScaleSpinButton *bottom_scale;
@@ -281,7 +315,7 @@ private:
 	std::chrono::time_point<std::chrono::system_clock>  m_time_start;
 
 	adiscope::scope_sink_f::sptr fft_sink;
-	iio_manager::port_id *fft_ids;
+	std::vector<broadcaster_source::sptr> fft_sources;
 
 	boost::shared_ptr<iio_manager> iio;
 	const std::string adc_name;
@@ -295,6 +329,9 @@ private:
 	double m_max_sample_rate;
 	int sample_rate_divider;
 	uint fft_size;
+	unsigned int zoom_decimation;
+	double zoom_sample_rate;
+	double zoom_center;
 	QList<uint> bin_sizes;
 	MetricPrefixFormatter freq_formatter;
 
@@ -354,6 +391,7 @@ class SpectrumChannel: public QObject
 	friend class SpectrumChannel_API;
 
 public:
+	gr::blocks::short_to_float::sptr s2f_block;
 	boost::shared_ptr<adiscope::fft_block> fft_block;
 	gr::blocks::complex_to_mag_squared::sptr ctm_block;
 
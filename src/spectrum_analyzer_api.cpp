@@ -215,6 +215,20 @@ void SpectrumAnalyzer_API::show()
 	Q_EMIT sp->showTool();
 }
 
+void SpectrumAnalyzer_API::beginLoad()
+{
+	/* Nested locks taken by the setters won't restart the flowgraph,
+	 * it is restarted once, when the whole state is loaded */
+	if (sp->iio)
+		sp->iio->lock();
+}
+
+void SpectrumAnalyzer_API::endLoad()
+{
+	if (sp->iio)
+		sp->iio->unlock();
+}
+
 QVariantList SpectrumAnalyzer_API::getMarkers()
 {
 	QVariantList list;
@@ -61,6 +61,10 @@ public:
 		ApiObject(), sp(sp) {}
 	~SpectrumAnalyzer_API() {}
 
+protected:
+	void beginLoad() override;
+	void endLoad() override;
+
 private:
 	SpectrumAnalyzer *sp;
 
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stream_broadcaster.hpp"
+
+#include <gnuradio/io_signature.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace adiscope;
+
+/* Read timeout of the source blocks, so that they notice stop() */
+static const unsigned int BROADCASTER_READ_TIMEOUT_MS = 100;
+
+stream_broadcaster::stream_broadcaster(size_t capacity) :
+	head(0), next_id(0)
+{
+	size_t size = 1;
+
+	/* Round up to a power of two so that the index is a simple mask */
+	while (size < capacity)
+		size <<= 1;
+
+	ring.resize(size);
+	mask = size - 1;
+}
+
+void stream_broadcaster::write(const short *data, size_t nb,
+		const std::vector<size_t> &marks)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	/* Nobody is listening, don't bother copying */
+	if (cursors.empty()) {
+		head += nb;
+		buffer_starts.clear();
+		return;
+	}
+
+	for (size_t mark : marks)
+		buffer_starts.push_back(head + mark);
+
+	/* Only the last ring.size() samples can ever be read */
+	if (nb > ring.size()) {
+		data += nb - ring.size();
+		head += nb - ring.size();
+		nb = ring.size();
+	}
+
+	size_t start = head & mask;
+	size_t first = std::min(nb, ring.size() - start);
+
+	memcpy(&ring[start], data, first * sizeof(short));
+	memcpy(&ring[0], data + first, (nb - first) * sizeof(short));
+
+	head += nb;
+
+	while (!buffer_starts.empty() &&
+			head - buffer_starts.front() > ring.size())
+		buffer_starts.pop_front();
+
+	lock.unlock();
+	cond.notify_all();
+}
+
+stream_broadcaster::cursor_id stream_broadcaster::add_cursor()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	cursor_id id = next_id++;
+
+	/* New readers start with the next sample written */
+	cursors[id] = { head, 0 };
+
+	return id;
+}
+
+void stream_broadcaster::remove_cursor(cursor_id id)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	cursors.erase(id);
+}
+
+size_t stream_broadcaster::read(cursor_id id, short *out, size_t max,
+		unsigned int timeout_ms, std::vector<size_t> &marks)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	marks.clear();
+
+	auto it = cursors.find(id);
+	if (it == cursors.end())
+		return 0;
+
+	if (it->second.pos == head) {
+		cond.wait_for(lock, std::chrono::milliseconds(timeout_ms));
+
+		it = cursors.find(id);
+		if (it == cursors.end())
+			return 0;
+	}
+
+	cursor &c = it->second;
+
+	if (head - c.pos > ring.size()) {
+		c.pos = head - ring.size();
+		c.overruns++;
+	}
+
+	size_t nb = std::min<uint64_t>(max, head - c.pos);
+	size_t start = c.pos & mask;
+	size_t first = std::min(nb, ring.size() - start);
+
+	memcpy(out, &ring[start], first * sizeof(short));
+	memcpy(out + first, &ring[0], (nb - first) * sizeof(short));
+
+	auto mark = std::lower_bound(buffer_starts.cbegin(),
+			buffer_starts.cend(), c.pos);
+	for (; mark != buffer_starts.cend() && *mark < c.pos + nb; ++mark)
+		marks.push_back(*mark - c.pos);
+
+	c.pos += nb;
+
+	return nb;
+}
+
+uint64_t stream_broadcaster::overruns(cursor_id id)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	auto it = cursors.find(id);
+	if (it == cursors.end())
+		return 0;
+
+	return it->second.overruns;
+}
+
+void stream_broadcaster::wake()
+{
+	cond.notify_all();
+}
+
+broadcaster_sink::broadcaster_sink(boost::shared_ptr<stream_broadcaster> b) :
+	gr::sync_block("broadcaster_sink",
+			gr::io_signature::make(1, 1, sizeof(short)),
+			gr::io_signature::make(0, 0, 0)),
+	broadcaster(b),
+	buffer_start_key(pmt::intern("buffer_start"))
+{
+}
+
+broadcaster_sink::sptr broadcaster_sink::make(
+		boost::shared_ptr<stream_broadcaster> b)
+{
+	return gnuradio::get_initial_sptr(new broadcaster_sink(b));
+}
+
+int broadcaster_sink::work(int noutput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	const uint64_t nread = nitems_read(0);
+	std::vector<gr::tag_t> tags;
+
+	get_tags_in_range(tags, 0, nread, nread + noutput_items,
+			buffer_start_key);
+
+	marks.clear();
+	for (const gr::tag_t &tag : tags)
+		marks.push_back(tag.offset - nread);
+
+	broadcaster->write(static_cast<const short *>(input_items[0]),
+			noutput_items, marks);
+
+	return noutput_items;
+}
+
+broadcaster_source::broadcaster_source(boost::shared_ptr<stream_broadcaster> b) :
+	gr::sync_block("broadcaster_source",
+			gr::io_signature::make(0, 0, 0),
+			gr::io_signature::make(1, 1, sizeof(short))),
+	broadcaster(b),
+	cursor(b->add_cursor()),
+	stopping(false),
+	buffer_start_key(pmt::intern("buffer_start")),
+	overrun_key(pmt::intern("overrun")),
+	last_overruns(0)
+{
+}
+
+broadcaster_source::~broadcaster_source()
+{
+	broadcaster->remove_cursor(cursor);
+}
+
+broadcaster_source::sptr broadcaster_source::make(
+		boost::shared_ptr<stream_broadcaster> b)
+{
+	return gnuradio::get_initial_sptr(new broadcaster_source(b));
+}
+
+bool broadcaster_source::start()
+{
+	stopping = false;
+
+	return gr::sync_block::start();
+}
+
+bool broadcaster_source::stop()
+{
+	stopping = true;
+	broadcaster->wake();
+
+	return gr::sync_block::stop();
+}
+
+int broadcaster_source::work(int noutput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	if (stopping)
+		return WORK_DONE;
+
+	size_t nb = broadcaster->read(cursor,
+			static_cast<short *>(output_items[0]),
+			noutput_items, BROADCASTER_READ_TIMEOUT_MS, marks);
+
+	const uint64_t nwritten = nitems_written(0);
+	for (size_t mark : marks)
+		add_item_tag(0, nwritten + mark, buffer_start_key,
+				pmt::PMT_T);
+
+	if (nb) {
+		const uint64_t overruns = broadcaster->overruns(cursor);
+
+		if (overruns != last_overruns) {
+			last_overruns = overruns;
+			add_item_tag(0, nwritten, overrun_key, pmt::PMT_T);
+		}
+	}
+
+	return nb;
+}
+
+uint64_t broadcaster_source::overruns()
+{
+	return broadcaster->overruns(cursor);
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAM_BROADCASTER_HPP
+#define STREAM_BROADCASTER_HPP
+
+#include <gnuradio/sync_block.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace adiscope {
+	/* Single writer, multiple reader ring buffer. Every reader owns a
+	 * cursor; the writer never waits for the readers. A reader that
+	 * falls behind by more than the capacity of the ring skips ahead
+	 * to the oldest sample still available and gets an overrun.
+	 * The start of every hardware buffer is marked, so that readers
+	 * can tag it again in their own flowgraph. */
+	class stream_broadcaster
+	{
+	public:
+		typedef unsigned int cursor_id;
+
+		explicit stream_broadcaster(size_t capacity);
+
+		/* 'marks' are the indexes in 'data' where a buffer starts */
+		void write(const short *data, size_t nb,
+				const std::vector<size_t> &marks);
+
+		cursor_id add_cursor();
+		void remove_cursor(cursor_id id);
+
+		/* Copy at most 'max' samples for the given cursor. Waits up
+		 * to timeout_ms for new data; returns the number of samples
+		 * copied, which can be 0 on timeout or after wake(). The
+		 * indexes in 'out' where a buffer starts go in 'marks'. */
+		size_t read(cursor_id id, short *out, size_t max,
+				unsigned int timeout_ms,
+				std::vector<size_t> &marks);
+
+		uint64_t overruns(cursor_id id);
+
+		/* Release the readers blocked in read() */
+		void wake();
+
+	private:
+		struct cursor {
+			uint64_t pos;
+			uint64_t overruns;
+		};
+
+		std::vector<short> ring;
+		size_t mask;
+		uint64_t head;
+		cursor_id next_id;
+		std::map<cursor_id, cursor> cursors;
+
+		/* Absolute positions of the buffer starts still in the ring */
+		std::deque<uint64_t> buffer_starts;
+
+		std::mutex mutex;
+		std::condition_variable cond;
+	};
+
+	/* Feeds a stream_broadcaster from a flowgraph */
+	class broadcaster_sink : public gr::sync_block
+	{
+	public:
+		typedef boost::shared_ptr<broadcaster_sink> sptr;
+
+		static sptr make(boost::shared_ptr<stream_broadcaster> b);
+
+		int work(int noutput_items,
+				gr_vector_const_void_star &input_items,
+				gr_vector_void_star &output_items);
+
+	private:
+		explicit broadcaster_sink(boost::shared_ptr<stream_broadcaster> b);
+
+		boost::shared_ptr<stream_broadcaster> broadcaster;
+		pmt::pmt_t buffer_start_key;
+		std::vector<size_t> marks;
+	};
+
+	/* Reads one cursor of a stream_broadcaster into another flowgraph,
+	 * so that consumers can come and go without touching the graph that
+	 * owns the hardware source. The "buffer_start" tags seen by the
+	 * sink are added again on the output, and an "overrun" tag marks
+	 * the first sample after the samples skipped by an overrun. */
+	class broadcaster_source : public gr::sync_block
+	{
+	public:
+		typedef boost::shared_ptr<broadcaster_source> sptr;
+
+		static sptr make(boost::shared_ptr<stream_broadcaster> b);
+		~broadcaster_source();
+
+		bool start();
+		bool stop();
+
+		int work(int noutput_items,
+				gr_vector_const_void_star &input_items,
+				gr_vector_void_star &output_items);
+
+		uint64_t overruns();
+
+	private:
+		explicit broadcaster_source(boost::shared_ptr<stream_broadcaster> b);
+
+		boost::shared_ptr<stream_broadcaster> broadcaster;
+		stream_broadcaster::cursor_id cursor;
+		volatile bool stopping;
+		pmt::pmt_t buffer_start_key;
+		pmt::pmt_t overrun_key;
+		uint64_t last_overruns;
+		std::vector<size_t> marks;
+	};
+}
+
+#endif /* STREAM_BROADCASTER_HPP */
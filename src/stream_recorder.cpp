@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stream_recorder.hpp"
+#include "iio_manager.hpp"
+
+#include <gnuradio/io_signature.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cstring>
+
+/* The file grows by this much at a time, to avoid extending it on
+ * every write */
+#define RECORDING_PREALLOC_BYTES (64LL * 1024 * 1024)
+#define RECORDING_VERSION 1
+/* Longest sleep of the playback pacing, so speed changes apply fast */
+#define RECORDING_MAX_WAIT_S 0.05
+
+using namespace adiscope;
+
+static const char recording_magic[8] = { 'S', 'C', 'O', 'P', 'Y', 'R', 'E', 'C' };
+
+static_assert(sizeof(recording_header) == 512,
+		"the recording header has a fixed size");
+
+recording_sink::sptr recording_sink::make(const QString &filename,
+		const recording_header &header, size_t buffer_samples)
+{
+	return gnuradio::get_initial_sptr(
+			new recording_sink(filename, header, buffer_samples));
+}
+
+recording_sink::recording_sink(const QString &filename,
+		const recording_header &_header, size_t buffer_samples) :
+	gr::sync_block("recording_sink",
+			gr::io_signature::make(_header.nb_channels,
+				_header.nb_channels, sizeof(short)),
+			gr::io_signature::make(0, 0, 0)),
+	file(filename),
+	header(_header),
+	allocated(0),
+	buffer_frames(std::max<size_t>(buffer_samples, 1024)),
+	fill(0),
+	fill_frames(0),
+	pending(false),
+	pending_frames(0),
+	quit(false),
+	error(false),
+	written(0),
+	nb_overruns(0),
+	nb_dropped(0),
+	overrun_key(pmt::intern("overrun"))
+{
+	memcpy(header.magic, recording_magic, sizeof(header.magic));
+	header.version = RECORDING_VERSION;
+
+	for (unsigned int i = 0; i < 2; i++)
+		buffers[i].resize(buffer_frames * header.nb_channels);
+
+	if (file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+		header.start_time = QDateTime::currentMSecsSinceEpoch();
+		write_header();
+	} else {
+		error = true;
+	}
+}
+
+recording_sink::~recording_sink()
+{
+	stop();
+}
+
+bool recording_sink::start()
+{
+	if (!file.isOpen())
+		return false;
+
+	fill_frames = 0;
+	pending = false;
+	quit = false;
+
+	writer = std::thread(&recording_sink::writer_loop, this);
+
+	return gr::sync_block::start();
+}
+
+bool recording_sink::stop()
+{
+	if (writer.joinable()) {
+		submit(true);
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			quit = true;
+		}
+		cond.notify_all();
+		writer.join();
+
+		/* Trim the preallocated space and store the final counts */
+		write_header();
+		file.resize(sizeof(header) + written * header.nb_channels *
+				sizeof(short));
+		file.close();
+	}
+
+	return gr::sync_block::stop();
+}
+
+void recording_sink::write_header()
+{
+	header.nb_samples = written;
+	header.overruns = nb_overruns;
+	header.dropped_samples = nb_dropped;
+
+	file.seek(0);
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+void recording_sink::writer_loop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	for (;;) {
+		cond.wait(lock, [this]() { return pending || quit; });
+
+		if (!pending)
+			break;
+
+		const std::vector<short> &buf = buffers[fill ^ 1];
+		const qint64 size = pending_frames * header.nb_channels *
+			sizeof(short);
+		const qint64 offset = sizeof(header) + written *
+			header.nb_channels * sizeof(short);
+		bool ok = !error;
+
+		lock.unlock();
+
+		if (ok && offset + size > allocated) {
+			allocated = offset + std::max(size, RECORDING_PREALLOC_BYTES);
+			file.resize(allocated);
+		}
+
+		if (ok) {
+			file.seek(offset);
+			ok = file.write(reinterpret_cast<const char *>(buf.data()),
+					size) == size;
+		}
+
+		lock.lock();
+
+		if (ok)
+			written += pending_frames;
+		else
+			error = true;
+
+		pending = false;
+		cond.notify_all();
+	}
+}
+
+/* Hand the buffer being filled to the writer thread. If the writer is
+ * still busy with the other buffer, the samples are dropped, unless we
+ * are allowed to wait for it. */
+void recording_sink::submit(bool wait)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (!fill_frames)
+		return;
+
+	if (pending && wait)
+		cond.wait(lock, [this]() { return !pending; });
+
+	if (pending) {
+		nb_overruns++;
+		nb_dropped += fill_frames;
+		fill_frames = 0;
+		return;
+	}
+
+	pending = true;
+	pending_frames = fill_frames;
+	fill ^= 1;
+	fill_frames = 0;
+
+	lock.unlock();
+	cond.notify_all();
+}
+
+int recording_sink::work(int noutput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	const unsigned int nb_channels = header.nb_channels;
+	int done = 0;
+
+	for (unsigned int c = 0; c < nb_channels; c++) {
+		std::vector<gr::tag_t> tags;
+		const uint64_t nread = nitems_read(c);
+
+		get_tags_in_range(tags, c, nread, nread + noutput_items,
+				overrun_key);
+		if (!tags.empty()) {
+			std::unique_lock<std::mutex> lock(mutex);
+			nb_overruns += tags.size();
+		}
+	}
+
+	while (done < noutput_items) {
+		const size_t nb = std::min<size_t>(noutput_items - done,
+				buffer_frames - fill_frames);
+		short *out = &buffers[fill][fill_frames * nb_channels];
+
+		for (unsigned int c = 0; c < nb_channels; c++) {
+			const short *in = static_cast<const short *>(
+					input_items[c]) + done;
+
+			for (size_t i = 0; i < nb; i++)
+				out[i * nb_channels + c] = in[i];
+		}
+
+		fill_frames += nb;
+		done += nb;
+
+		if (fill_frames == buffer_frames)
+			submit(false);
+	}
+
+	return noutput_items;
+}
+
+uint64_t recording_sink::samples_written()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return written;
+}
+
+uint64_t recording_sink::overruns()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return nb_overruns;
+}
+
+uint64_t recording_sink::dropped_samples()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return nb_dropped;
+}
+
+bool recording_sink::failed()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return error;
+}
+
+bool recording_source::read_header(const QString &filename,
+		recording_header &header)
+{
+	QFile file(filename);
+
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) !=
+			sizeof(header))
+		return false;
+
+	if (memcmp(header.magic, recording_magic, sizeof(header.magic)) ||
+			header.version != RECORDING_VERSION ||
+			header.nb_channels == 0 ||
+			header.nb_channels > RECORDING_MAX_CHANNELS ||
+			header.sample_rate <= 0.0)
+		return false;
+
+	/* Recordings that were not closed properly have no sample count */
+	const uint64_t available = (file.size() - sizeof(header)) /
+		(header.nb_channels * sizeof(short));
+	header.nb_samples = std::min(header.nb_samples ? header.nb_samples :
+			available, available);
+
+	return true;
+}
+
+recording_source::sptr recording_source::make(const QString &filename)
+{
+	recording_header header;
+
+	memset(&header, 0, sizeof(header));
+	if (!read_header(filename, header))
+		header.nb_channels = 0;
+
+	return gnuradio::get_initial_sptr(
+			new recording_source(filename, header));
+}
+
+recording_source::recording_source(const QString &filename,
+		const recording_header &_header) :
+	gr::sync_block("recording_source",
+			gr::io_signature::make(0, 0, 0),
+			gr::io_signature::make(_header.nb_channels,
+				_header.nb_channels, sizeof(float))),
+	file(filename),
+	header(_header),
+	data(nullptr),
+	speed(1.0),
+	repeat(false),
+	pos(0),
+	ref_pos(0)
+{
+	if (header.nb_channels && header.nb_samples &&
+			file.open(QIODevice::ReadOnly)) {
+		uchar *map = file.map(sizeof(header), header.nb_samples *
+				header.nb_channels * sizeof(short));
+		data = reinterpret_cast<const short *>(map);
+	}
+}
+
+recording_source::~recording_source()
+{
+	file.close();
+}
+
+bool recording_source::is_valid() const
+{
+	return !!data;
+}
+
+const recording_header &recording_source::get_header() const
+{
+	return header;
+}
+
+void recording_source::set_speed(double _speed)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	/* Restart the pacing from the current position */
+	speed = std::max(_speed, 1e-6);
+	ref_pos = pos;
+	ref_time = std::chrono::steady_clock::now();
+}
+
+void recording_source::set_repeat(bool _repeat)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	repeat = _repeat;
+}
+
+uint64_t recording_source::position() const
+{
+	return pos;
+}
+
+bool recording_source::start()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	ref_pos = pos;
+	ref_time = std::chrono::steady_clock::now();
+
+	return gr::sync_block::start();
+}
+
+int recording_source::work(int noutput_items,
+		gr_vector_const_void_star &input_items,
+		gr_vector_void_star &output_items)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (!data)
+		return WORK_DONE;
+
+	if (pos >= header.nb_samples) {
+		if (!repeat)
+			return WORK_DONE;
+
+		pos = 0;
+		ref_pos = 0;
+		ref_time = std::chrono::steady_clock::now();
+	}
+
+	/* Pace the output like a throttle block: only the samples that
+	 * are due at the selected speed are produced */
+	uint64_t nb;
+
+	for (;;) {
+		const double rate = header.sample_rate * speed;
+		const std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - ref_time;
+		const uint64_t due = ref_pos + uint64_t(elapsed.count() * rate);
+
+		if (due > pos) {
+			nb = std::min<uint64_t>(std::min<uint64_t>(noutput_items,
+					due - pos), header.nb_samples - pos);
+			break;
+		}
+
+		const double wait = std::min((pos + 1 - ref_pos) / rate -
+				elapsed.count(), RECORDING_MAX_WAIT_S);
+
+		lock.unlock();
+		boost::this_thread::sleep_for(boost::chrono::microseconds(
+					std::max<int64_t>(1, wait * 1e6)));
+		lock.lock();
+	}
+
+	const unsigned int nb_channels = header.nb_channels;
+	const short *in = &data[pos * nb_channels];
+
+	for (unsigned int c = 0; c < nb_channels; c++) {
+		float *out = static_cast<float *>(output_items[c]);
+		const float scale = header.scale[c];
+		const float offset = header.offset[c];
+
+		for (uint64_t i = 0; i < nb; i++)
+			out[i] = in[i * nb_channels + c] * scale + offset;
+	}
+
+	pos += nb;
+
+	return nb;
+}
+
+StreamRecorder::StreamRecorder(QObject *parent) :
+	QObject(parent),
+	sample_rate(0.0)
+{
+}
+
+StreamRecorder::~StreamRecorder()
+{
+	stop();
+}
+
+bool StreamRecorder::start(boost::shared_ptr<iio_manager> _iio,
+		unsigned int nb_channels, const QString &filename,
+		double _sample_rate, const std::vector<double> &scale,
+		const std::vector<double> &offset)
+{
+	stop();
+
+	if (!nb_channels || nb_channels > RECORDING_MAX_CHANNELS)
+		return false;
+
+	recording_header header;
+	memset(&header, 0, sizeof(header));
+	header.nb_channels = nb_channels;
+	header.sample_rate = _sample_rate;
+
+	for (unsigned int i = 0; i < nb_channels; i++) {
+		header.scale[i] = i < scale.size() ? scale[i] : 1.0;
+		header.offset[i] = i < offset.size() ? offset[i] : 0.0;
+	}
+
+	/* Each half of the double buffer holds about 100ms of data */
+	const size_t buffer_samples = std::max(_sample_rate / 10.0, 1024.0);
+
+	sink = recording_sink::make(filename, header, buffer_samples);
+	if (sink->failed())
+		return false;
+
+	iio = _iio;
+	sample_rate = _sample_rate;
+	top_block = gr::make_top_block("Stream recorder");
+
+	for (unsigned int i = 0; i < nb_channels; i++) {
+		auto source = iio->attach(i);
+
+		top_block->connect(source, 0, sink, i);
+		sources.push_back(source);
+	}
+
+	top_block->start();
+
+	return true;
+}
+
+void StreamRecorder::stop()
+{
+	if (!top_block)
+		return;
+
+	top_block->stop();
+	top_block->wait();
+
+	for (auto source : sources)
+		iio->detach(source);
+
+	sources.clear();
+	top_block.reset();
+}
+
+bool StreamRecorder::isRecording() const
+{
+	return !!top_block;
+}
+
+double StreamRecorder::sampleRate() const
+{
+	return sample_rate;
+}
+
+uint64_t StreamRecorder::samplesWritten() const
+{
+	return sink ? sink->samples_written() : 0;
+}
+
+uint64_t StreamRecorder::overruns() const
+{
+	return sink ? sink->overruns() : 0;
+}
+
+uint64_t StreamRecorder::droppedSamples() const
+{
+	return sink ? sink->dropped_samples() : 0;
+}
+
+bool StreamRecorder::failed() const
+{
+	return sink && sink->failed();
+}
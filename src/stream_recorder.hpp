@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAM_RECORDER_HPP
+#define STREAM_RECORDER_HPP
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/top_block.h>
+
+#include <QFile>
+#include <QObject>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stream_broadcaster.hpp"
+
+#define RECORDING_MAX_CHANNELS 4
+
+namespace adiscope {
+	class iio_manager;
+
+	/* Fixed size header at the start of a recording. It is followed
+	 * by the raw int16 samples, interleaved per channel. The volts of
+	 * a sample are raw * scale + offset. */
+	struct recording_header {
+		char magic[8];
+		uint32_t version;
+		uint32_t nb_channels;
+		double sample_rate;
+		uint64_t nb_samples;	// per channel
+		uint64_t overruns;
+		uint64_t dropped_samples;
+		int64_t start_time;	// ms since epoch
+		double scale[RECORDING_MAX_CHANNELS];
+		double offset[RECORDING_MAX_CHANNELS];
+		char reserved[392];
+	};
+
+	/* Writes the interleaved raw samples of its inputs to disk. The
+	 * samples are gathered in one of two buffers while a writer
+	 * thread stores the other one, so the flowgraph never waits for
+	 * the disk. When both buffers are busy the new samples are
+	 * dropped and counted as an overrun; so are the gaps marked by
+	 * "overrun" tags on the inputs. The file grows in large
+	 * preallocated steps and is trimmed to its contents on stop. */
+	class recording_sink : public gr::sync_block
+	{
+	public:
+		typedef boost::shared_ptr<recording_sink> sptr;
+
+		static sptr make(const QString &filename,
+				const recording_header &header,
+				size_t buffer_samples);
+		~recording_sink();
+
+		bool start();
+		bool stop();
+
+		int work(int noutput_items,
+				gr_vector_const_void_star &input_items,
+				gr_vector_void_star &output_items);
+
+		uint64_t samples_written();
+		uint64_t overruns();
+		uint64_t dropped_samples();
+		bool failed();
+
+	private:
+		recording_sink(const QString &filename,
+				const recording_header &header,
+				size_t buffer_samples);
+
+		QFile file;
+		recording_header header;
+		qint64 allocated;
+
+		std::vector<short> buffers[2];
+		size_t buffer_frames;
+		unsigned int fill;
+		size_t fill_frames;
+
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::thread writer;
+		bool pending;
+		size_t pending_frames;
+		bool quit;
+		bool error;
+
+		uint64_t written;
+		uint64_t nb_overruns;
+		uint64_t nb_dropped;
+		pmt::pmt_t overrun_key;
+
+		void writer_loop();
+		void submit(bool wait);
+		void write_header();
+	};
+
+	/* Plays back a recording, converted to volts, at a multiple of
+	 * its original sample rate. The file is memory mapped. */
+	class recording_source : public gr::sync_block
+	{
+	public:
+		typedef boost::shared_ptr<recording_source> sptr;
+
+		static sptr make(const QString &filename);
+		~recording_source();
+
+		/* Read the header of a recording, false if it is not one */
+		static bool read_header(const QString &filename,
+				recording_header &header);
+
+		bool is_valid() const;
+		const recording_header &get_header() const;
+
+		void set_speed(double speed);
+		void set_repeat(bool repeat);
+		uint64_t position() const;
+
+		bool start();
+
+		int work(int noutput_items,
+				gr_vector_const_void_star &input_items,
+				gr_vector_void_star &output_items);
+
+	private:
+		explicit recording_source(const QString &filename,
+				const recording_header &header);
+
+		QFile file;
+		recording_header header;
+		const short *data;
+
+		std::mutex mutex;
+		double speed;
+		bool repeat;
+		uint64_t pos;
+		uint64_t ref_pos;
+		std::chrono::steady_clock::time_point ref_time;
+	};
+
+	/* Records the raw samples of all the channels of an iio_manager,
+	 * through consumers attached to its broadcasters, so that the
+	 * flowgraph of the instrument is left untouched */
+	class StreamRecorder : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit StreamRecorder(QObject *parent = nullptr);
+		~StreamRecorder();
+
+		bool start(boost::shared_ptr<iio_manager> iio,
+				unsigned int nb_channels,
+				const QString &filename, double sample_rate,
+				const std::vector<double> &scale,
+				const std::vector<double> &offset);
+		void stop();
+		bool isRecording() const;
+
+		double sampleRate() const;
+		uint64_t samplesWritten() const;
+		uint64_t overruns() const;
+		uint64_t droppedSamples() const;
+		bool failed() const;
+
+	private:
+		boost::shared_ptr<iio_manager> iio;
+		gr::top_block_sptr top_block;
+		recording_sink::sptr sink;
+		std::vector<broadcaster_source::sptr> sources;
+		double sample_rate;
+	};
+}
+
+#endif /* STREAM_RECORDER_HPP */
@@ -81,6 +81,7 @@
 
 #define TIMER_TIMEOUT_MS 5000
 #define ALIVE_TIMER_TIMEOUT_MS 5000
+#define CALIB_DRIFT_TIMER_TIMEOUT_MS 60000
 
 using namespace adiscope;
 using namespace libm2k::context;
@@ -217,6 +218,9 @@ ToolLauncher::ToolLauncher(QString prevCrashDump, QWidget *parent) :
 	alive_timer = new QTimer();
 	connect(alive_timer, SIGNAL(timeout()), this, SLOT(ping()));
 
+	calib_drift_timer = new QTimer();
+	connect(calib_drift_timer, SIGNAL(timeout()), this, SLOT(checkCalibrationDrift()));
+
 	QSettings oldSettings;
 	QFile scopy(oldSettings.fileName());
 	QFile tempFile(oldSettings.fileName() + ".bak");
@@ -417,6 +421,37 @@ void ToolLauncher::_setupToolMenu()
 	connect(menu, &ToolMenu::toolSelected,
 		this, &ToolLauncher::_toolSelected);
 
+	/* A tool that was not opened yet can still be started from its
+	 * menu run button. Create it, then check the button again so that
+	 * the tool's own run button handlers see the toggle. The ADC based
+	 * tools share an exclusive group, which only lets a CustomPushButton
+	 * uncheck itself. */
+	for (int i = TOOL_OSCILLOSCOPE; i < TOOL_DEBUGGER; i++) {
+		enum tool t = static_cast<enum tool>(i);
+		auto btn = dynamic_cast<CustomPushButton *>(
+					menu->getToolMenuItemFor(t)->getToolStopBtn());
+		if (!btn) {
+			continue;
+		}
+
+		connect(btn, &QPushButton::toggled, this, [=](bool checked) {
+			if (!checked || !pendingTools.contains(t)) {
+				return;
+			}
+
+			if (!instantiateTool(t)) {
+				return;
+			}
+
+			QTimer::singleShot(0, btn, [=]() {
+				btn->blockSignals(true);
+				btn->setChecked(false);
+				btn->blockSignals(false);
+				btn->setChecked(true);
+			});
+		});
+	}
+
 	menu->getButtonGroup()->addButton(ui->btnHome);
 	menu->getButtonGroup()->addButton(ui->prefBtn);
 	menu->getButtonGroup()->addButton(ui->btnNotes);
@@ -435,7 +470,7 @@ void ToolLauncher::_setupToolMenu()
 void ToolLauncher::_toolSelected(enum tool tool)
 {
 	Tool *selectedTool = nullptr;
-	selectedToolId = tool;
+	instantiateTool(tool);
 	switch(tool) {
 	case TOOL_OSCILLOSCOPE:
 		selectedTool = oscilloscope;
@@ -474,6 +509,13 @@ void ToolLauncher::_toolSelected(enum tool tool)
 		break;
 	}
 
+	/* The tool could not be created */
+	if (!selectedTool && tool != TOOL_LAUNCHER) {
+		return;
+	}
+
+	selectedToolId = tool;
+
 	if (selectedTool) {
 		swapMenu(selectedTool);
 	}
@@ -635,6 +677,7 @@ void ToolLauncher::resetSession()
 		this->disconnect();
 	}
 	pathToFile = "";
+	sessionFile = "";
 	indexFile = "";
 	deviceInfo = "";
 	if(!ui->btnMenu->isChecked()){
@@ -798,6 +841,7 @@ ToolLauncher::~ToolLauncher()
 
 	delete search_timer;
 	delete alive_timer;
+	delete calib_drift_timer;
 
 	delete infoWidget;
 	delete m_phoneHome;
@@ -1100,46 +1144,73 @@ void ToolLauncher::setButtonBackground(bool on)
 
 void ToolLauncher::btnOscilloscope_clicked()
 {
+	if (!instantiateTool(TOOL_OSCILLOSCOPE)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(oscilloscope));
 }
 
 void ToolLauncher::btnSignalGenerator_clicked()
 {
+	if (!instantiateTool(TOOL_SIGNAL_GENERATOR)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(signal_generator));
 }
 
 void ToolLauncher::btnDMM_clicked()
 {
+	if (!instantiateTool(TOOL_DMM)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(dmm));
 }
 
 void ToolLauncher::btnPowerControl_clicked()
 {
+	if (!instantiateTool(TOOL_POWER_CONTROLLER)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(power_control));
 }
 
 void ToolLauncher::btnLogicAnalyzer_clicked()
 {
+	if (!instantiateTool(TOOL_LOGIC_ANALYZER)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(logic_analyzer));
 }
 
 void adiscope::ToolLauncher::btnPatternGenerator_clicked()
 {
+	if (!instantiateTool(TOOL_PATTERN_GENERATOR)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(pattern_generator));
 }
 
 void adiscope::ToolLauncher::btnNetworkAnalyzer_clicked()
 {
+	if (!instantiateTool(TOOL_NETWORK_ANALYZER)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(network_analyzer));
 }
 
 void adiscope::ToolLauncher::btnSpectrumAnalyzer_clicked()
 {
+	if (!instantiateTool(TOOL_SPECTRUM_ANALYZER)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(spectrum_analyzer));
 }
 
 void adiscope::ToolLauncher::btnDigitalIO_clicked()
 {
+	if (!instantiateTool(TOOL_DIGITALIO)) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(dio));
 }
 
@@ -1150,11 +1221,17 @@ void adiscope::ToolLauncher::on_btnHome_clicked()
 
 void adiscope::ToolLauncher::btnDebugger_clicked()
 {
+	if (!debugger) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(debugger));
 }
 
 void adiscope::ToolLauncher::btnCalibration_clicked()
 {
+	if (!manual_calibration) {
+		return;
+	}
 	swapMenu(static_cast<QWidget *>(manual_calibration));
 }
 
@@ -1223,10 +1300,12 @@ void adiscope::ToolLauncher::disconnect()
 			iio->stop_all();
 		}
 		alive_timer->stop();
+		calib_drift_timer->stop();
 
 		ui->saveBtn->parentWidget()->setEnabled(false);
 
 		destroyContext();
+		sessionFile = "";
 		loadToolTips(false);
 		resetStylesheets();
 		auto infoPg = selectedDev->infoPage();
@@ -1255,6 +1334,44 @@ void adiscope::ToolLauncher::ping()
 	}
 }
 
+void adiscope::ToolLauncher::checkCalibrationDrift()
+{
+	if (!calib || calibrating || !prefPanel->getUseCalibCache()) {
+		return;
+	}
+
+	/* Refresh the coefficients once the board moved out of the
+	 * temperature range they were computed for */
+	if (!calib->temperatureDrifted()) {
+		return;
+	}
+
+	/* Stored coefficients are applied without disturbing the tools */
+	if (calib->calibrateFromCache()) {
+		qDebug(CAT_TOOL_LAUNCHER) << "Temperature drift detected, using stored coefficients";
+		selectedDev->infoPage()->setCalibrationStatusLabel(
+				tr("Calibrated from stored coefficients"));
+		return;
+	}
+
+	/* A new calibration stops the running tools, so it is left to the
+	 * user while a measurement is in progress */
+	bool running = (dmm && dmm->isRunning()) ||
+			(oscilloscope && oscilloscope->isRunning()) ||
+			(signal_generator && signal_generator->isRunning()) ||
+			(spectrum_analyzer && spectrum_analyzer->isRunning()) ||
+			(network_analyzer && network_analyzer->isRunning());
+
+	if (running) {
+		selectedDev->infoPage()->setCalibrationStatusLabel(
+				tr("Temperature changed, calibrate again when convenient"));
+		return;
+	}
+
+	qDebug(CAT_TOOL_LAUNCHER) << "Temperature drift detected, recalibrating";
+	requestCalibration();
+}
+
 void adiscope::ToolLauncher::connectBtn_clicked(bool pressed)
 {
 	auto connectedDev = getConnectedDevice();
@@ -1322,6 +1439,7 @@ void adiscope::ToolLauncher::connectBtn_clicked(bool pressed)
 				setDynamicProperty(ui->btnConnect, "connected", true);
 
 				alive_timer->start(ALIVE_TIMER_TIMEOUT_MS);
+				calib_drift_timer->start(CALIB_DRIFT_TIMER_TIMEOUT_MS);
 				ui->saveBtn->parentWidget()->setEnabled(true);
 			} else {
 				setDynamicProperty(ui->btnConnect, "failed", true);
@@ -1433,6 +1551,7 @@ void adiscope::ToolLauncher::destroyContext()
 	}
 
 	toolList.clear();
+	pendingTools.clear();
 }
 
 bool ToolLauncher::loadDecoders(QString path)
@@ -1486,11 +1605,12 @@ void adiscope::ToolLauncher::restoreRunningTools() {
 
 void adiscope::ToolLauncher::saveRunningToolsBeforeCalibration()
 {
-	if (dmm->isRunning()) calibration_saved_tools.push_back(dmm);
-	if (oscilloscope->isRunning()) calibration_saved_tools.push_back(oscilloscope);
-	if (signal_generator->isRunning()) calibration_saved_tools.push_back(signal_generator);
-	if (spectrum_analyzer->isRunning()) calibration_saved_tools.push_back(spectrum_analyzer);
-	if (network_analyzer->isRunning()) calibration_saved_tools.push_back(network_analyzer);
+	/* Tools that were never opened are not running */
+	if (dmm && dmm->isRunning()) calibration_saved_tools.push_back(dmm);
+	if (oscilloscope && oscilloscope->isRunning()) calibration_saved_tools.push_back(oscilloscope);
+	if (signal_generator && signal_generator->isRunning()) calibration_saved_tools.push_back(signal_generator);
+	if (spectrum_analyzer && spectrum_analyzer->isRunning()) calibration_saved_tools.push_back(spectrum_analyzer);
+	if (network_analyzer && network_analyzer->isRunning()) calibration_saved_tools.push_back(network_analyzer);
 	menu->getToolMenuItemFor(TOOL_DMM)->setCalibrating(true);
 	menu->getToolMenuItemFor(TOOL_OSCILLOSCOPE)->setCalibrating(true);
 	menu->getToolMenuItemFor(TOOL_SIGNAL_GENERATOR)->setCalibrating(true);
@@ -1599,14 +1719,23 @@ QPair<bool, bool> adiscope::ToolLauncher::calibrate()
 			skipCalib = true;
 			ok = true;
 
+		} else if (initialCalibrationFlag && prefPanel->getUseCalibCache()
+			   && calib->calibrateFromCache()) {
+			statusLabel = tr("Calibrated from stored coefficients");
+			skipCalib = true;
+			ok = true;
 		} else {
 			// always calibrate if initial flag is set
 			// if it's calibrated and skip_calibration_if_calibrated - do not calibrate
 			if (!(initialCalibrationFlag && skip_calibration_if_already_calibrated && calib->isCalibrated() )) {
 				statusLabel = tr("Calibrating ... ");
 				ok = calib->calibrateAll();
+				if (ok && prefPanel->getUseCalibCache()) {
+					calib->saveToCache();
+				}
 			} else {
 				statusLabel = tr("Calibration skipped because already calibrated.");
+				calib->markCalibratedNow();
 				skipCalib = true;
 				ok = true;
 			}
@@ -1635,26 +1764,13 @@ void adiscope::ToolLauncher::enableAdcBasedTools()
 {
 	try {
 		if (filter->compatible(TOOL_OSCILLOSCOPE)) {
-			oscilloscope = new Oscilloscope(ctx, filter, menu->getToolMenuItemFor(TOOL_OSCILLOSCOPE),
-							&js_engine, this);
-			toolList.push_back(oscilloscope);
+			registerLazyTool(TOOL_OSCILLOSCOPE);
 			adc_users_group.addButton(menu->getToolMenuItemFor(TOOL_OSCILLOSCOPE)->getToolStopBtn());
-			connect(oscilloscope, &Oscilloscope::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_OSCILLOSCOPE)->getToolBtn()->click();
-			});
-			if (logic_analyzer) {
-				oscilloscope->setLogicAnalyzer(logic_analyzer);
-			}
 		}
 
 		if (filter->compatible(TOOL_DMM)) {
-			dmm = new DMM(ctx, filter, menu->getToolMenuItemFor(TOOL_DMM),
-				      &js_engine, this);
+			registerLazyTool(TOOL_DMM);
 			adc_users_group.addButton(menu->getToolMenuItemFor(TOOL_DMM)->getToolStopBtn());
-			toolList.push_back(dmm);
-			connect(dmm, &DMM::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_DMM)->getToolBtn()->click();
-			});
 		}
 
 		if (filter->compatible(TOOL_DEBUGGER)) {
@@ -1673,23 +1789,13 @@ void adiscope::ToolLauncher::enableAdcBasedTools()
 		}
 
 		if (filter->compatible(TOOL_SPECTRUM_ANALYZER)) {
-			spectrum_analyzer = new SpectrumAnalyzer(ctx, filter, menu->getToolMenuItemFor(TOOL_SPECTRUM_ANALYZER),&js_engine, this);
-			toolList.push_back(spectrum_analyzer);
+			registerLazyTool(TOOL_SPECTRUM_ANALYZER);
 			adc_users_group.addButton(menu->getToolMenuItemFor(TOOL_SPECTRUM_ANALYZER)->getToolStopBtn());
-			connect(spectrum_analyzer, &SpectrumAnalyzer::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_SPECTRUM_ANALYZER)->getToolBtn()->click();
-			});
 		}
 
 		if (filter->compatible((TOOL_NETWORK_ANALYZER))) {
-
-			network_analyzer = new NetworkAnalyzer(ctx, filter, menu->getToolMenuItemFor(TOOL_NETWORK_ANALYZER), &js_engine, this);
+			registerLazyTool(TOOL_NETWORK_ANALYZER);
 			adc_users_group.addButton(menu->getToolMenuItemFor(TOOL_NETWORK_ANALYZER)->getToolStopBtn());
-			toolList.push_back(network_analyzer);
-			connect(network_analyzer, &NetworkAnalyzer::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_NETWORK_ANALYZER)->getToolBtn()->click();
-			});
-			network_analyzer->setOscilloscope(oscilloscope);
 		}
 
 		m_adc_tools_failed = false;
@@ -1705,12 +1811,7 @@ void adiscope::ToolLauncher::enableDacBasedTools()
 {
 	try {
 		if (filter->compatible(TOOL_SIGNAL_GENERATOR)) {
-			signal_generator = new SignalGenerator(ctx, filter,
-							       menu->getToolMenuItemFor(TOOL_SIGNAL_GENERATOR), &js_engine, this);
-			toolList.push_back(signal_generator);
-			connect(signal_generator, &SignalGenerator::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_SIGNAL_GENERATOR)->getToolBtn()->click();
-			});
+			registerLazyTool(TOOL_SIGNAL_GENERATOR);
 		}
 		if (pathToFile != "") {
 			this->tl_api->load(pathToFile);
@@ -1735,6 +1836,169 @@ void adiscope::ToolLauncher::enableDacBasedTools()
 	}
 }
 
+void adiscope::ToolLauncher::registerLazyTool(enum tool tool)
+{
+	if (!pendingTools.contains(tool)) {
+		pendingTools.push_back(tool);
+	}
+
+	/* The menu item is normally enabled by the Tool constructor; enable
+	 * it here so the tool can be opened before it exists. */
+	menu->getToolMenuItemFor(tool)->setDisabled(false);
+}
+
+Tool *adiscope::ToolLauncher::getTool(enum tool tool) const
+{
+	switch (tool) {
+	case TOOL_OSCILLOSCOPE:
+		return oscilloscope;
+	case TOOL_SPECTRUM_ANALYZER:
+		return spectrum_analyzer;
+	case TOOL_NETWORK_ANALYZER:
+		return network_analyzer;
+	case TOOL_SIGNAL_GENERATOR:
+		return signal_generator;
+	case TOOL_LOGIC_ANALYZER:
+		return logic_analyzer;
+	case TOOL_PATTERN_GENERATOR:
+		return pattern_generator;
+	case TOOL_DIGITALIO:
+		return dio;
+	case TOOL_DMM:
+		return dmm;
+	case TOOL_POWER_CONTROLLER:
+		return power_control;
+	case TOOL_DEBUGGER:
+		return debugger;
+	case TOOL_CALIBRATION:
+		return manual_calibration;
+	default:
+		return nullptr;
+	}
+}
+
+Tool *adiscope::ToolLauncher::instantiateTool(enum tool tool)
+{
+	if (!pendingTools.contains(tool)) {
+		return getTool(tool);
+	}
+
+	pendingTools.removeAll(tool);
+
+	Tool *created = nullptr;
+	ToolMenuItem *item = menu->getToolMenuItemFor(tool);
+
+	try {
+		switch (tool) {
+		case TOOL_OSCILLOSCOPE:
+			/* The mixed signal view needs the logic analyzer */
+			instantiateTool(TOOL_LOGIC_ANALYZER);
+
+			oscilloscope = new Oscilloscope(ctx, filter, item,
+							&js_engine, this);
+			connect(oscilloscope, &Oscilloscope::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_OSCILLOSCOPE)->getToolBtn()->click();
+			});
+			if (logic_analyzer) {
+				oscilloscope->setLogicAnalyzer(logic_analyzer);
+			}
+			created = oscilloscope;
+			break;
+		case TOOL_DMM:
+			dmm = new DMM(ctx, filter, item, &js_engine, this);
+			connect(dmm, &DMM::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_DMM)->getToolBtn()->click();
+			});
+			created = dmm;
+			break;
+		case TOOL_SPECTRUM_ANALYZER:
+			spectrum_analyzer = new SpectrumAnalyzer(ctx, filter, item, &js_engine, this);
+			connect(spectrum_analyzer, &SpectrumAnalyzer::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_SPECTRUM_ANALYZER)->getToolBtn()->click();
+			});
+			created = spectrum_analyzer;
+			break;
+		case TOOL_NETWORK_ANALYZER:
+			/* The buffer previewer exports its data to the oscilloscope */
+			instantiateTool(TOOL_OSCILLOSCOPE);
+
+			network_analyzer = new NetworkAnalyzer(ctx, filter, item, &js_engine, this);
+			connect(network_analyzer, &NetworkAnalyzer::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_NETWORK_ANALYZER)->getToolBtn()->click();
+			});
+			network_analyzer->setOscilloscope(oscilloscope);
+			created = network_analyzer;
+			break;
+		case TOOL_SIGNAL_GENERATOR:
+			signal_generator = new SignalGenerator(ctx, filter, item, &js_engine, this);
+			connect(signal_generator, &SignalGenerator::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_SIGNAL_GENERATOR)->getToolBtn()->click();
+			});
+			created = signal_generator;
+			break;
+		case TOOL_DIGITALIO:
+			dio = new DigitalIO(nullptr, filter, item, dioManager, &js_engine, this);
+			connect(dio, &DigitalIO::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_DIGITALIO)->getToolBtn()->click();
+			});
+			created = dio;
+			break;
+		case TOOL_POWER_CONTROLLER:
+			power_control = new PowerController(ctx, item, &js_engine, this);
+			connect(power_control, &PowerController::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_POWER_CONTROLLER)->getToolBtn()->click();
+			});
+			created = power_control;
+			break;
+		case TOOL_LOGIC_ANALYZER:
+			logic_analyzer = new logic::LogicAnalyzer(ctx, filter, item, &js_engine, this);
+			connect(logic_analyzer, &logic::LogicAnalyzer::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_LOGIC_ANALYZER)->getToolBtn()->click();
+			});
+			created = logic_analyzer;
+			break;
+		case TOOL_PATTERN_GENERATOR:
+			pattern_generator = new logic::PatternGenerator(ctx, filter, item,
+									&js_engine, dioManager, this);
+			connect(pattern_generator, &logic::PatternGenerator::showTool, [=]() {
+				menu->getToolMenuItemFor(TOOL_PATTERN_GENERATOR)->getToolBtn()->click();
+			});
+			created = pattern_generator;
+			break;
+		default:
+			break;
+		}
+	} catch (libm2k::m2k_exception &e) {
+		qDebug(CAT_TOOL_LAUNCHER) << e.what();
+		/* It will not be created again until the next connection */
+		item->setDisabled(true);
+		return nullptr;
+	}
+
+	if (!created) {
+		return nullptr;
+	}
+
+	toolList.push_back(created);
+	created->setNativeDialogs(m_useNativeDialogs);
+
+	/* Apply the session that was loaded before this tool existed */
+	if (!sessionFile.isEmpty()) {
+		QSettings sessionSettings(sessionFile, QSettings::IniFormat);
+		created->getApi()->load(sessionSettings);
+		created->settingsLoaded();
+	}
+
+	return created;
+}
+
+void adiscope::ToolLauncher::instantiatePendingTools()
+{
+	while (!pendingTools.empty()) {
+		instantiateTool(pendingTools.front());
+	}
+}
+
 bool adiscope::ToolLauncher::switchContext(const QString& uri)
 {
 	destroyContext();
@@ -1797,40 +2061,19 @@ bool adiscope::ToolLauncher::switchContext(const QString& uri)
 		}
 
 		if (filter->compatible(TOOL_DIGITALIO)) {
-			dio = new DigitalIO(nullptr, filter, menu->getToolMenuItemFor(TOOL_DIGITALIO),
-					    dioManager, &js_engine, this);
-			toolList.push_back(dio);
-			connect(dio, &DigitalIO::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_DIGITALIO)->getToolBtn()->click();
-			});
+			registerLazyTool(TOOL_DIGITALIO);
 		}
 
-
 		if (filter->compatible(TOOL_POWER_CONTROLLER)) {
-			power_control = new PowerController(ctx, menu->getToolMenuItemFor(TOOL_POWER_CONTROLLER),
-							    &js_engine, this);
-			toolList.push_back(power_control);
-			connect(power_control, &PowerController::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_POWER_CONTROLLER)->getToolBtn()->click();
-			});
+			registerLazyTool(TOOL_POWER_CONTROLLER);
 		}
 
 		if (filter->compatible(TOOL_LOGIC_ANALYZER)) {
-			logic_analyzer = new logic::LogicAnalyzer(ctx, filter, menu->getToolMenuItemFor(TOOL_LOGIC_ANALYZER),
-								  &js_engine, this);
-			toolList.push_back(logic_analyzer);
-			connect(logic_analyzer, &logic::LogicAnalyzer::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_LOGIC_ANALYZER)->getToolBtn()->click();
-			});
+			registerLazyTool(TOOL_LOGIC_ANALYZER);
 		}
 
 		if (filter->compatible((TOOL_PATTERN_GENERATOR))) {
-			pattern_generator = new logic::PatternGenerator(ctx, filter,
-									menu->getToolMenuItemFor(TOOL_PATTERN_GENERATOR), &js_engine, dioManager, this);
-			toolList.push_back(pattern_generator);
-			connect(pattern_generator, &logic::PatternGenerator::showTool, [=]() {
-				menu->getToolMenuItemFor(TOOL_PATTERN_GENERATOR)->getToolBtn()->click();
-			});
+			registerLazyTool(TOOL_PATTERN_GENERATOR);
 		}
 	}
 
@@ -134,6 +134,7 @@ private Q_SLOTS:
 	void search();
 	void update();
 	void ping();
+	void checkCalibrationDrift();
 
 	void btnOscilloscope_clicked();
 	void btnSignalGenerator_clicked();
@@ -179,6 +180,13 @@ private:
 	QVector<QString> searchDevices();
 	void swapMenu(QWidget *menu);
 	void destroyContext();
+
+	/* Tools are only built the first time they are opened or started */
+	void registerLazyTool(enum tool tool);
+	Tool *getTool(enum tool tool) const;
+	Tool *instantiateTool(enum tool tool);
+	void instantiatePendingTools();
+
 	bool loadDecoders(QString path);
 	bool switchContext(const QString& uri);
 	void resetStylesheets();
@@ -228,8 +236,9 @@ private:
 
 	std::vector<DeviceWidget *> devices;
 	QVector<Tool*> toolList;
+	QVector<enum tool> pendingTools;
 
-	QTimer *search_timer, *alive_timer;
+	QTimer *search_timer, *alive_timer, *calib_drift_timer;
 	QFutureWatcher<QVector<QString>> watcher;
 	QFuture<QVector<QString>> future;
 	QFuture<QPair<bool, bool>> calibration_thread;
@@ -281,6 +290,7 @@ private:
 	QString indexFile;
 	QString deviceInfo;
 	QString pathToFile;
+	QString sessionFile;
 
 	QButtonGroup *devices_btn_group;
 
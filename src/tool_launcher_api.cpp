@@ -164,6 +164,12 @@ bool ToolLauncher_API::connect(const QString& uri)
 		QThread::msleep(10);
 	} while (!done);
 
+	/* Scripts expect every instrument to be registered in the JS
+	 * engine as soon as the connection is done */
+	if (did_connect) {
+		tl->instantiatePendingTools();
+	}
+
 	return did_connect;
 }
 
@@ -183,6 +189,9 @@ void ToolLauncher_API::load(const QString& file)
 {
 	QSettings settings(file, QSettings::IniFormat);
 
+	/* Tools that were not opened yet load it when they are created */
+	tl->sessionFile = file;
+
 	this->ApiObject::load(settings);
 
 	if (tl->notesPanel)
@@ -291,6 +300,9 @@ void ToolLauncher_API::save(QSettings *settings) {
 
 void ToolLauncher_API::save(const QString& file)
 {
+	/* A session file has to describe every instrument */
+	tl->instantiatePendingTools();
+
 	QSettings settings(file, QSettings::IniFormat);
 	save(&settings);
 }
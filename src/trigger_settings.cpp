@@ -70,6 +70,7 @@ TriggerSettings::TriggerSettings(M2kAnalogIn* libm2k_adc,
 	m_trigger(nullptr),
 	current_channel(0),
 	temporarily_disabled(false),
+	m_continuous(false),
 	adc_running(false),
 	trigger_raw_delay(0),
 	daisyChainCompensation(0),
@@ -438,7 +439,7 @@ void TriggerSettings::ui_reconf_on_extern_toggled(bool checked)
 
 void TriggerSettings::on_cmb_analog_extern_currentIndexChanged(int index)
 {
-	if (adc_running) {
+	if (adc_running && !m_continuous) {
 		libm2k::M2K_TRIGGER_MODE mode;
 		int start_idx = static_cast<int>(libm2k::EXTERNAL) + 1;
 		mode = static_cast<libm2k::M2K_TRIGGER_MODE>(start_idx + index);
@@ -474,6 +475,23 @@ void TriggerSettings::autoTriggerEnable()
 	}
 }
 
+/* While enabled, the hardware acquires continuously and ignores the
+ * trigger settings, which are written back when it is disabled */
+void TriggerSettings::setContinuousAcquisition(bool en)
+{
+	if (m_continuous == en)
+		return;
+
+	m_continuous = en;
+
+	if (en || temporarily_disabled) {
+		writeHwMode(libm2k::ALWAYS);
+	} else {
+		writeHwMode(determineTriggerMode(ui->intern_en->isChecked(),
+						 ui->extern_en->isChecked()));
+	}
+}
+
 bool TriggerSettings::triggerIsArmed() const
 {
 	return ui->intern_en->isChecked() || ui->extern_en->isChecked();
@@ -668,6 +686,9 @@ void TriggerSettings::writeHwDigitalCondition(int cond)
 
 void TriggerSettings::writeHwMode(int mode)
 {
+	if (m_continuous)
+		mode = libm2k::ALWAYS;
+
 	if (adc_running) {
 		try {
 			m_trigger->setAnalogMode(currentChannel(),
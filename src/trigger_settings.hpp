@@ -101,6 +101,7 @@ namespace adiscope {
 		void setTriggerHystStep(int chn, double step);
 		void autoTriggerDisable();
 		void autoTriggerEnable();
+		void setContinuousAcquisition(bool en);
 		void updateHwVoltLevels(int chnIdx);
 		void setAdcRunningState(bool on);
 		void onSpinboxTriggerLevelChanged(double);
@@ -155,6 +156,7 @@ namespace adiscope {
 		PositionSpinButton *trigger_hysteresis;
 		int current_channel;
 		bool temporarily_disabled;
+		bool m_continuous;
 		bool trigger_auto_mode;
 		long long trigger_raw_delay;
 		long long daisyChainCompensation;
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "waterfall_display.hpp"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace adiscope;
+
+/* Color map stops, from the lowest to the highest magnitude */
+static const QRgb waterfall_stops[] = {
+	qRgb(0, 0, 0),
+	qRgb(0, 0, 140),
+	qRgb(74, 100, 255),
+	qRgb(200, 0, 200),
+	qRgb(255, 64, 0),
+	qRgb(255, 220, 0),
+	qRgb(255, 255, 255),
+};
+
+WaterfallDisplay::WaterfallDisplay(QWidget *parent, int columns, int history) :
+	QWidget(parent),
+	m_image(columns, history, QImage::Format_RGB32),
+	m_lut(256),
+	m_row(0),
+	m_min(-120.0),
+	m_scale(255.0 / 120.0)
+{
+	setAttribute(Qt::WA_OpaquePaintEvent);
+	setMinimumHeight(100);
+
+	buildLut();
+	clear();
+}
+
+WaterfallDisplay::~WaterfallDisplay()
+{
+}
+
+void WaterfallDisplay::buildLut()
+{
+	const int nb_stops = sizeof(waterfall_stops) / sizeof(waterfall_stops[0]);
+
+	for (int i = 0; i < m_lut.size(); i++) {
+		double pos = (double)i * (nb_stops - 1) / (m_lut.size() - 1);
+		int idx = std::min((int)pos, nb_stops - 2);
+		double frac = pos - idx;
+
+		QRgb a = waterfall_stops[idx];
+		QRgb b = waterfall_stops[idx + 1];
+
+		m_lut[i] = qRgb(qRed(a) + frac * (qRed(b) - qRed(a)),
+				qGreen(a) + frac * (qGreen(b) - qGreen(a)),
+				qBlue(a) + frac * (qBlue(b) - qBlue(a)));
+	}
+}
+
+int WaterfallDisplay::history() const
+{
+	return m_image.height();
+}
+
+void WaterfallDisplay::setHistory(int rows)
+{
+	if (rows == m_image.height() || rows <= 0)
+		return;
+
+	m_image = QImage(m_image.width(), rows, QImage::Format_RGB32);
+	m_row = 0;
+	clear();
+}
+
+void WaterfallDisplay::setRange(double min, double max)
+{
+	if (max <= min)
+		return;
+
+	m_min = min;
+	m_scale = 255.0 / (max - min);
+}
+
+void WaterfallDisplay::clear()
+{
+	m_image.fill(m_lut[0]);
+	update();
+}
+
+void WaterfallDisplay::addRow(const double *data, size_t nb_bins)
+{
+	if (!data || !nb_bins)
+		return;
+
+	/* Rows are written upwards, so that the image read from m_row
+	 * downwards (wrapping around) goes from the newest to the oldest */
+	m_row = (m_row + m_image.height() - 1) % m_image.height();
+
+	QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(m_row));
+	const size_t columns = m_image.width();
+
+	for (size_t c = 0; c < columns; c++) {
+		size_t first = c * nb_bins / columns;
+		size_t last = std::max(first + 1, (c + 1) * nb_bins / columns);
+
+		double value = data[first];
+		for (size_t i = first + 1; i < last; i++)
+			value = std::max(value, data[i]);
+
+		/* Empty bins are -inf or NaN in dB; clamp before the cast,
+		 * which is undefined out of the range of int */
+		double pos = (value - m_min) * m_scale;
+		int idx = 0;
+		if (std::isfinite(pos))
+			idx = (int)std::min(std::max(pos, 0.0), 255.0);
+		line[c] = m_lut[idx];
+	}
+
+	/* Repaints are coalesced by Qt to the display refresh */
+	update();
+}
+
+void WaterfallDisplay::paintEvent(QPaintEvent *event)
+{
+	Q_UNUSED(event);
+
+	QPainter painter(this);
+	const int rows = m_image.height();
+	const int newest = rows - m_row;
+	const QRect area = rect();
+
+	int split = area.height() * newest / rows;
+
+	painter.drawImage(QRect(area.left(), area.top(), area.width(), split),
+			  m_image, QRect(0, m_row, m_image.width(), newest));
+
+	if (m_row) {
+		painter.drawImage(QRect(area.left(), area.top() + split,
+					area.width(), area.height() - split),
+				  m_image, QRect(0, 0, m_image.width(), m_row));
+	}
+}
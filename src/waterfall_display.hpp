@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WATERFALL_DISPLAY_HPP
+#define WATERFALL_DISPLAY_HPP
+
+#include <QImage>
+#include <QVector>
+#include <QWidget>
+
+namespace adiscope {
+/* Time-frequency view of the spectrum. Each FFT frame becomes one row
+ * of a preallocated image that is used as a circular buffer; the rows
+ * are colored through a lookup table and the whole history is drawn
+ * with a single image blit, newest row on top. */
+class WaterfallDisplay : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit WaterfallDisplay(QWidget *parent = nullptr,
+				  int columns = 1024, int history = 256);
+	~WaterfallDisplay();
+
+	int history() const;
+	void setHistory(int rows);
+
+	/* Magnitude range mapped onto the color map */
+	void setRange(double min, double max);
+
+	void clear();
+
+public Q_SLOTS:
+	/* Add one spectrum frame. When there are more bins than columns,
+	 * each column keeps the maximum of its bins so that narrow peaks
+	 * stay visible. */
+	void addRow(const double *data, size_t nb_bins);
+
+protected:
+	void paintEvent(QPaintEvent *event);
+
+private:
+	QImage m_image;
+	QVector<QRgb> m_lut;
+	int m_row;
+	double m_min;
+	double m_scale;
+
+	void buildLut();
+};
+}
+
+#endif /* WATERFALL_DISPLAY_HPP */
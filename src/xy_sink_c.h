@@ -68,6 +68,10 @@ namespace adiscope {
       virtual void set_update_time(double t) = 0;
       virtual void set_nsamps(const int newsize) = 0;
 
+      // When enabled, the frames dropped by the update time are still
+      // sent to the plot to be accumulated into its persistence layer
+      virtual void set_persistence(bool en) = 0;
+
       virtual int nsamps() const = 0;
       virtual void reset() = 0;
 
@@ -74,7 +74,8 @@ namespace adiscope {
 		   io_signature::make(nconnections, nconnections, sizeof(gr_complex)),
 		   io_signature::make(0, 0, 0)),
 	d_size(size), d_buffer_size(2*size), d_name(name),
-	d_nconnections(nconnections), d_index(0), d_start(0), d_end(size)
+	d_nconnections(nconnections), d_index(0), d_start(0), d_end(size),
+	d_persistence(false)
     {
 
       for(int i = 0; i < d_nconnections; i++) {
@@ -165,6 +166,13 @@ namespace adiscope {
       }
     }
 
+    void
+    xy_sink_c_impl::set_persistence(bool en)
+    {
+      gr::thread::scoped_lock lock(d_setlock);
+      d_persistence = en;
+    }
+
     int
     xy_sink_c_impl::nsamps() const
     {
@@ -231,6 +239,12 @@ namespace adiscope {
                                     new ConstUpdateEvent(d_residbufs_real,
 							 d_residbufs_imag,
 							 d_size));
+        } else if (d_persistence && d_qApplication) {
+          ConstUpdateEvent *event = new ConstUpdateEvent(d_residbufs_real,
+							 d_residbufs_imag,
+							 d_size);
+          event->setPersistenceOnly(true);
+          d_qApplication->postEvent(plot, event);
         }
 
         // We've plotting, so reset the state
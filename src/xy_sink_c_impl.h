@@ -67,6 +67,8 @@ namespace adiscope {
       gr::high_res_timer_type d_update_time;
       gr::high_res_timer_type d_last_time;
 
+      bool d_persistence;
+
       void _reset();
       void _npoints_resize();
 
@@ -83,6 +85,7 @@ namespace adiscope {
 
       void set_update_time(double t);
       void set_nsamps(const int size);
+      void set_persistence(bool en);
 
       int nsamps() const;
       void reset();